@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <xlnt/xlnt.hpp>
+#include <helpers/allocation_counter.hpp>
+
+namespace {
+
+/// <summary>
+/// Source of workload values. The sequence of std::mt19937 is fixed by the standard, unlike
+/// those of the standard distributions, so values are derived from it directly and every
+/// platform generates the same workbooks.
+/// </summary>
+class generator
+{
+public:
+    generator() : engine_(20150101)
+    {
+    }
+
+    std::uint32_t next(std::uint32_t bound)
+    {
+        return engine_() % bound;
+    }
+
+    double next_number()
+    {
+        return static_cast<double>(engine_()) / 1000.0;
+    }
+
+private:
+    std::mt19937 engine_;
+};
+
+// Every workload starts from an empty sheet and adds about cells values to it.
+
+void fill_dense_numeric(xlnt::worksheet ws, std::size_t cells, generator &values)
+{
+    const column_t columns = 20;
+
+    for(std::size_t i = 0; i < cells; i++)
+    {
+        auto row = static_cast<row_t>(i / columns + 1);
+        auto column = static_cast<column_t>(i % columns + 1);
+        ws.get_cell(xlnt::cell_reference(column, row)).set_value(values.next_number());
+    }
+}
+
+void fill_sparse_wide(xlnt::worksheet ws, std::size_t cells, generator &values)
+{
+    // One value in each block of 16 columns, spread over all 16,384 columns a sheet can have.
+    const column_t blocks = 1024;
+
+    for(std::size_t i = 0; i < cells; i++)
+    {
+        auto row = static_cast<row_t>(i / blocks * 7 + 1);
+        auto column = static_cast<column_t>(i % blocks * 16 + values.next(16) + 1);
+        ws.get_cell(xlnt::cell_reference(column, row)).set_value(values.next_number());
+    }
+}
+
+void fill_strings(xlnt::worksheet ws, std::size_t cells, generator &values, std::uint32_t distinct)
+{
+    const column_t columns = 10;
+
+    for(std::size_t i = 0; i < cells; i++)
+    {
+        auto row = static_cast<row_t>(i / columns + 1);
+        auto column = static_cast<column_t>(i % columns + 1);
+        ws.get_cell(xlnt::cell_reference(column, row)).set_value("value " + std::to_string(values.next(distinct)));
+    }
+}
+
+void fill_strings_high_cardinality(xlnt::worksheet ws, std::size_t cells, generator &values)
+{
+    fill_strings(ws, cells, values, 0xffffffff);
+}
+
+void fill_strings_low_cardinality(xlnt::worksheet ws, std::size_t cells, generator &values)
+{
+    fill_strings(ws, cells, values, 100);
+}
+
+void fill_styled(xlnt::worksheet ws, std::size_t cells, generator &values)
+{
+    const column_t columns = 20;
+    const std::vector<std::string> formats = { "0.00", "#,##0", "0%", "yyyy-mm-dd", "@" };
+
+    for(std::size_t i = 0; i < cells; i++)
+    {
+        auto row = static_cast<row_t>(i / columns + 1);
+        auto column = static_cast<column_t>(i % columns + 1);
+        auto cell = ws.get_cell(xlnt::cell_reference(column, row));
+        cell.set_value(values.next_number());
+
+        // Forty distinct combinations of font and number format.
+        auto style = values.next(40);
+        xlnt::font font;
+        font.set_bold(style % 2 == 0);
+        font.set_size(static_cast<int>(9 + style / 10));
+        cell.set_font(font);
+        cell.set_number_format(xlnt::number_format(formats[style % formats.size()]));
+    }
+}
+
+void fill_formulas(xlnt::worksheet ws, std::size_t cells, generator &values)
+{
+    // Each row is two inputs followed by two formulas, one reading the row above.
+    for(std::size_t i = 0; i < cells / 4; i++)
+    {
+        auto row = static_cast<row_t>(i + 1);
+        auto r = std::to_string(row);
+        ws.get_cell(xlnt::cell_reference(1, row)).set_value(values.next_number());
+        ws.get_cell(xlnt::cell_reference(2, row)).set_value(values.next_number());
+        ws.get_cell(xlnt::cell_reference(3, row)).set_formula("=A" + r + "*B" + r);
+        ws.get_cell(xlnt::cell_reference(4, row)).set_formula(row == 1 ? "=C1" : "=SUM(C" + r + ",D" + std::to_string(row - 1) + ")");
+    }
+}
+
+struct workload
+{
+    std::string name;
+    void (*fill)(xlnt::worksheet, std::size_t, generator &);
+};
+
+const std::vector<workload> &get_workloads()
+{
+    static const std::vector<workload> workloads =
+    {
+        { "dense_numeric", fill_dense_numeric },
+        { "sparse_wide", fill_sparse_wide },
+        { "strings_high_cardinality", fill_strings_high_cardinality },
+        { "strings_low_cardinality", fill_strings_low_cardinality },
+        { "styled", fill_styled },
+        { "formulas", fill_formulas }
+    };
+
+    return workloads;
+}
+
+/// <summary>
+/// The most memory the process has had resident so far in megabytes. Run one workload per
+/// process to attribute it to that workload.
+/// </summary>
+double get_peak_rss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<double>(counters.PeakWorkingSetSize) / (1024 * 1024);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<double>(usage.ru_maxrss) / (1024 * 1024);
+#else
+    return static_cast<double>(usage.ru_maxrss) / 1024;
+#endif
+#endif
+}
+
+struct measurement
+{
+    double seconds;
+    std::size_t allocations;
+};
+
+template<typename F>
+measurement measure(F operation)
+{
+    AllocationCounter counter;
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return { elapsed.count(), counter.GetCount() };
+}
+
+void print_header()
+{
+    std::cout << std::left << std::setw(26) << "workload" << std::right
+        << std::setw(10) << "cells"
+        << std::setw(10) << "MB"
+        << std::setw(14) << "save cells/s"
+        << std::setw(10) << "save MB/s"
+        << std::setw(12) << "save allocs"
+        << std::setw(14) << "load cells/s"
+        << std::setw(10) << "load MB/s"
+        << std::setw(12) << "load allocs"
+        << std::setw(10) << "peak MB" << std::endl;
+}
+
+void report(const std::string &name, std::size_t cells, std::size_t bytes, const measurement &save, const measurement &load)
+{
+    auto megabytes = static_cast<double>(bytes) / (1024 * 1024);
+
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed
+        << std::setw(10) << cells
+        << std::setw(10) << std::setprecision(2) << megabytes
+        << std::setw(14) << std::setprecision(0) << cells / save.seconds
+        << std::setw(10) << std::setprecision(2) << megabytes / save.seconds
+        << std::setw(12) << save.allocations
+        << std::setw(14) << std::setprecision(0) << cells / load.seconds
+        << std::setw(10) << std::setprecision(2) << megabytes / load.seconds
+        << std::setw(12) << load.allocations
+        << std::setw(10) << std::setprecision(1) << get_peak_rss() << std::endl;
+}
+
+void run(const workload &benchmark, std::size_t cells)
+{
+    generator values;
+    xlnt::workbook wb;
+    benchmark.fill(wb.get_active_sheet(), cells, values);
+
+    std::vector<unsigned char> data;
+    auto save = measure([&]() { wb.save(data); });
+
+    xlnt::workbook loaded;
+    auto load = measure([&]() { loaded.load(data); });
+
+    report(benchmark.name, cells, data.size(), save, load);
+}
+
+/// <summary>
+/// Time loading an existing file, such as one written by xlnt.generator, and saving it again.
+/// </summary>
+void run_file(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    xlnt::workbook loaded;
+    auto load = measure([&]() { loaded.load(data); });
+
+    std::size_t cells = 0;
+
+    for(auto ws : loaded)
+    {
+        cells += ws.get_cell_collection().size();
+    }
+
+    std::vector<unsigned char> saved;
+    auto save = measure([&]() { loaded.save(saved); });
+
+    report(filename, cells, data.size(), save, load);
+}
+
+} // namespace
+
+/// <summary>
+/// Build each synthetic workbook in memory, then time saving it to and loading it back from
+/// a buffer so that disk speed doesn't factor in. xlsx files given as arguments are measured
+/// instead. Usage: xlnt.benchmark [cells] [workload...] [filename.xlsx...]
+/// </summary>
+int main(int argc, char *argv[])
+{
+    std::size_t cells = 200000;
+    std::vector<std::string> selected;
+    std::vector<std::string> files;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if(argument.find_first_not_of("0123456789") == std::string::npos)
+        {
+            cells = static_cast<std::size_t>(std::stoull(argument));
+        }
+        else if(argument.size() > 5 && argument.compare(argument.size() - 5, 5, ".xlsx") == 0)
+        {
+            files.push_back(argument);
+        }
+        else
+        {
+            selected.push_back(argument);
+        }
+    }
+
+    print_header();
+
+    for(auto &filename : files)
+    {
+        run_file(filename);
+    }
+
+    if(!files.empty() && selected.empty())
+    {
+        return 0;
+    }
+
+    for(auto &benchmark : get_workloads())
+    {
+        if(selected.empty() || std::find(selected.begin(), selected.end(), benchmark.name) != selected.end())
+        {
+            run(benchmark, cells);
+        }
+    }
+
+    return 0;
+}
@@ -18,6 +18,7 @@ project "xlnt.test"
     }
     files { 
        "../../tests/*.hpp",
+       "../../tests/helpers/allocation_counter.cpp",
        "../../tests/runner-autogen.cpp"
     }
     links { "xlnt", "miniz" }
@@ -30,6 +31,52 @@ project "xlnt.test"
         buildoptions {
 	    "-std=c++14"
     }	
+        links { "pthread" }
+
+project "xlnt.benchmark"
+    kind "ConsoleApp"
+    language "C++"
+    targetname "xlnt.benchmark"
+    targetdir "../../bin"
+    includedirs { 
+       "../../include",
+       "../../tests"
+    }
+    files { 
+       "../../benchmarks/*.cpp",
+       "../../tests/helpers/allocation_counter.cpp"
+    }
+    links { "xlnt", "miniz" }
+    flags { "Unicode" }
+    configuration "windows"
+        defines { "WIN32" }
+	links { "Psapi" }
+    configuration "not windows"
+        buildoptions {
+	    "-std=c++14"
+    }	
+        links { "pthread" }
+
+project "xlnt.generator"
+    kind "ConsoleApp"
+    language "C++"
+    targetname "xlnt.generator"
+    targetdir "../../bin"
+    includedirs { 
+       "../../include"
+    }
+    files { 
+       "../../tools/*.cpp"
+    }
+    links { "xlnt", "miniz" }
+    flags { "Unicode" }
+    configuration "windows"
+        defines { "WIN32" }
+    configuration "not windows"
+        buildoptions {
+	    "-std=c++14"
+    }	
+        links { "pthread" }
 
 project "xlnt"
     kind "StaticLib"
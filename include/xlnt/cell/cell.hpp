@@ -112,6 +112,13 @@ public:
     
     // style
     std::size_t get_style_id() const;
+    
+    /// <summary>
+    /// Use the style with the given id in the parent workbook, as returned by get_style_id
+    /// or one of the workbook style setters.
+    /// </summary>
+    void set_style_id(std::size_t style_id);
+    
     const number_format &get_number_format() const;
     void set_number_format(const number_format &format);
     const font &get_font() const;
@@ -140,6 +147,14 @@ public:
     void set_formula(const std::string &formula);
     void clear_formula();
     bool has_formula() const;
+    
+    /// <summary>
+    /// Make this cell part of the parent worksheet's shared formula group index.
+    /// get_formula will then return the group's formula translated to this cell.
+    /// </summary>
+    void set_shared_formula(std::size_t index);
+    bool has_shared_formula() const;
+    std::size_t get_shared_formula_index() const;
 
     // printing
     
@@ -155,7 +170,14 @@ public:
     std::string to_string() const;
     
     // merging
+    /// <summary>
+    /// True if the cell is inside one of its worksheet's merged ranges.
+    /// </summary>
     bool is_merged() const;
+    
+    /// <summary>
+    /// Merge the cell on its own, or unmerge the whole merged range it is in.
+    /// </summary>
     void set_merged(bool merged);
 
     std::string get_error() const;
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace xlnt {
 
@@ -54,6 +55,11 @@ struct date
     /// </summary>
     static date from_number(int days_since_base_year, calendar base_date);
 
+    /// <summary>
+    /// Convert each element of days_since_base_year as date::from_number would.
+    /// </summary>
+    static std::vector<date> from_numbers(const std::vector<int> &days_since_base_year, calendar base_date);
+
     date(int year_, int month_, int day_)
         : year(year_), month(month_), day(day_)
     {
@@ -128,6 +134,11 @@ struct datetime
     /// </summary>
     static datetime from_number(long double number, calendar base_date);
 
+    /// <summary>
+    /// Convert each element of numbers as datetime::from_number would.
+    /// </summary>
+    static std::vector<datetime> from_numbers(const std::vector<long double> &numbers, calendar base_date);
+
     datetime(int year_, int month_, int day_, int hour_ = 0, int minute_ = 0, int second_ = 0, int microsecond_ = 0)
         : year(year_), month(month_), day(day_), hour(hour_), minute(minute_), second(second_), microsecond(microsecond_)
     {
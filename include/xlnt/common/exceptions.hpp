@@ -121,6 +121,15 @@ public:
     attribute_error();
 };
 
+/// <summary>
+/// Error for a formula that can't be tokenized.
+/// </summary>
+class formula_syntax_exception : public std::runtime_error
+{
+public:
+    formula_syntax_exception(const std::string &formula, std::size_t offset);
+};
+
 class value_error : public std::runtime_error
 {
 public:
@@ -1,7 +1,113 @@
+// Copyright (c) 2015 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
 namespace xlnt {
 
-class tokenizer {
+/// <summary>
+/// Splits a formula like "=SUM(Sheet1!A1:B2, 3)" into a flat list of tokens.
+/// Tokens don't copy any text, they record an offset and length into the formula
+/// so a formula can be tokenized with a single allocation for the token list.
+/// </summary>
+class tokenizer
+{
+public:
+    enum class token_type
+    {
+        literal,
+        operand,
+        function,
+        array,
+        parenthesis,
+        separator,
+        prefix_operator,
+        infix_operator,
+        postfix_operator,
+        whitespace
+    };
+
+    enum class token_subtype
+    {
+        none,
+        text,
+        number,
+        logical,
+        error,
+        range,
+        open,
+        close,
+        argument,
+        row
+    };
+
+    /// <summary>
+    /// A token covers length characters of the formula starting at offset.
+    /// Text operands include their quotes and an opening function token
+    /// includes its trailing "(" so "SUM(" is a function with subtype open.
+    /// </summary>
+    struct token
+    {
+        token_type type;
+        token_subtype subtype;
+        std::size_t offset;
+        std::size_t length;
+    };
+
+    /// <summary>
+    /// Tokenize formula. A formula not starting with "=" is a single literal token.
+    /// Throws formula_syntax_exception if the formula is malformed.
+    /// </summary>
+    explicit tokenizer(const std::string &formula);
+
+    const std::string &get_formula() const;
+    const std::vector<token> &get_tokens() const;
 
+    /// <summary>
+    /// Return a copy of the characters covered by t.
+    /// </summary>
+    std::string get_value(const token &t) const;
+
+    /// <summary>
+    /// Return true if the characters covered by t are equal to value.
+    /// </summary>
+    bool equals(const token &t, const char *value) const;
+
+private:
+    void tokenize();
+    void add_token(token_type type, token_subtype subtype, std::size_t offset, std::size_t length);
+    bool follows_operand() const;
+
+    std::size_t scan_string(std::size_t offset, char quote) const;
+    std::size_t scan_error(std::size_t offset) const;
+    std::size_t scan_word(std::size_t offset) const;
+    token_subtype classify_word(std::size_t offset, std::size_t length) const;
+
+    std::string formula_;
+    std::vector<token> tokens_;
 };
-    
+
 } // namespace xlnt
@@ -1,33 +1,79 @@
+// Copyright (c) 2015 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
 #include <string>
-#include <vector>
+#include <utility>
 
-namespace xlnt {
+#include "../cell/cell_reference.hpp"
+#include "tokenizer.hpp"
 
-class cell_reference;
-class tokenizer;
+namespace xlnt {
 
+/// <summary>
+/// Moves a formula written for one cell to another cell the way Excel does when
+/// a formula is copied: relative row and column references are shifted by the
+/// distance between the cells while references anchored with "$" stay put.
+/// </summary>
 class translator
 {
-    translator(const std::string &formula, const cell_reference &ref);
-    
-    std::vector<std::string> get_tokens();
-    
+public:
+    /// <summary>
+    /// Tokenize formula, which is currently entered in the cell at origin.
+    /// </summary>
+    translator(const std::string &formula, const cell_reference &origin);
+
+    const std::vector<tokenizer::token> &get_tokens() const;
+
+    /// <summary>
+    /// Return the formula as it would be written in the cell at destination.
+    /// References moved above row 1 or left of column A become #REF!.
+    /// </summary>
+    std::string translate_formula(const cell_reference &destination) const;
+
+    /// <summary>
+    /// Append the translated formula to result instead of returning a new string.
+    /// </summary>
+    void translate_formula(const cell_reference &destination, std::string &result) const;
+
     static std::string translate_row(const std::string &row_str, int row_delta);
-    static std::string translate_col(const std::string &col_str, col_delta);
-    
-    std::pair<std::string, std::string> strip_ws_name(const std::string &range_str);
-    
-    void translate_range(const range_reference &range_ref);
-    void translate_formula(const cell_reference &dest);
-    
+    static std::string translate_col(const std::string &col_str, int col_delta);
+
+    /// <summary>
+    /// Split a reference like "'My Sheet'!A1:B2" into {"'My Sheet'!", "A1:B2"}.
+    /// The first element is empty if there is no sheet name.
+    /// </summary>
+    static std::pair<std::string, std::string> strip_ws_name(const std::string &range_str);
+
+    /// <summary>
+    /// Translate a cell, row, column or area reference, with or without a sheet name.
+    /// Anything else, such as a defined name, is returned unchanged.
+    /// </summary>
+    static std::string translate_range(const std::string &range_str, int row_delta, int col_delta);
+
 private:
-    const std::string ROW_RANGE_RE;
-    const std::string COL_RANGE_RE;
-    const std::string CELL_REF_RE;
-    
-    std::string formula_;
-    cell_reference reference_;
     tokenizer tokenizer_;
+    cell_reference origin_;
 };
 
 } // namespace xlnt
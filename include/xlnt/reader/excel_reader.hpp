@@ -30,9 +30,13 @@ namespace xlnt {
     
 class workbook;
 
+struct load_options;
+
 std::string CentralDirectorySignature();
 std::string repair_central_directory(const std::string &original);
 workbook load_workbook(const std::string &filename, bool guess_types = false, bool data_only = false);
 workbook load_workbook(const std::vector<std::uint8_t> &bytes, bool guess_types = false, bool data_only = false);
+workbook load_workbook(const std::string &filename, const load_options &options, bool guess_types = false, bool data_only = false);
+workbook load_workbook(const std::vector<std::uint8_t> &bytes, const load_options &options, bool guess_types = false, bool data_only = false);
 
 } // namespace xlnt
@@ -0,0 +1,93 @@
+// Copyright (c) 2015 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../common/types.hpp"
+
+namespace xlnt {
+
+/// <summary>
+/// Restricts what workbook::load and load_workbook read from a file. Filtering happens while
+/// worksheets are parsed so cells that are excluded are never created. The defaults load everything.
+/// </summary>
+struct load_options
+{
+    load_options()
+        : min_row(1),
+          max_row(std::numeric_limits<row_t>::max()),
+          skip_styles(false),
+          skip_formulas(false),
+          skip_hyperlinks(false)
+    {
+    }
+    
+    /// <summary>
+    /// Return true if a cell at the given position passes the column and row filters.
+    /// </summary>
+    bool includes(column_t column, row_t row) const
+    {
+        return row >= min_row && row <= max_row
+            && (columns.empty() || std::find(columns.begin(), columns.end(), column) != columns.end());
+    }
+    
+    /// <summary>
+    /// Titles of the worksheets to load. Other worksheets are left out of the workbook entirely.
+    /// An empty list loads every worksheet.
+    /// </summary>
+    std::vector<std::string> sheets;
+    
+    /// <summary>
+    /// Indices of the columns to load, e.g. cell_reference::column_index_from_string("D").
+    /// An empty list loads every column.
+    /// </summary>
+    std::vector<column_t> columns;
+    
+    /// <summary>
+    /// First and last row to load, inclusive.
+    /// </summary>
+    row_t min_row;
+    row_t max_row;
+    
+    /// <summary>
+    /// Leave every cell with the default style instead of reading styles.xml and cell style indices.
+    /// </summary>
+    bool skip_styles;
+    
+    /// <summary>
+    /// Read only the cached values of formula cells, as if the workbook were opened with data_only.
+    /// </summary>
+    bool skip_formulas;
+    
+    /// <summary>
+    /// Don't read hyperlinks or their worksheet relationships.
+    /// </summary>
+    bool skip_hyperlinks;
+};
+
+} // namespace xlnt
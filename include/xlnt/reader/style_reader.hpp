@@ -23,25 +23,38 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstddef>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
-#include "style.h"
-
 namespace xlnt {
+
+class workbook;
+
+/// <summary>
+/// Reads the stylesheet part of a workbook into that workbook's style tables.
+/// </summary>
+class style_reader
+{
+public:
+    style_reader(workbook &wb);
+    
+    /// <summary>
+    /// Reads number formats, fonts, fills, borders and cell formats (xfs) from the given
+    /// styles.xml content. Each component is added to the workbook once no matter how many
+    /// xfs refer to it.
+    /// </summary>
+    void read_styles(const std::string &xml_string);
+    
+    /// <summary>
+    /// Returns the workbook style id for each cellXfs entry in document order. Cells in the
+    /// worksheet parts refer to styles by this index.
+    /// </summary>
+    const std::vector<std::size_t> &get_style_ids() const;
     
-void read_styles();
-void read_custom_num_formats();
-void read_color_index();
-void read_dxfs();
-void read_fonts();
-void read_fills();
-void read_borders();
-void read_named_styles();
-void read_style_names();
-void read_cell_styles();
-void read_xfs();
-void read_style_table();
+private:
+    workbook &wb_;
+    std::vector<std::size_t> style_ids_;
+};
 
 } // namespace xlnt
@@ -23,6 +23,7 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstddef>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -30,12 +31,16 @@
 
 namespace xlnt {
     
+class relationship;
 class workbook;
 class worksheet;
 
-worksheet read_worksheet(std::istream &handle, workbook &wb, const std::string &title, const std::vector<std::string> &string_table, const std::unordered_map<int, std::string> &custom_number_formats);
+struct load_options;
+
+worksheet read_worksheet(std::istream &handle, workbook &wb, const std::string &title, const std::vector<std::string> &string_table);
 void read_worksheet(worksheet ws, std::istream &stream, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids, const std::unordered_map<int, std::string> &custom_number_formats);
 void read_worksheet(worksheet ws, const std::string &xml_string, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids, const std::unordered_map<int, std::string> &custom_number_formats);
+void read_worksheet(worksheet ws, const std::string &xml_string, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids, const std::vector<relationship> &relationships, const load_options &options);
 std::string read_dimension(const std::string &xml_string);
 
 } // namespace xlnt
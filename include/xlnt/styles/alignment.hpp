@@ -23,6 +23,8 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstddef>
+
 namespace xlnt {
 
 /// <summary>
@@ -54,12 +56,41 @@ public:
         wrap_text_ = wrap_text;
     }
     
-    bool operator==(const alignment &other) const
+    void set_shrink_to_fit(bool shrink_to_fit)
+    {
+        shrink_to_fit_ = shrink_to_fit;
+    }
+    
+    void set_horizontal(horizontal_alignment horizontal)
     {
-        return hash() == other.hash();
+        horizontal_ = horizontal;
     }
     
-    std::size_t hash() const { return 0; }
+    void set_vertical(vertical_alignment vertical)
+    {
+        vertical_ = vertical;
+    }
+    
+    void set_text_rotation(int text_rotation)
+    {
+        text_rotation_ = text_rotation;
+    }
+    
+    void set_indent(int indent)
+    {
+        indent_ = indent;
+    }
+    
+    bool get_wrap_text() const { return wrap_text_; }
+    bool get_shrink_to_fit() const { return shrink_to_fit_; }
+    horizontal_alignment get_horizontal() const { return horizontal_; }
+    vertical_alignment get_vertical() const { return vertical_; }
+    int get_text_rotation() const { return text_rotation_; }
+    int get_indent() const { return indent_; }
+    
+    bool operator==(const alignment &other) const;
+    
+    std::size_t hash() const;
     
 private:
     horizontal_alignment horizontal_ = horizontal_alignment::general;
@@ -33,7 +33,12 @@ template<typename T>
 struct optional
 {
     T value;
-    bool initialized;
+    bool initialized = false;
+    
+    bool operator==(const optional &other) const
+    {
+        return initialized == other.initialized && (!initialized || value == other.value);
+    }
 };
     
 enum class diagonal_direction
@@ -59,18 +64,15 @@ public:
     optional<side> vertical;
     optional<side> horizontal;
 
-    bool outline;
-    bool diagonal_up;
-    bool diagonal_down;
+    bool outline = false;
+    bool diagonal_up = false;
+    bool diagonal_down = false;
     
-    diagonal_direction diagonal_direction_;
+    diagonal_direction diagonal_direction_ = diagonal_direction::none;
     
-    bool operator==(const border &other) const
-    {
-        return hash() == other.hash();
-    }
+    bool operator==(const border &other) const;
     
-    std::size_t hash() const { return 0; }
+    std::size_t hash() const;
 };
 
 } // namespace xlnt
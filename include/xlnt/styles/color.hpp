@@ -23,6 +23,8 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstddef>
+
 namespace xlnt {
 
 class color
@@ -43,11 +45,15 @@ public:
     {
     }
     
+    int get_index() const { return index_; }
+    
     bool operator==(const color &other) const
     {
         return index_ == other.index_;
     }
     
+    std::size_t hash() const { return static_cast<std::size_t>(index_); }
+    
 private:
     int index_;
 };
@@ -60,12 +60,11 @@ public:
     color start_color = color::white;
     color end_color = color::black;
     
-    virtual bool operator==(const fill &other) const
-    {
-        return hash() == other.hash();
-    }
+    virtual ~fill() {}
+    
+    virtual bool operator==(const fill &other) const;
     
-    virtual std::size_t hash() const { return 0; }
+    virtual std::size_t hash() const;
 };
 
 } // namespace xlnt
@@ -44,17 +44,28 @@ public:
     };
     
     void set_bold(bool bold) { bold_ = bold; }
+    void set_italic(bool italic) { italic_ = italic; }
+    void set_superscript(bool superscript) { superscript_ = superscript; }
+    void set_subscript(bool subscript) { subscript_ = subscript; }
+    void set_underline(underline underline_type) { underline_ = underline_type; }
+    void set_strikethrough(bool strikethrough) { strikethrough_ = strikethrough; }
+    void set_size(int size) { size_ = size; }
+    void set_name(const std::string &name) { name_ = name; }
+    void set_color(color c) { color_ = c; }
     
-    bool operator==(const font &other) const
-    {
-        return hash() == other.hash();
-    }
+    bool operator==(const font &other) const;
     
     int get_size() const { return size_; }
     std::string get_name() const { return name_; }
     bool is_bold() const { return bold_; }
+    bool is_italic() const { return italic_; }
+    bool is_superscript() const { return superscript_; }
+    bool is_subscript() const { return subscript_; }
+    underline get_underline() const { return underline_; }
+    bool is_strikethrough() const { return strikethrough_; }
+    color get_color() const { return color_; }
     
-    std::size_t hash() const { return 0; }
+    std::size_t hash() const;
     
 private:
     friend class style;
@@ -30,8 +30,6 @@ namespace xlnt {
 class gradient_fill : public fill
 {
 public:
-    std::size_t hash() const override { return 0; }
-    
 private:
     
 };
@@ -111,7 +111,7 @@ public:
     
     bool operator==(const number_format &other) const
     {
-        return hash() == other.hash();
+        return format_string_ == other.format_string_;
     }
 
 private:
@@ -45,12 +45,20 @@ public:
         locked_ = locked ? type::protected_ : type::unprotected;
     }
     
+    void set_hidden(bool hidden)
+    {
+        hidden_ = hidden ? type::protected_ : type::unprotected;
+    }
+    
+    type get_locked() const { return locked_; }
+    type get_hidden() const { return hidden_; }
+    
     bool operator==(const protection &other) const
     {
-        return hash() == other.hash();
+        return locked_ == other.locked_ && hidden_ == other.hidden_;
     }
     
-    std::size_t hash() const { return 0; }
+    std::size_t hash() const;
     
 private:
     type locked_;
@@ -54,9 +54,14 @@ public:
     
     bool operator==(const side &other) const
     {
-        return other.style_ == style_;
+        return other.style_ == style_ && other.color_ == color_;
     }
     
+    border_style get_style() const { return style_; }
+    color get_color() const { return color_; }
+    
+    std::size_t hash() const;
+    
 private:
     border_style style_;
     color color_;
@@ -50,15 +50,21 @@ public:
     bool pivot_button() const;
     bool quote_prefix() const;
     
+    void set_alignment(const alignment &alignment_);
+    void set_border(const border &border_);
+    void set_fill(const fill &fill_);
+    void set_font(const font &font_);
+    void set_number_format(const number_format &number_format_);
+    void set_protection(const protection &protection_);
+    void set_pivot_button(bool pivot);
+    void set_quote_prefix(bool quote);
+    
     std::size_t get_fill_index() const { return fill_index_; }
     std::size_t get_font_index() const { return font_index_; }
     std::size_t get_border_index() const { return border_index_; }
     std::size_t get_number_format_index() const { return number_format_index_; }
     
-    bool operator==(const style &other) const
-    {
-        return hash() == other.hash();
-    }
+    bool operator==(const style &other) const;
     
 private:
     friend class workbook;
@@ -53,8 +53,12 @@ class zip_file;
     
 enum class encoding;
 
+struct load_options;
+
 namespace detail {    
+    class number_formatter;
     struct workbook_impl;
+    struct worksheet_impl;
 } // namespace detail
 
 struct content_type
@@ -124,6 +128,20 @@ public:
 
     bool get_data_only() const;
     void set_data_only(bool data_only);
+
+    /// <summary>
+    /// When enabled, load only reads the workbook part, relationships, shared strings and styles.
+    /// Each worksheet is parsed the first time it is accessed through this workbook.
+    /// </summary>
+    bool get_lazy_load() const;
+    void set_lazy_load(bool lazy_load);
+    
+    /// <summary>
+    /// Filters applied by load while parsing. Sheets, cells and attributes excluded here
+    /// are never created in the workbook.
+    /// </summary>
+    const load_options &get_load_options() const;
+    void set_load_options(const load_options &options);
     
     //create
     worksheet create_sheet();
@@ -173,13 +191,41 @@ public:
     void remove_named_range(const std::string &name);
     
     //serialization
-    bool save(std::vector<unsigned char> &data);
-    bool save(const std::string &filename);
+    bool save(std::vector<unsigned char> &data) const;
+    bool save(const std::string &filename) const;
     bool load(const std::vector<unsigned char> &data);
+    bool load(const std::vector<unsigned char> &data, const load_options &options);
     bool load(const std::string &filename);
+    bool load(const std::string &filename, const load_options &options);
     bool load(const std::istream &stream);
     bool load(zip_file &archive);
     
+    //calculation
+    /// <summary>
+    /// Evaluate every formula in the workbook and store each result as its cell's value,
+    /// replacing values cached by the application that saved the file. Formulas are
+    /// evaluated after the cells they refer to. Cells in a circular reference, and every
+    /// formula depending on one, evaluate to #REF!. Formulas using unsupported functions
+    /// evaluate to #NAME?.
+    /// </summary>
+    void calculate();
+    
+    /// <summary>
+    /// Bring formula results up to date after cell values were set, evaluating only the
+    /// formulas that depend on the changed cells. The dependency graph is kept from the
+    /// previous calculation, so this falls back to calculate() the first time and after
+    /// formulas, defined names or sheets were changed.
+    /// </summary>
+    void recalculate();
+    
+    /// <summary>
+    /// The number of threads calculate and recalculate may use. Formulas that don't depend
+    /// on each other are evaluated concurrently and the results don't depend on the count.
+    /// 0 uses one thread per hardware thread. The default is 1.
+    /// </summary>
+    std::size_t get_calculation_threads() const;
+    void set_calculation_threads(std::size_t threads);
+    
     bool operator==(const workbook &rhs) const;
     
     bool operator!=(const workbook &rhs) const
@@ -234,14 +280,26 @@ public:
     
     void set_code_name(const std::string &code_name);
     
-    bool has_loaded_theme();
-    std::string get_loaded_theme();
+    bool has_loaded_theme() const;
+    std::string get_loaded_theme() const;
     
     style get_style(std::size_t style_id);
     std::size_t add_style(style style_);
     
 private:
+    friend class cell;
+    friend class range;
     friend class worksheet;
+    
+    void load_sheet(detail::worksheet_impl &impl) const;
+    
+    /// <summary>
+    /// Returns the compiled form of the number format used by the given style.
+    /// Each number format is compiled the first time it is needed and kept for the
+    /// lifetime of the workbook.
+    /// </summary>
+    const detail::number_formatter &get_number_formatter(std::size_t style_id) const;
+    
     std::shared_ptr<detail::workbook_impl> d_;
 };
     
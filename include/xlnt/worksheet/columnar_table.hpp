@@ -0,0 +1,217 @@
+// Copyright (c) 2015 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/types.hpp"
+
+// Structures of the Apache Arrow C data interface. These are defined by the Arrow
+// specification as a stable C ABI so tables can be handed to any Arrow consumer
+// without linking against Arrow. The guard matches the one used by Arrow itself.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema
+{
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+    void (*release)(struct ArrowSchema *);
+    void *private_data;
+};
+
+struct ArrowArray
+{
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+    void (*release)(struct ArrowArray *);
+    void *private_data;
+};
+
+} // extern "C"
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace xlnt {
+
+class cell_reference;
+class range_reference;
+class worksheet;
+
+/// <summary>
+/// Physical layout of a columnar_table column. Each value corresponds to an Arrow type.
+/// </summary>
+enum class columnar_type
+{
+    /// <summary>
+    /// Every cell in the column is empty (Arrow null, format "n").
+    /// </summary>
+    null,
+    /// <summary>
+    /// Numeric cells stored as doubles (Arrow float64, format "g").
+    /// </summary>
+    float64,
+    /// <summary>
+    /// Boolean cells stored as a bit-packed bitmap (Arrow boolean, format "b").
+    /// </summary>
+    boolean,
+    /// <summary>
+    /// String, error and formula cells, or any column mixing cell types, stored as
+    /// int32 indices into the table's shared utf8 dictionary (Arrow dictionary, format "i" over "u").
+    /// </summary>
+    dictionary
+};
+
+/// <summary>
+/// One column of a columnar_table. Buffers follow the Arrow layout: validity is an
+/// LSB-ordered bitmap with a set bit for each non-null row, booleans are packed the same way,
+/// and exactly one of values, booleans or indices is populated depending on type. errors is
+/// packed the same way too and marks the dictionary entries that are error values such as
+/// #N/A rather than text. It is left empty when there are none and isn't exported to Arrow.
+/// </summary>
+struct columnar_column
+{
+    std::string name;
+    columnar_type type = columnar_type::null;
+    std::size_t length = 0;
+    std::size_t null_count = 0;
+    std::vector<std::uint8_t> validity;
+    std::vector<double> values;
+    std::vector<std::uint8_t> booleans;
+    std::vector<std::int32_t> indices;
+    std::vector<std::uint8_t> errors;
+    
+    bool is_valid(std::size_t row) const
+    {
+        return (validity[row / 8] >> (row % 8)) & 1;
+    }
+    
+    bool is_error(std::size_t row) const
+    {
+        return !errors.empty() && ((errors[row / 8] >> (row % 8)) & 1);
+    }
+};
+
+/// <summary>
+/// A rectangular worksheet region held column by column in the Apache Arrow memory layout.
+/// Strings from every dictionary column share a single utf8 dictionary (int32 offsets followed
+/// by contiguous character data), mirroring a workbook's shared string table.
+/// </summary>
+/// <remarks>
+/// Conversion works directly on the worksheet's cell storage rather than going through
+/// cell::get_value and cell::set_value for each cell. Formula cells without a cached value,
+/// including those of shared formulas, are exported as their formula text (including the
+/// leading '='), which is turned back into a formula when imported. Error values keep their
+/// type through the column's errors bitmap. In mixed columns, numbers are written in their shortest round-trip
+/// form and booleans as TRUE or FALSE.
+/// </remarks>
+class columnar_table
+{
+public:
+    /// <summary>
+    /// Convert the cells of ws in reference into a table. Column names are the column letters.
+    /// </summary>
+    static columnar_table from_worksheet(worksheet ws, const range_reference &reference);
+
+    /// <summary>
+    /// Convert every cell in ws, as given by worksheet::calculate_dimension.
+    /// </summary>
+    static columnar_table from_worksheet(worksheet ws);
+
+    /// <summary>
+    /// Copy a table out of an Arrow struct array (a record batch) and its schema.
+    /// Supported child formats are "n", "b", "g", "f", "l", "i", "u" and int32-indexed
+    /// dictionaries of "u". The caller keeps ownership of schema and array.
+    /// </summary>
+    static columnar_table from_arrow(const ArrowSchema *schema, const ArrowArray *array);
+
+    columnar_table();
+
+    /// <summary>
+    /// Write the table into ws with its first row and column at top_left, replacing the value,
+    /// formula, hyperlink and style of each cell written. Null entries clear any existing cell
+    /// at that position but do not create new cells. Dictionary text starting with '=' is
+    /// written as a formula and all other text as a string.
+    /// </summary>
+    void to_worksheet(worksheet ws, const cell_reference &top_left) const;
+
+    /// <summary>
+    /// Export the table through the Arrow C data interface as a struct array with one child per
+    /// column. The exported buffers share ownership of a copy of this table and remain valid
+    /// until the consumer calls the release callbacks.
+    /// </summary>
+    void to_arrow(ArrowSchema *schema, ArrowArray *array) const;
+
+    std::size_t get_row_count() const;
+    std::size_t get_column_count() const;
+
+    columnar_column &get_column(std::size_t index);
+    const columnar_column &get_column(std::size_t index) const;
+
+    /// <summary>
+    /// Append a column. The first column added to an empty table sets the row count and
+    /// every later column must have the same length.
+    /// </summary>
+    void add_column(const columnar_column &column);
+
+    /// <summary>
+    /// Return the dictionary index of value, adding it to the dictionary if necessary.
+    /// </summary>
+    std::int32_t intern(const std::string &value);
+
+    std::size_t get_dictionary_size() const;
+    std::string get_dictionary_value(std::size_t index) const;
+
+    const std::vector<std::int32_t> &get_dictionary_offsets() const;
+    const std::vector<char> &get_dictionary_data() const;
+
+private:
+    std::size_t row_count_;
+    std::vector<columnar_column> columns_;
+    std::vector<std::int32_t> dictionary_offsets_;
+    std::vector<char> dictionary_data_;
+    std::unordered_map<std::string, std::int32_t> dictionary_lookup_;
+};
+
+} // namespace xlnt
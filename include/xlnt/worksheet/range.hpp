@@ -147,6 +147,32 @@ public:
     std::size_t length() const;
     
     bool contains(const cell_reference &ref);
+    
+    /// <summary>
+    /// Write the display text of every cell in the range, as given by cell::to_string, into
+    /// text one after another in the range's major order. offsets receives the start of each
+    /// cell's text followed by the end of the last one, so cell i spans [offsets[i], offsets[i + 1]).
+    /// Both are cleared first so they can be reused between calls. Missing cells are empty
+    /// and aren't created. Rows and columns after the last ones holding a cell are left out,
+    /// so the block rendered, which is returned, can be smaller than the range but always
+    /// starts at its top left.
+    /// </summary>
+    range_reference render_text(std::string &text, std::vector<std::size_t> &offsets) const;
+    
+    /// <summary>
+    /// Aggregates of the numeric cells in the range, read straight from the worksheet without
+    /// creating missing cells. Text, boolean, error and empty cells are skipped. min and max
+    /// are 0 if there are no numbers and average throws data_type_exception.
+    /// </summary>
+    long double sum() const;
+    long double min() const;
+    long double max() const;
+    long double average() const;
+    
+    /// <summary>
+    /// The number of numeric cells in the range.
+    /// </summary>
+    std::size_t count() const;
 
     iterator begin();
     iterator end();
@@ -186,11 +186,23 @@ public:
     range columns() const;
     std::list<cell> get_cell_collection();
 
+    /// <summary>
+    /// The cell covering the point left, top in pixels from the top-left corner of the sheet,
+    /// the inverse of cell::get_anchor. Both directions take logarithmic time.
+    /// </summary>
     cell_reference get_point_pos(int left, int top) const;
     cell_reference get_point_pos(const std::pair<int, int> &point) const;
 
     const std::unordered_map<column_t, double> &get_column_dimensions() const;
     const std::unordered_map<row_t, double> &get_row_dimensions() const;
+    
+    /// <summary>
+    /// Set the width of column or the height of row in points, as used to position drawings.
+    /// A width or height of 0 hides the column or row and a negative one restores the default.
+    /// Throws std::runtime_error for column or row 0.
+    /// </summary>
+    void set_column_width(column_t column, double width);
+    void set_row_height(row_t row, double height);
 
     std::string unique_sheet_name(const std::string &value) const;
 
@@ -222,6 +234,14 @@ public:
     void unmerge_cells(column_t start_column, row_t start_row, column_t end_column, row_t end_row);
     std::vector<range_reference> get_merged_ranges() const;
     
+    /// <summary>
+    /// Whether the cell at reference is in a merged range and which one, found through an index
+    /// of the sheet's merged ranges without looking at any cells. get_merged_range throws
+    /// std::runtime_error if the cell isn't merged.
+    /// </summary>
+    bool is_merged(const cell_reference &reference) const;
+    range_reference get_merged_range(const cell_reference &reference) const;
+    
     // append
     void append();
     void append(const std::vector<std::string> &cells);
@@ -273,11 +293,22 @@ public:
 
     std::vector<std::string> get_formula_attributes() const;
     
+    // shared formulas
+    /// <summary>
+    /// Define shared formula group index as formula, written for the cell at origin
+    /// and used by the cells in reference. Cells join the group with cell::set_shared_formula.
+    /// </summary>
+    void add_shared_formula(std::size_t index, const cell_reference &origin, const range_reference &reference, const std::string &formula);
+    bool has_shared_formula(std::size_t index) const;
+    range_reference get_shared_formula_reference(std::size_t index) const;
+    
     void set_sheet_state(page_setup::sheet_state state);
     
 private:
     friend class workbook;
     friend class cell;
+    friend class columnar_table;
+    friend class range;
     worksheet(detail::worksheet_impl *d);
     detail::worksheet_impl *d_;
 };
@@ -37,7 +37,7 @@ class workbook;
 class style_writer
 {
 public:
-    style_writer(workbook &wb);
+    style_writer(const workbook &wb);
     style_writer(const style_writer &);
     style_writer &operator=(const style_writer &);
     
@@ -55,7 +55,7 @@ private:
     void write_dxfs();
     void write_table_styles();
     
-    workbook &wb_;
+    const workbook &wb_;
 };
     
 } // namespace xlnt
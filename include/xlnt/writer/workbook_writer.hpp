@@ -36,7 +36,7 @@ class zip_file;
 class excel_writer
 {
 public:
-    excel_writer(workbook &wb);
+    excel_writer(const workbook &wb);
     
     void save(const std::string &filename, bool as_template);
     void write_data(zip_file &archive, bool as_template);
@@ -48,7 +48,7 @@ public:
     void write_external_links(zip_file &archive);
     
 private:
-    workbook wb_;
+    const workbook &wb_;
     style_writer style_writer_;
     std::vector<std::string> shared_strings_;
 };
@@ -63,7 +63,7 @@ std::string write_workbook(const workbook &wb);
 std::string write_workbook_rels(const workbook &wb);
 std::string write_defined_names(const xlnt::workbook &wb);
     
-bool save_workbook(workbook &wb, const std::string &filename, bool as_template = false);
-std::vector<std::uint8_t> save_virtual_workbook(xlnt::workbook &wb, bool as_template = false);
+bool save_workbook(const workbook &wb, const std::string &filename, bool as_template = false);
+std::vector<std::uint8_t> save_virtual_workbook(const xlnt::workbook &wb, bool as_template = false);
 
 } // namespace xlnt
@@ -42,10 +42,14 @@ const std::string download_url = "https://github.com/tfussell/xlnt/archive/maste
 #include "common/relationship.hpp"
 #include "common/string_table.hpp"
 #include "common/zip_file.hpp"
+#include "formula/tokenizer.hpp"
+#include "formula/translate.hpp"
 #include "reader/excel_reader.hpp"
+#include "reader/load_options.hpp"
 #include "workbook/document_properties.hpp"
 #include "workbook/named_range.hpp"
 #include "workbook/workbook.hpp"
+#include "worksheet/columnar_table.hpp"
 #include "worksheet/range.hpp"
 #include "worksheet/range_reference.hpp"
 #include "worksheet/worksheet.hpp"
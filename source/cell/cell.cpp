@@ -10,551 +10,37 @@
 #include <xlnt/common/relationship.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/named_range.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 #include <xlnt/styles/color.hpp>
 
 #include "detail/cell_impl.hpp"
 #include "detail/comment_impl.hpp"
+#include "detail/number_formatter.hpp"
+#include "detail/worksheet_impl.hpp"
 
 namespace {
 
-enum class condition_type
+// Queue a cell whose value was set so that workbook::recalculate can update the formulas reading it.
+void value_changed(xlnt::detail::cell_impl *d)
 {
-    less_than,
-    less_or_equal,
-    equal,
-    greater_than,
-    greater_or_equal,
-    invalid
-};
-    
-struct section
-{
-    bool has_value = false;
-    std::string value;
-    bool has_color = false;
-    std::string color;
-    bool has_condition = false;
-    condition_type condition = condition_type::invalid;
-    std::string condition_value;
-    
-    section &operator=(const section &other)
-    {
-        has_value = other.has_value;
-        value = other.value;
-        has_color = other.has_color;
-        color = other.color;
-        has_condition = other.has_condition;
-        condition = other.condition;
-        condition_value = other.condition_value;
-        
-        return *this;
-    }
-};
-    
-struct format_sections
-{
-    section first;
-    section second;
-    section third;
-    section fourth;
-};
-
-// copied from named_range.cpp, keep in sync
-/// <summary>
-/// Return a vector containing string split at each delim.
-/// </summary>
-/// <remark>
-/// This should maybe be in a utility header so it can be used elsewhere.
-/// </remarks>
-std::vector<std::string> split_string(const std::string &string, char delim)
-{
-    std::vector<std::string> split;
-    std::string::size_type previous_index = 0;
-    auto separator_index = string.find(delim);
-    
-    while(separator_index != std::string::npos)
+    if(d->parent_ != nullptr)
     {
-        auto part = string.substr(previous_index, separator_index - previous_index);
-        split.push_back(part);
-        
-        previous_index = separator_index + 1;
-        separator_index = string.find(delim, previous_index);
+        d->parent_->value_changed(*d);
     }
-    
-    split.push_back(string.substr(previous_index));
-    
-    return split;
 }
 
-std::vector<std::string> split_string_any(const std::string &string, const std::string &delims)
+// Adding, removing or replacing a formula changes the dependency graph itself, which is rebuilt.
+void formula_changed(xlnt::detail::cell_impl *d)
 {
-    std::vector<std::string> split;
-    std::string::size_type previous_index = 0;
-    auto separator_index = string.find_first_of(delims);
-    
-    while(separator_index != std::string::npos)
+    if(d->parent_ != nullptr)
     {
-        auto part = string.substr(previous_index, separator_index - previous_index);
-        
-        if(!part.empty())
-        {
-            split.push_back(part);
-        }
-        
-        previous_index = separator_index + 1;
-        separator_index = string.find_first_of(delims, previous_index);
+        d->parent_->dependencies_changed_ = true;
     }
-    
-    split.push_back(string.substr(previous_index));
-    
-    return split;
 }
 
-bool is_date_format(const std::string &format_string)
-{
-    auto not_in = format_string.find_first_not_of("/-:, mMyYdDhHsS");
-    return not_in == std::string::npos;
-}
-
-bool is_valid_color(const std::string &color)
-{
-    static const std::vector<std::string> colors = { "Black", "Green"
-        "White", "Blue", "Magenta", "Yellow", "Cyan", "Red" };
-    return std::find(colors.begin(), colors.end(), color) != colors.end();
-}
-    
-bool parse_condition(const std::string &string, section &s)
-{
-    s.has_condition = false;
-    s.condition = condition_type::invalid;
-    s.condition_value.clear();
-    
-    if(string[0] == '<')
-    {
-        s.has_condition = true;
-        
-        if(string[1] == '=')
-        {
-            s.condition = condition_type::less_or_equal;
-            s.condition_value = string.substr(2);
-        }
-        else
-        {
-            s.condition = condition_type::less_than;
-            s.condition_value = string.substr(1);
-        }
-    }
-    if(string[0] == '>')
-    {
-        s.has_condition = true;
-        
-        if(string[1] == '=')
-        {
-            s.condition = condition_type::greater_or_equal;
-            s.condition_value = string.substr(2);
-        }
-        else
-        {
-            s.condition = condition_type::greater_than;
-            s.condition_value = string.substr(1);
-        }
-    }
-    else if(string[0] == '=')
-    {
-        s.has_condition = true;
-        s.condition = condition_type::equal;
-        s.condition_value = string.substr(1);
-    }
-    
-    return s.has_condition;
-}
-
-section parse_section(const std::string &section_string)
-{
-    std::string intermediate = section_string;
-    
-    section s;
-    std::string first_bracket_part, second_bracket_part;
-    static const std::vector<std::string> bracket_times = { "h", "hh", "m", "mm", "s", "ss" };
-    
-    if(section_string[0] == '[')
-    {
-        auto close_bracket_pos = section_string.find(']');
-        
-        if(close_bracket_pos == std::string::npos)
-        {
-            throw std::runtime_error("missing close bracket");
-        }
-        
-        first_bracket_part = intermediate.substr(1, close_bracket_pos - 1);
-        
-        if(std::find(bracket_times.begin(), bracket_times.end(), first_bracket_part) !=  bracket_times.end())
-        {
-            first_bracket_part.clear();
-        }
-        else
-        {
-            intermediate = intermediate.substr(close_bracket_pos);
-        }
-    }
-    
-    if(!first_bracket_part.empty() && intermediate[0] == '[')
-    {
-        auto close_bracket_pos = section_string.find(']');
-        
-        if(close_bracket_pos == std::string::npos)
-        {
-            throw std::runtime_error("missing close bracket");
-        }
-        
-        second_bracket_part = intermediate.substr(1, close_bracket_pos - 1);
-        
-        if(std::find(bracket_times.begin(), bracket_times.end(), second_bracket_part) !=  bracket_times.end())
-        {
-            second_bracket_part.clear();
-        }
-        else
-        {
-            intermediate = intermediate.substr(close_bracket_pos);
-        }
-    }
-    
-    if(!first_bracket_part.empty())
-    {
-        if(is_valid_color(first_bracket_part))
-        {
-            s.color = first_bracket_part;
-            s.has_color = true;
-        }
-        else if(!parse_condition(first_bracket_part, s))
-        {
-            throw std::runtime_error("invalid condition");
-        }
-    }
-    
-    if(!second_bracket_part.empty())
-    {
-        if(is_valid_color(second_bracket_part))
-        {
-            if(s.has_color)
-            {
-                throw std::runtime_error("two colors in one section");
-            }
-            
-            s.color = second_bracket_part;
-            s.has_color = true;
-        }
-        else if(s.has_condition)
-        {
-            throw std::runtime_error("two conditions in one section");
-        }
-        else if(!parse_condition(second_bracket_part, s))
-        {
-            throw std::runtime_error("invalid condition");
-        }
-    }
-    
-    s.value = intermediate;
-    s.has_value = true;
-    
-    return s;
-}
-    
-format_sections parse_format_sections(const std::string &combined)
-{
-    format_sections result = {};
-    
-    auto split = split_string(combined, ';');
-    
-    if(split.empty())
-    {
-        throw std::runtime_error("empty string");
-    }
-    
-    result.first = parse_section(split[0]);
-    
-    if(!result.first.has_condition)
-    {
-        result.second = result.first;
-        result.third = result.first;
-    }
-    
-    if(split.size() > 1)
-    {
-        result.second = parse_section(split[1]);
-    }
-    
-    if(split.size() > 2)
-    {
-        if(result.first.has_condition && !result.second.has_condition)
-        {
-            throw std::runtime_error("first two sections should have conditions");
-        }
-        
-        result.third = parse_section(split[2]);
-        
-        if(result.third.has_condition)
-        {
-            throw std::runtime_error("third section shouldn't have a condition");
-        }
-    }
-    
-    if(split.size() > 3)
-    {
-        if(result.first.has_condition)
-        {
-            throw std::runtime_error("too many parts");
-        }
-        
-        result.fourth = parse_section(split[3]);
-    }
-    
-    if(split.size() > 4)
-    {
-        throw std::runtime_error("too many parts");
-    }
-    
-    return result;
-}
-
-const std::vector<std::string> MonthNames =
-{
-    "January",
-    "February",
-    "March",
-    "April",
-    "May",
-    "June",
-    "July",
-    "August",
-    "September",
-    "October",
-    "November",
-    "December"
-};
-
-std::string format_section(long double number, const section &format, xlnt::calendar base_date)
-{
-    const std::string unquoted = "$+(:^'{<=-/)!&~}> ";
-    std::string result;
-    
-    if(is_date_format(format.value))
-    {
-        const std::string date_unquoted = ",-/: ";
-        
-        const std::vector<std::string> dates =
-        {
-            "m",
-            "mm",
-            "mmm",
-            "mmmmm",
-            "mmmmmm",
-            "d",
-            "dd",
-            "ddd",
-            "dddd",
-            "yy",
-            "yyyy"
-            "h",
-            "[h]",
-            "hh",
-            "m",
-            "[m]",
-            "mm",
-            "s",
-            "[s]",
-            "ss",
-            "AM/PM",
-            "am/pm",
-            "A/P",
-            "a/p"
-        };
-        
-        auto split = split_string_any(format.value, date_unquoted);
-        std::string::size_type index = 0, prev = 0;
-        auto d = xlnt::datetime::from_number(number, base_date);
-        bool processed_month = false;
-        
-        for(auto part : split)
-        {
-            while(format.value.substr(index, part.size()) != part)
-            {
-                index++;
-            }
-            
-            auto between = format.value.substr(prev, index - prev);
-            result.append(between);
-            
-            if(part == "m" && !processed_month)
-            {
-                result.append(std::to_string(d.month));
-                processed_month = true;
-            }
-            if(part == "mm" && !processed_month)
-            {
-                if(d.month < 10)
-                {
-                    result.append("0");
-                }
-                
-                result.append(std::to_string(d.month));
-                processed_month = true;
-            }
-            if(part == "mmm" && !processed_month)
-            {
-                result.append(MonthNames.at(d.month - 1).substr(0, 3));
-                processed_month = true;
-            }
-            if(part == "mmmm" && !processed_month)
-            {
-                result.append(MonthNames.at(d.month - 1));
-                processed_month = true;
-            }
-            if(part == "d")
-            {
-                result.append(std::to_string(d.day));
-            }
-            if(part == "dd")
-            {
-                if(d.day < 10)
-                {
-                    result.append("0");
-                }
-                
-                result.append(std::to_string(d.day));
-            }
-            if(part == "yyyy")
-            {
-                result.append(std::to_string(d.year));
-            }
-            
-            if(part == "h")
-            {
-                result.append(std::to_string(d.hour));
-                processed_month = true;
-            }
-            if(part == "hh")
-            {
-                if(d.hour < 10)
-                {
-                    result.append("0");
-                }
-                
-                result.append(std::to_string(d.hour));
-                processed_month = true;
-            }
-            if(part == "m")
-            {
-                result.append(std::to_string(d.minute));
-            }
-            if(part == "mm")
-            {
-                if(d.minute < 10)
-                {
-                    result.append("0");
-                }
-                
-                result.append(std::to_string(d.minute));
-            }
-            if(part == "s")
-            {
-                result.append(std::to_string(d.second));
-            }
-            if(part == "ss")
-            {
-                if(d.second < 10)
-                {
-                    result.append("0");
-                }
-                
-                result.append(std::to_string(d.second));
-            }
-            
-            
-            
-            index += part.size();
-            prev = index;
-        }
-        
-        if(index < format.value.size())
-        {
-            result.append(format.value.substr(index));
-        }
-    }
-    else if(number == static_cast<long long int>(number))
-    {
-        result = std::to_string(static_cast<long long int>(number));
-    }
-    else
-    {
-        result = std::to_string(number);
-    }
-    
-    return result;
-}
-
-std::string format_section(const std::string &text, const section &format)
-{
-    auto arobase_index = format.value.find('@');
-    
-    std::string first_part, middle_part, last_part;
-    
-    if(arobase_index != std::string::npos)
-    {
-        first_part = format.value.substr(0, arobase_index);
-        middle_part = text;
-        last_part = format.value.substr(arobase_index + 1);
-    }
-    else
-    {
-        first_part = format.value;
-    }
-    
-    auto unquote = [](std::string &s)
-    {
-        if(!s.empty())
-        {
-            if(s.front() != '"' || s.back() != '"') return false;
-            s = s.substr(0, s.size() - 2);
-        }
-        
-        return true;
-    };
-    
-    if(!unquote(first_part) || !unquote(last_part))
-    {
-        throw std::runtime_error(std::string("additional text must be enclosed in quotes: ") + format.value);
-    }
-    
-    return first_part + middle_part + last_part;
-}
-
-std::string format_number(long double number, const std::string &format, xlnt::calendar base_date)
-{
-    auto sections = parse_format_sections(format);
-    
-    if(number > 0)
-    {
-        return format_section(number, sections.first, base_date);
-    }
-    else if(number < 0)
-    {
-        return format_section(number, sections.second, base_date);
-    }
-    
-    // number == 0
-    return format_section(number, sections.third, base_date);
-}
-
-std::string format_text(const std::string &text, const std::string &format)
-{
-    if(format == "General") return text;
-    auto sections = parse_format_sections(format);
-    return format_section(text, sections.fourth);
-}
-
-}
+} // namespace
 
 namespace xlnt {
     
@@ -603,6 +89,7 @@ void cell::set_value(bool b)
 {
     d_->value_numeric_ = b ? 1 : 0;
     d_->type_ = type::boolean;
+    value_changed(d_);
 }
 
 template<>
@@ -610,6 +97,7 @@ void cell::set_value(std::int8_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -617,6 +105,7 @@ void cell::set_value(std::int16_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -624,6 +113,7 @@ void cell::set_value(std::int32_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -631,6 +121,7 @@ void cell::set_value(std::int64_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -638,6 +129,7 @@ void cell::set_value(std::uint8_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -645,6 +137,7 @@ void cell::set_value(std::uint16_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -652,6 +145,7 @@ void cell::set_value(std::uint32_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -659,6 +153,7 @@ void cell::set_value(std::uint64_t i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 #ifdef _WIN32
@@ -667,6 +162,7 @@ void cell::set_value(unsigned long i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 #endif
 
@@ -676,6 +172,7 @@ void cell::set_value(long long i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -683,6 +180,7 @@ void cell::set_value(unsigned long long i)
 {
     d_->value_numeric_ = static_cast<long double>(i);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 #endif
 
@@ -691,6 +189,7 @@ void cell::set_value(float f)
 {
     d_->value_numeric_ = static_cast<long double>(f);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -698,6 +197,7 @@ void cell::set_value(double d)
 {
     d_->value_numeric_ = static_cast<long double>(d);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
@@ -705,12 +205,20 @@ void cell::set_value(long double d)
 {
     d_->value_numeric_ = static_cast<long double>(d);
     d_->type_ = type::numeric;
+    value_changed(d_);
 }
 
 template<>
 void cell::set_value(std::string s)
 {
-    d_->set_string(s, get_parent().get_parent().get_guess_types());
+    d_->set_string(std::move(s), get_parent().get_parent().get_guess_types());
+    
+    if(!d_->formula_.empty())
+    {
+        formula_changed(d_);
+    }
+    
+    value_changed(d_);
 }
 
 template<>
@@ -722,14 +230,36 @@ void cell::set_value(char const *c)
 template<>
 void cell::set_value(cell c)
 {
+    auto had_formula = has_formula();
+    
     d_->type_ = c.d_->type_;
     d_->value_numeric_ = c.d_->value_numeric_;
     d_->value_string_ = c.d_->value_string_;
     d_->hyperlink_ = c.d_->hyperlink_;
     d_->has_hyperlink_ = c.d_->has_hyperlink_;
-    d_->formula_ = c.d_->formula_;
+    d_->formula_ = c.has_shared_formula() ? c.get_formula() : c.d_->formula_;
+    d_->shared_formula_ = detail::no_shared_formula;
     d_->style_id_ = c.d_->style_id_;
-    set_comment(c.get_comment());
+    
+    // set_comment only accepts this cell's own comment, so the other cell's is copied in.
+    if(c.d_->comment_ != nullptr)
+    {
+        auto source = *c.d_->comment_;
+        *get_comment().d_ = source;
+    }
+    else
+    {
+        clear_comment();
+    }
+    
+    if(had_formula || !d_->formula_.empty())
+    {
+        formula_changed(d_);
+    }
+    else
+    {
+        value_changed(d_);
+    }
 }
     
 template<>
@@ -738,6 +268,7 @@ void cell::set_value(date d)
     d_->type_ = type::numeric;
     d_->value_numeric_ = d.to_number(get_base_date());
     set_number_format(number_format(number_format::format::date_yyyymmdd2));
+    value_changed(d_);
 }
 
 template<>
@@ -746,6 +277,7 @@ void cell::set_value(datetime d)
     d_->type_ = type::numeric;
     d_->value_numeric_ = d.to_number(get_base_date());
     set_number_format(number_format(number_format::format::date_datetime));
+    value_changed(d_);
 }
 
 template<>
@@ -754,6 +286,7 @@ void cell::set_value(time t)
     d_->type_ = type::numeric;
     d_->value_numeric_ = t.to_number();
     set_number_format(number_format(number_format::format::date_time6));
+    value_changed(d_);
 }
 
 template<>
@@ -762,6 +295,7 @@ void cell::set_value(timedelta t)
     d_->type_ = type::numeric;
     d_->value_numeric_ = t.to_number();
     set_number_format(number_format(number_format::format::date_timedelta));
+    value_changed(d_);
 }
 
 row_t cell::get_row() const
@@ -776,31 +310,34 @@ std::string cell::get_column() const
 
 void cell::set_merged(bool merged)
 {
-    d_->is_merged_ = merged;
+    auto parent = get_parent();
+    
+    if(merged && !is_merged())
+    {
+        parent.merge_cells(range_reference(get_reference(), get_reference()));
+    }
+    else if(!merged && is_merged())
+    {
+        parent.unmerge_cells(parent.get_merged_range(get_reference()));
+    }
 }
 
 bool cell::is_merged() const
 {
-    return d_->is_merged_;
+    return get_parent().is_merged(get_reference());
 }
 
 bool cell::is_date() const
 {
     if(get_data_type() == type::numeric)
     {
-        auto number_format = get_number_format().get_format_string();
-        
-        if(number_format != "General")
+        try
         {
-            try
-            {
-                auto sections = parse_format_sections(number_format);
-                return is_date_format(sections.first.value);
-            }
-            catch(std::exception)
-            {
-                return false;
-            }
+            return get_parent().get_parent().get_number_formatter(d_->style_id_).is_date();
+        }
+        catch(const std::exception &)
+        {
+            return false;
         }
     }
     
@@ -877,15 +414,29 @@ void cell::set_formula(const std::string &formula)
     }
 
     d_->formula_ = formula;
+    d_->shared_formula_ = detail::no_shared_formula;
+    formula_changed(d_);
 }
 
 bool cell::has_formula() const
 {
-    return !d_->formula_.empty();
+    return !d_->formula_.empty() || has_shared_formula();
 }
 
 std::string cell::get_formula() const
 {
+    if(has_shared_formula())
+    {
+        auto &shared = d_->parent_->shared_formulas_[d_->shared_formula_];
+        
+        if(!shared.defined_)
+        {
+            throw data_type_exception();
+        }
+        
+        return shared.translate(get_reference());
+    }
+    
     if(d_->formula_.empty())
     {
         throw data_type_exception();
@@ -897,6 +448,37 @@ std::string cell::get_formula() const
 void cell::clear_formula()
 {
     d_->formula_.clear();
+    d_->shared_formula_ = detail::no_shared_formula;
+    formula_changed(d_);
+}
+
+void cell::set_shared_formula(std::size_t index)
+{
+    auto &shared_formulas = d_->parent_->shared_formulas_;
+    
+    if(index >= shared_formulas.size())
+    {
+        shared_formulas.resize(index + 1);
+    }
+    
+    d_->formula_.clear();
+    d_->shared_formula_ = static_cast<std::uint32_t>(index);
+    formula_changed(d_);
+}
+
+bool cell::has_shared_formula() const
+{
+    return d_->shared_formula_ != detail::no_shared_formula;
+}
+
+std::size_t cell::get_shared_formula_index() const
+{
+    if(!has_shared_formula())
+    {
+        throw data_type_exception();
+    }
+    
+    return d_->shared_formula_;
 }
 
 void cell::set_comment(const xlnt::comment &c)
@@ -938,6 +520,7 @@ void cell::set_error(const std::string &error)
 
     d_->value_string_ = error;
     d_->type_ = type::error;
+    value_changed(d_);
 }
 
 cell cell::offset(column_t column, row_t row)
@@ -968,54 +551,10 @@ comment cell::get_comment()
 
 std::pair<int, int> cell::get_anchor() const
 {
-    static const double DefaultColumnWidth = 51.85;
-    static const double DefaultRowHeight = 15.0;
-
-    auto points_to_pixels = [](double value, double dpi) { return (int)std::ceil(value * dpi / 72); };
-
-    auto left_columns = d_->column_ - 1;
-    auto &column_dimensions = get_parent().get_column_dimensions();
-    int left_anchor = 0;
-    auto default_width = points_to_pixels(DefaultColumnWidth, 96.0);
-
-    for(column_t column_index = 1; column_index <= left_columns; column_index++)
-    {
-        if(column_dimensions.find(column_index) != column_dimensions.end())
-        {
-            auto cdw = column_dimensions.at(column_index);
-
-            if(cdw > 0)
-            {
-                left_anchor += points_to_pixels(cdw, 96.0);
-                continue;
-            }
-        }
-
-        left_anchor += default_width;
-    }
-
-    auto top_rows = d_->row_ - 1;
-    auto &row_dimensions = get_parent().get_row_dimensions();
-    int top_anchor = 0;
-    auto default_height = points_to_pixels(DefaultRowHeight, 96.0);
-
-    for(int row_index = 1; row_index <= (int)top_rows; row_index++)
-    {
-        if(row_dimensions.find(static_cast<row_t>(row_index)) != row_dimensions.end())
-        {
-            auto rdh = row_dimensions.at(static_cast<row_t>(row_index));
-
-            if(rdh > 0)
-            {
-                top_anchor += points_to_pixels(rdh, 96.0);
-                continue;
-            }
-        }
-
-        top_anchor += default_height;
-    }
+    auto left = d_->parent_->column_widths_.get_offset(d_->column_);
+    auto top = d_->parent_->row_heights_.get_offset(d_->row_);
 
-    return {left_anchor, top_anchor};
+    return { static_cast<int>(left), static_cast<int>(top) };
 }
 
 cell::type cell::get_data_type() const
@@ -1026,6 +565,7 @@ cell::type cell::get_data_type() const
 void cell::set_data_type(type t)
 {
     d_->type_ = t;
+    value_changed(d_);
 }
 
 std::size_t cell::get_xf_index() const
@@ -1035,18 +575,7 @@ std::size_t cell::get_xf_index() const
 
 const number_format &cell::get_number_format() const
 {
-    if(d_->has_style_)
-    {
-        return get_parent().get_parent().get_number_format(d_->style_id_);
-    }
-    else if(get_parent().get_parent().get_number_formats().empty())
-    {
-        return number_format::default_number_format();
-    }
-    else
-    {
-        return get_parent().get_parent().get_number_formats().front();
-    }
+    return get_parent().get_parent().get_number_format(d_->style_id_);
 }
     
 const font &cell::get_font() const
@@ -1086,10 +615,17 @@ bool cell::quote_prefix() const
     
 void cell::clear_value()
 {
+    if(has_formula())
+    {
+        formula_changed(d_);
+    }
+    
     d_->value_numeric_ = 0;
     d_->value_string_.clear();
     d_->formula_.clear();
+    d_->shared_formula_ = detail::no_shared_formula;
     d_->type_ = cell::type::null;
+    value_changed(d_);
 }
 
 template<>
@@ -1202,6 +738,36 @@ void cell::set_number_format(const number_format &number_format_)
     d_->style_id_ = get_parent().get_parent().set_number_format(number_format_, d_->style_id_);
 }
 
+void cell::set_font(const font &font_)
+{
+    d_->has_style_ = true;
+    d_->style_id_ = get_parent().get_parent().set_font(font_, d_->style_id_);
+}
+
+void cell::set_fill(const fill &fill_)
+{
+    d_->has_style_ = true;
+    d_->style_id_ = get_parent().get_parent().set_fill(fill_, d_->style_id_);
+}
+
+void cell::set_border(const border &border_)
+{
+    d_->has_style_ = true;
+    d_->style_id_ = get_parent().get_parent().set_border(border_, d_->style_id_);
+}
+
+void cell::set_alignment(const alignment &alignment_)
+{
+    d_->has_style_ = true;
+    d_->style_id_ = get_parent().get_parent().set_alignment(alignment_, d_->style_id_);
+}
+
+void cell::set_protection(const protection &protection_)
+{
+    d_->has_style_ = true;
+    d_->style_id_ = get_parent().get_parent().set_protection(protection_, d_->style_id_);
+}
+
 template<>
 std::string cell::get_value() const
 {
@@ -1215,18 +781,16 @@ bool cell::has_value() const
 
 std::string cell::to_string() const
 {
-    auto nf = get_number_format();
-    
     switch(get_data_type())
     {
         case cell::type::null:
             return "";
         case cell::type::numeric:
-            return format_number(get_value<long double>(), nf.get_format_string(), get_base_date());
+            return get_parent().get_parent().get_number_formatter(d_->style_id_).format(get_value<long double>(), get_base_date());
         case cell::type::string:
         case cell::type::formula:
         case cell::type::error:
-            return format_text(get_value<std::string>(), nf.get_format_string());
+            return get_parent().get_parent().get_number_formatter(d_->style_id_).format(get_value<std::string>());
         case cell::type::boolean:
             return get_value<long double>() == 0 ? "FALSE" : "TRUE";
 		default:
@@ -1238,6 +802,12 @@ std::size_t cell::get_style_id() const
 {
     return d_->style_id_;
 }
+
+void cell::set_style_id(std::size_t style_id)
+{
+    d_->has_style_ = true;
+    d_->style_id_ = style_id;
+}
     
 calendar cell::get_base_date() const
 {
@@ -3,82 +3,142 @@
 
 #include <xlnt/common/datetime.hpp>
 
-namespace xlnt {
+namespace {
 
-time time::from_number(long double raw_time)
+// Days from 1970-01-01 to 1899-12-30, the day before serial 1 once the fictional
+// 1900-02-29 (serial 60) is accounted for.
+const int windows_1900_epoch = -25569;
+
+// Serial 0 in the 1904 calendar is serial 1462 in the 1900 calendar.
+const int mac_1904_offset = 1462;
+
+const long long microseconds_per_day = 86400000000LL;
+
+int get_calendar_offset(xlnt::calendar base_date)
 {
-	time result;
+    return base_date == xlnt::calendar::mac_1904 ? mac_1904_offset : 0;
+}
 
-    double integer_part;
-    double fractional_part = std::modf((double)raw_time, &integer_part);
+// Convert days since 1970-01-01 into a proleptic Gregorian date using the
+// branch-free civil_from_days algorithm (eras of 400 years, March-based years).
+xlnt::date civil_from_days(int days)
+{
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int day_of_era = days - era * 146097;
+    int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int month_index = (5 * day_of_year + 2) / 153;
+    int day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    int month = month_index < 10 ? month_index + 3 : month_index - 9;
+    int year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+    return xlnt::date(year, month, day);
+}
 
-    fractional_part *= 24;
-    result.hour = (int)fractional_part;
-	fractional_part = 60 * (fractional_part - result.hour);
-	result.minute = (int)fractional_part;
-	fractional_part = 60 * (fractional_part - result.minute);
-	result.second = (int)fractional_part;
-	fractional_part = 1000000 * (fractional_part - result.second);
-	result.microsecond = (int)fractional_part;
-	if (result.microsecond == 999999 && fractional_part - result.microsecond > 0.5)
+// serial is already shifted into the 1900 calendar.
+xlnt::date date_from_windows_serial(int serial)
+{
+    // Excel treats 1900 as a leap year so serial 60 is 1900-02-29 and every
+    // earlier serial is one day later than its position would suggest.
+    if(serial == 60)
     {
-		result.microsecond = 0;
-		result.second += 1;
-		if (result.second == 60)
-        {
-			result.second = 0;
-			result.minute += 1;
-			if (result.minute == 60)
-            {
-				result.minute = 0;
-				result.hour += 1;
-            }
-        }
+        return xlnt::date(1900, 2, 29);
     }
-	return result;
+
+    return civil_from_days(windows_1900_epoch + serial + (serial < 60 ? 1 : 0));
 }
 
-date date::from_number(int days_since_base_year, calendar base_date)
+xlnt::time time_from_microseconds(long long microseconds)
 {
-    date result(0, 0, 0);
+    int microsecond = static_cast<int>(microseconds % 1000000);
+    auto seconds = static_cast<int>(microseconds / 1000000);
 
-    if(base_date == calendar::mac_1904)
-    {
-        days_since_base_year += 1462;
-    }
+    return xlnt::time(seconds / 3600, seconds / 60 % 60, seconds % 60, microsecond);
+}
 
-    if(days_since_base_year == 60)
+// Split number into whole days and microseconds into the day, rounding to the
+// nearest microsecond and carrying a full day into the day count.
+void split_number(long double number, long long &days, long long &microseconds)
+{
+    auto whole = std::floor(number);
+    days = static_cast<long long>(whole);
+    microseconds = std::llround((number - whole) * microseconds_per_day);
+
+    if(microseconds >= microseconds_per_day)
     {
-        result.day = 29;
-        result.month = 2;
-        result.year = 1900;
+        days += 1;
+        microseconds -= microseconds_per_day;
     }
-    else if(days_since_base_year < 60)
+}
+
+} // namespace
+
+namespace xlnt {
+
+time time::from_number(long double raw_time)
+{
+    long long days = 0;
+    long long microseconds = 0;
+    split_number(raw_time, days, microseconds);
+
+    return time_from_microseconds(microseconds);
+}
+
+date date::from_number(int days_since_base_year, calendar base_date)
+{
+    return date_from_windows_serial(days_since_base_year + get_calendar_offset(base_date));
+}
+
+std::vector<date> date::from_numbers(const std::vector<int> &days_since_base_year, calendar base_date)
+{
+    auto offset = get_calendar_offset(base_date);
+
+    std::vector<date> result;
+    result.reserve(days_since_base_year.size());
+
+    for(auto serial : days_since_base_year)
     {
-        days_since_base_year++;
+        result.push_back(date_from_windows_serial(serial + offset));
     }
 
-    int l = days_since_base_year + 68569 + 2415019;
-    int n = int((4 * l) / 146097);
-    l = l - int((146097 * n + 3) / 4);
-    int i = int((4000 * (l + 1)) / 1461001);
-    l = l - int((1461 * i) / 4) + 31;
-    int j = int((80 * l) / 2447);
-    result.day = l - int((2447 * j) / 80);
-    l = int(j / 11);
-    result.month = j + 2 - (12 * l);
-    result.year = 100 * (n - 49) + i + l;
-
     return result;
 }
 
 datetime datetime::from_number(long double raw_time, calendar base_date)
 {
-    auto date_part = date::from_number((int)raw_time, base_date);
-    auto time_part = time::from_number(raw_time);
+    long long days = 0;
+    long long microseconds = 0;
+    split_number(raw_time, days, microseconds);
+
+    auto date_part = date_from_windows_serial(static_cast<int>(days) + get_calendar_offset(base_date));
+    auto time_part = time_from_microseconds(microseconds);
+
     return datetime(date_part.year, date_part.month, date_part.day, time_part.hour, time_part.minute, time_part.second, time_part.microsecond);
 }
 
+std::vector<datetime> datetime::from_numbers(const std::vector<long double> &numbers, calendar base_date)
+{
+    auto offset = get_calendar_offset(base_date);
+
+    std::vector<datetime> result;
+    result.reserve(numbers.size());
+
+    for(auto number : numbers)
+    {
+        long long days = 0;
+        long long microseconds = 0;
+        split_number(number, days, microseconds);
+
+        auto date_part = date_from_windows_serial(static_cast<int>(days) + offset);
+        auto time_part = time_from_microseconds(microseconds);
+
+        result.emplace_back(date_part.year, date_part.month, date_part.day, time_part.hour, time_part.minute, time_part.second, time_part.microsecond);
+    }
+
+    return result;
+}
+
 bool date::operator==(const date &comparand) const
 {
     return year == comparand.year
@@ -56,4 +56,10 @@ illegal_character_error::illegal_character_error(char c)
     
 }
 
+formula_syntax_exception::formula_syntax_exception(const std::string &formula, std::size_t offset)
+    : std::runtime_error(std::string("invalid formula at offset ") + std::to_string(offset) + ": " + formula)
+{
+
+}
+
 } // namespace xlnt
@@ -254,7 +254,19 @@ void zip_file::save(const std::string &filename)
 {
     filename_ = filename;
     std::ofstream stream(filename, std::ios::binary);
+    
+    if(!stream)
+    {
+        throw std::runtime_error("couldn't open " + filename + " for writing");
+    }
+    
     save(stream);
+    stream.close();
+    
+    if(!stream)
+    {
+        throw std::runtime_error("couldn't write " + filename);
+    }
 }
 
 void zip_file::save(std::ostream &stream)
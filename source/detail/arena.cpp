@@ -0,0 +1,82 @@
+#include <new>
+
+#include "arena.hpp"
+
+namespace {
+
+std::size_t round_up(std::size_t size)
+{
+    auto granularity = xlnt::detail::arena::granularity;
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+arena::arena() : cursor_(nullptr), remaining_(0)
+{
+    free_lists_.fill(nullptr);
+}
+
+void *arena::allocate(std::size_t size)
+{
+    auto rounded = round_up(size == 0 ? 1 : size);
+
+    if(rounded > max_pooled_size)
+    {
+        return ::operator new(size);
+    }
+
+    auto &free_list = free_lists_[rounded / granularity - 1];
+
+    if(free_list != nullptr)
+    {
+        auto block = free_list;
+        free_list = *static_cast<void **>(block);
+        return block;
+    }
+
+    if(remaining_ < rounded)
+    {
+        chunks_.emplace_back(new unsigned char[chunk_size]);
+        cursor_ = chunks_.back().get();
+        remaining_ = chunk_size;
+    }
+
+    auto block = cursor_;
+    cursor_ += rounded;
+    remaining_ -= rounded;
+
+    return block;
+}
+
+void arena::deallocate(void *pointer, std::size_t size) noexcept
+{
+    if(pointer == nullptr)
+    {
+        return;
+    }
+
+    auto rounded = round_up(size == 0 ? 1 : size);
+
+    if(rounded > max_pooled_size)
+    {
+        ::operator delete(pointer);
+        return;
+    }
+
+    // Freed blocks are threaded onto a list for their size class and reused by later allocations.
+    auto &free_list = free_lists_[rounded / granularity - 1];
+    *static_cast<void **>(pointer) = free_list;
+    free_list = pointer;
+}
+
+std::size_t arena::get_reserved_bytes() const
+{
+    return chunks_.size() * chunk_size;
+}
+
+} // namespace detail
+} // namespace xlnt
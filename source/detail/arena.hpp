@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Hands out small blocks carved from large chunks and recycles freed blocks by size.
+/// Every chunk is released at once when the arena is destroyed.
+/// Requests larger than max_pooled_size go straight to the global allocator.
+/// </summary>
+class arena
+{
+public:
+    static const std::size_t granularity = 16;
+    static const std::size_t max_pooled_size = 1024;
+    static const std::size_t chunk_size = 64 * 1024;
+
+    arena();
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    void *allocate(std::size_t size);
+    void deallocate(void *pointer, std::size_t size) noexcept;
+
+    /// <summary>
+    /// Number of bytes obtained from the global allocator for pooled blocks.
+    /// </summary>
+    std::size_t get_reserved_bytes() const;
+
+private:
+    std::vector<std::unique_ptr<unsigned char[]>> chunks_;
+    unsigned char *cursor_;
+    std::size_t remaining_;
+    std::array<void *, max_pooled_size / granularity> free_lists_;
+};
+
+/// <summary>
+/// Standard allocator adaptor for arena. A default constructed allocator has
+/// no arena and forwards to the global allocator.
+/// </summary>
+template<typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    static_assert(alignof(T) <= arena::granularity, "arena blocks are not aligned strictly enough for this type");
+
+    arena_allocator() noexcept : arena_(nullptr)
+    {
+    }
+
+    explicit arena_allocator(arena *source) noexcept : arena_(source)
+    {
+    }
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U> &other) noexcept : arena_(other.get_arena())
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        if(arena_ == nullptr)
+        {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        return static_cast<T *>(arena_->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *pointer, std::size_t n) noexcept
+    {
+        if(arena_ == nullptr)
+        {
+            ::operator delete(pointer);
+            return;
+        }
+
+        arena_->deallocate(pointer, n * sizeof(T));
+    }
+
+    arena *get_arena() const noexcept
+    {
+        return arena_;
+    }
+
+private:
+    arena *arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const arena_allocator<T> &left, const arena_allocator<U> &right)
+{
+    return left.get_arena() == right.get_arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const arena_allocator<T> &left, const arena_allocator<U> &right)
+{
+    return !(left == right);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -20,10 +20,11 @@ cell_impl::cell_impl(worksheet_impl *parent, column_t column, row_t row)
       column_(column),
       row_(row),
       value_numeric_(0),
+      shared_formula_(no_shared_formula),
       has_hyperlink_(false),
-      is_merged_(false),
       xf_index_(0),
       has_style_(false),
+      changed_(false),
       style_id_(0),
       comment_(nullptr)
 {
@@ -34,6 +35,11 @@ cell_impl::cell_impl(const cell_impl &rhs)
     *this = rhs;
 }
     
+cell_impl::cell_impl(cell_impl &&rhs) noexcept
+{
+    *this = std::move(rhs);
+}
+    
 cell_impl &cell_impl::operator=(const cell_impl &rhs)
 {
     parent_ = rhs.parent_;
@@ -41,17 +47,37 @@ cell_impl &cell_impl::operator=(const cell_impl &rhs)
     value_string_ = rhs.value_string_;
     hyperlink_ = rhs.hyperlink_;
     formula_ = rhs.formula_;
+    shared_formula_ = rhs.shared_formula_;
     column_ = rhs.column_;
     row_ = rhs.row_;
-    is_merged_ = rhs.is_merged_;
     has_hyperlink_ = rhs.has_hyperlink_;
     type_ = rhs.type_;
+    xf_index_ = rhs.xf_index_;
+    has_style_ = rhs.has_style_;
+    changed_ = false;
     style_id_ = rhs.style_id_;
+    comment_.reset(rhs.comment_ == nullptr ? nullptr : new comment_impl(*rhs.comment_));
     
-    if(rhs.comment_ != nullptr)
-    {
-        comment_.reset(new comment_impl(*rhs.comment_));
-    }
+    return *this;
+}
+    
+cell_impl &cell_impl::operator=(cell_impl &&rhs) noexcept
+{
+    parent_ = rhs.parent_;
+    value_numeric_ = rhs.value_numeric_;
+    value_string_ = std::move(rhs.value_string_);
+    hyperlink_ = std::move(rhs.hyperlink_);
+    formula_ = std::move(rhs.formula_);
+    shared_formula_ = rhs.shared_formula_;
+    column_ = rhs.column_;
+    row_ = rhs.row_;
+    has_hyperlink_ = rhs.has_hyperlink_;
+    type_ = rhs.type_;
+    xf_index_ = rhs.xf_index_;
+    has_style_ = rhs.has_style_;
+    changed_ = false;
+    style_id_ = rhs.style_id_;
+    comment_ = std::move(rhs.comment_);
     
     return *this;
 }
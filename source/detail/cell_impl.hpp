@@ -116,22 +116,27 @@ namespace detail {
 
 struct worksheet_impl;
     
+// Value of cell_impl::shared_formula_ for a cell not in a shared formula group.
+const std::uint32_t no_shared_formula = 0xFFFFFFFF;
+
 struct cell_impl
 {
     cell_impl();
     cell_impl(column_t column, row_t row);
     cell_impl(worksheet_impl *parent, column_t column, row_t row);
     cell_impl(const cell_impl &rhs);
+    cell_impl(cell_impl &&rhs) noexcept;
     cell_impl &operator=(const cell_impl &rhs);
+    cell_impl &operator=(cell_impl &&rhs) noexcept;
     
     cell self()
     {
         return xlnt::cell(this);
     }
     
-    void set_string(const std::string &s, bool guess_types)
+    void set_string(std::string s, bool guess_types)
     {
-        value_string_ = check_string(s);
+        value_string_ = check_string(std::move(s));
         type_ = cell::type::string;
         
         if (value_string_.size() > 1 && value_string_.front() == '=')
@@ -140,13 +145,13 @@ struct cell_impl
             type_ = cell::type::formula;
             value_string_.clear();
         }
-        else if(cell::ErrorCodes.find(s) != cell::ErrorCodes.end())
+        else if(cell::ErrorCodes.find(value_string_) != cell::ErrorCodes.end())
         {
             type_ = cell::type::error;
         }
         else if(guess_types)
         {
-            auto percentage = cast_percentage(s);
+            auto percentage = cast_percentage(value_string_);
             
             if (percentage.first)
             {
@@ -156,7 +161,7 @@ struct cell_impl
             }
             else
             {
-                auto time = cast_time(s);
+                auto time = cast_time(value_string_);
                 
                 if (time.first)
                 {
@@ -166,7 +171,7 @@ struct cell_impl
                 }
                 else
                 {
-                    auto numeric = cast_numeric(s);
+                    auto numeric = cast_numeric(value_string_);
                     
                     if (numeric.first)
                     {
@@ -190,14 +195,18 @@ struct cell_impl
     
     std::string formula_;
     
+    // Index into the parent sheet's shared formulas, used instead of formula_ when set.
+    std::uint32_t shared_formula_;
+    
     bool has_hyperlink_;
     relationship hyperlink_;
     
-    bool is_merged_;
-    
     std::size_t xf_index_;
     
     bool has_style_;
+    
+    // Whether the cell is already queued in its sheet's changed_cells_.
+    bool changed_;
     std::size_t style_id_;
     
     std::unique_ptr<comment_impl> comment_;
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <xlnt/common/types.hpp>
+
+#include "cell_impl.hpp"
+#include "worksheet_impl.hpp"
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Call f(row, column, cell) for every existing cell of worksheet in the block from first_column,
+/// first_row to last_column, last_row in row-major order. Depending on the size of the block either
+/// each position is looked up or the sheet's cells are scanned, so whole-column blocks like A:A
+/// cost time proportional to the cells that exist. No cells are created.
+/// </summary>
+template<typename F>
+void scan_cells(const worksheet_impl &worksheet, column_t first_column, row_t first_row,
+    column_t last_column, row_t last_row, F f)
+{
+    auto &cells = worksheet.cell_map_;
+    std::vector<row_t> rows;
+
+    if(last_row - first_row < cells.size())
+    {
+        for(auto row = first_row; row <= last_row; row++)
+        {
+            if(cells.find(row) != cells.end())
+            {
+                rows.push_back(row);
+            }
+        }
+    }
+    else
+    {
+        for(auto &row : cells)
+        {
+            if(row.first >= first_row && row.first <= last_row)
+            {
+                rows.push_back(row.first);
+            }
+        }
+
+        std::sort(rows.begin(), rows.end());
+    }
+
+    std::vector<column_t> columns;
+
+    for(auto row : rows)
+    {
+        auto &row_cells = cells.find(row)->second;
+        columns.clear();
+
+        if(last_column - first_column < row_cells.size())
+        {
+            for(auto column = first_column; column <= last_column; column++)
+            {
+                if(row_cells.find(column) != row_cells.end())
+                {
+                    columns.push_back(column);
+                }
+            }
+        }
+        else
+        {
+            for(auto &cell : row_cells)
+            {
+                if(cell.first >= first_column && cell.first <= last_column)
+                {
+                    columns.push_back(cell.first);
+                }
+            }
+
+            std::sort(columns.begin(), columns.end());
+        }
+
+        for(auto column : columns)
+        {
+            f(row, column, row_cells.find(column)->second);
+        }
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -20,5 +20,18 @@ comment_impl &comment_impl::operator=(const xlnt::detail::comment_impl &rhs)
     return *this;
 }
     
+comment_impl::comment_impl(comment_impl &&rhs) noexcept
+{
+    *this = std::move(rhs);
+}
+
+comment_impl &comment_impl::operator=(comment_impl &&rhs) noexcept
+{
+    text_ = std::move(rhs.text_);
+    author_ = std::move(rhs.author_);
+    
+    return *this;
+}
+    
 } // namespace detail
 } // namespace xlnt
@@ -12,7 +12,9 @@ struct comment_impl
     comment_impl();
     comment_impl(cell_impl *parent, const std::string &text, const std::string &author);
     comment_impl(const comment_impl &rhs);
+    comment_impl(comment_impl &&rhs) noexcept;
     comment_impl &operator=(const comment_impl &rhs);
+    comment_impl &operator=(comment_impl &&rhs) noexcept;
     
     std::string text_;
     std::string author_;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Append-only list of distinct values where each value is stored once and identified by
+/// its position. intern finds an equal value through its hash() in amortized constant time.
+/// </summary>
+template<typename T>
+class component_table
+{
+public:
+    std::size_t intern(const T &value)
+    {
+        auto hash = value.hash();
+        auto candidates = lookup_.equal_range(hash);
+
+        for(auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if(values_[candidate->second] == value)
+            {
+                return candidate->second;
+            }
+        }
+
+        values_.push_back(value);
+        lookup_.emplace(hash, values_.size() - 1);
+
+        return values_.size() - 1;
+    }
+
+    const T &operator[](std::size_t index) const
+    {
+        return values_[index];
+    }
+
+    std::size_t size() const
+    {
+        return values_.size();
+    }
+
+    bool empty() const
+    {
+        return values_.empty();
+    }
+
+    void clear()
+    {
+        values_.clear();
+        lookup_.clear();
+    }
+
+    const std::vector<T> &get_values() const
+    {
+        return values_;
+    }
+
+private:
+    std::vector<T> values_;
+    std::unordered_multimap<std::size_t, std::size_t> lookup_;
+};
+
+} // namespace detail
+} // namespace xlnt
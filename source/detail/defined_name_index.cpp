@@ -0,0 +1,184 @@
+#include <algorithm>
+
+#include "defined_name_index.hpp"
+#include "fold_case.hpp"
+
+namespace xlnt {
+namespace detail {
+
+void defined_name_index::set(const std::string &name, const worksheet_impl *scope, worksheet_impl *sheet, const range_reference &reference)
+{
+    auto &definitions = names_[fold_case(name)];
+
+    for(auto &definition : definitions)
+    {
+        if(definition.scope == scope)
+        {
+            definition = { name, scope, sheet, reference };
+            return;
+        }
+    }
+
+    definitions.push_back({ name, scope, sheet, reference });
+}
+
+bool defined_name_index::remove(const std::string &name, const worksheet_impl *scope)
+{
+    auto match = names_.find(fold_case(name));
+
+    if(match == names_.end())
+    {
+        return false;
+    }
+
+    auto &definitions = match->second;
+    auto definition = std::find_if(definitions.begin(), definitions.end(),
+        [scope](const defined_name &d) { return d.scope == scope; });
+
+    if(definition == definitions.end())
+    {
+        return false;
+    }
+
+    definitions.erase(definition);
+
+    if(definitions.empty())
+    {
+        names_.erase(match);
+    }
+
+    return true;
+}
+
+const defined_name *defined_name_index::find(const std::string &name, const worksheet_impl *scope) const
+{
+    auto match = names_.find(fold_case(name));
+
+    if(match == names_.end())
+    {
+        return nullptr;
+    }
+
+    for(auto &definition : match->second)
+    {
+        if(definition.scope == scope)
+        {
+            return &definition;
+        }
+    }
+
+    return nullptr;
+}
+
+const defined_name *defined_name_index::find_any(const std::string &name) const
+{
+    auto match = names_.find(fold_case(name));
+
+    if(match == names_.end())
+    {
+        return nullptr;
+    }
+
+    for(auto &definition : match->second)
+    {
+        if(definition.scope == nullptr)
+        {
+            return &definition;
+        }
+    }
+
+    return &match->second.front();
+}
+
+const defined_name *defined_name_index::find_for_sheet(const std::string &name, const worksheet_impl *sheet) const
+{
+    auto match = names_.find(fold_case(name));
+
+    if(match == names_.end())
+    {
+        return nullptr;
+    }
+
+    const defined_name *global = nullptr;
+
+    for(auto &definition : match->second)
+    {
+        if(definition.scope == sheet)
+        {
+            return &definition;
+        }
+
+        if(definition.scope == nullptr && definition.sheet == sheet)
+        {
+            global = &definition;
+        }
+    }
+
+    return global;
+}
+
+std::vector<const defined_name *> defined_name_index::get_names() const
+{
+    std::vector<const defined_name *> names;
+
+    for(auto &definitions : names_)
+    {
+        for(auto &definition : definitions.second)
+        {
+            names.push_back(&definition);
+        }
+    }
+
+    return names;
+}
+
+void defined_name_index::remove_sheet(const worksheet_impl *sheet)
+{
+    for(auto definitions = names_.begin(); definitions != names_.end();)
+    {
+        auto &list = definitions->second;
+        list.erase(std::remove_if(list.begin(), list.end(),
+            [sheet](const defined_name &d) { return d.scope == sheet || d.sheet == sheet; }), list.end());
+
+        definitions = list.empty() ? names_.erase(definitions) : std::next(definitions);
+    }
+}
+
+void defined_name_index::copy_sheet(const defined_name_index &source, const worksheet_impl *from, worksheet_impl *to)
+{
+    for(auto &definitions : source.names_)
+    {
+        for(auto &definition : definitions.second)
+        {
+            // A local name referring to another sheet of the source workbook has nothing to refer to here.
+            if(definition.scope == from && definition.sheet == from)
+            {
+                set(definition.name, to, to, definition.reference);
+            }
+        }
+    }
+}
+
+void defined_name_index::rebind(const std::unordered_map<const worksheet_impl *, worksheet_impl *> &sheets)
+{
+    for(auto &definitions : names_)
+    {
+        for(auto &definition : definitions.second)
+        {
+            if(definition.scope != nullptr)
+            {
+                definition.scope = sheets.at(definition.scope);
+            }
+
+            definition.sheet = sheets.at(definition.sheet);
+        }
+    }
+}
+
+void defined_name_index::clear()
+{
+    names_.clear();
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct worksheet_impl;
+
+/// <summary>
+/// A defined name with its target already parsed.
+/// </summary>
+struct defined_name
+{
+    std::string name;
+
+    // The sheet the name is local to or nullptr if it can be used throughout the workbook.
+    const worksheet_impl *scope;
+
+    worksheet_impl *sheet;
+    range_reference reference;
+};
+
+/// <summary>
+/// Every defined name of a workbook hashed by name, ignoring case like spreadsheet applications
+/// do. The same name may be defined once in the workbook scope and once in each sheet scope.
+/// </summary>
+class defined_name_index
+{
+public:
+    /// <summary>
+    /// Define name in scope as reference on sheet, replacing any earlier definition in that scope.
+    /// </summary>
+    void set(const std::string &name, const worksheet_impl *scope, worksheet_impl *sheet, const range_reference &reference);
+
+    /// <summary>
+    /// Remove the definition of name in scope. Returns false if there was none.
+    /// </summary>
+    bool remove(const std::string &name, const worksheet_impl *scope);
+
+    /// <summary>
+    /// Return the definition of name in exactly scope or nullptr if there is none.
+    /// </summary>
+    const defined_name *find(const std::string &name, const worksheet_impl *scope) const;
+
+    /// <summary>
+    /// Return the workbook scope definition of name, otherwise the earliest sheet scope one.
+    /// </summary>
+    const defined_name *find_any(const std::string &name) const;
+
+    /// <summary>
+    /// Return the definition of name as seen from sheet: its own, otherwise a workbook scope one
+    /// that refers to it.
+    /// </summary>
+    const defined_name *find_for_sheet(const std::string &name, const worksheet_impl *sheet) const;
+
+    std::vector<const defined_name *> get_names() const;
+
+    /// <summary>
+    /// Drop every name local to or referring to sheet, which is about to be destroyed.
+    /// </summary>
+    void remove_sheet(const worksheet_impl *sheet);
+
+    /// <summary>
+    /// Add the names local to from in source as names local to to, which is a copy of from.
+    /// </summary>
+    void copy_sheet(const defined_name_index &source, const worksheet_impl *from, worksheet_impl *to);
+
+    /// <summary>
+    /// Point scopes and targets at the sheets that replaced them after a workbook was copied.
+    /// </summary>
+    void rebind(const std::unordered_map<const worksheet_impl *, worksheet_impl *> &sheets);
+
+    void clear();
+
+private:
+    // Definitions by case folded name. Each name is rarely defined in more than one scope,
+    // so the scopes sharing a name are searched one by one.
+    std::unordered_map<std::string, std::vector<defined_name>> names_;
+};
+
+} // namespace detail
+} // namespace xlnt
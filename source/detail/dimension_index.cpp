@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dimension_index.hpp"
+
+namespace xlnt {
+namespace detail {
+
+int dimension_index::points_to_pixels(double points)
+{
+    return static_cast<int>(std::ceil(points * 96 / 72));
+}
+
+dimension_index::dimension_index(int default_size) : default_size_(default_size)
+{
+}
+
+void dimension_index::set(std::uint32_t index, int size)
+{
+    // The tree has no slot 0 and updating one would never leave the loop below.
+    if(index == 0)
+    {
+        return;
+    }
+    
+    grow(index);
+
+    auto change = static_cast<long long>(size - default_size_) - differences_[index];
+    differences_[index] = size - default_size_;
+
+    for(std::size_t i = index; i < tree_.size(); i += i & (~i + 1))
+    {
+        tree_[i] += change;
+    }
+}
+
+void dimension_index::reset(std::uint32_t index)
+{
+    if(index < differences_.size())
+    {
+        set(index, default_size_);
+    }
+}
+
+long long dimension_index::get_offset(std::uint32_t index) const
+{
+    if(index <= 1)
+    {
+        return 0;
+    }
+
+    auto before = static_cast<std::size_t>(index - 1);
+    auto stored = std::min(before, tree_.empty() ? std::size_t(0) : tree_.size() - 1);
+
+    return static_cast<long long>(default_size_) * static_cast<long long>(before) + prefix(stored);
+}
+
+std::uint32_t dimension_index::find(long long offset) const
+{
+    if(offset < 0)
+    {
+        return 1;
+    }
+
+    // Descend the tree for the last index ending at or before offset. Sizes are never negative
+    // so the running total only grows and each level can be decided on its own.
+    std::size_t capacity = tree_.empty() ? 0 : tree_.size() - 1;
+    std::size_t position = 0;
+    long long total = 0;
+
+    for(auto step = capacity; step > 0; step /= 2)
+    {
+        if(position + step > capacity)
+        {
+            continue;
+        }
+
+        auto span = tree_[position + step] + static_cast<long long>(default_size_) * static_cast<long long>(step);
+
+        if(total + span <= offset)
+        {
+            position += step;
+            total += span;
+        }
+    }
+
+    // Everything after the stored span has the default size.
+    if(position == capacity && default_size_ > 0)
+    {
+        position += static_cast<std::size_t>((offset - total) / default_size_);
+    }
+
+    return static_cast<std::uint32_t>(position + 1);
+}
+
+void dimension_index::grow(std::uint32_t index)
+{
+    if(index < differences_.size())
+    {
+        return;
+    }
+
+    std::size_t capacity = 1;
+
+    while(capacity < index)
+    {
+        capacity *= 2;
+    }
+
+    differences_.resize(capacity + 1, 0);
+    tree_.assign(capacity + 1, 0);
+
+    for(std::size_t i = 1; i <= capacity; i++)
+    {
+        tree_[i] += differences_[i];
+        auto parent = i + (i & (~i + 1));
+
+        if(parent <= capacity)
+        {
+            tree_[parent] += tree_[i];
+        }
+    }
+}
+
+long long dimension_index::prefix(std::size_t count) const
+{
+    long long total = 0;
+
+    for(auto i = count; i > 0; i -= i & (~i + 1))
+    {
+        total += tree_[i];
+    }
+
+    return total;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Pixel sizes of the columns or rows of a worksheet, numbered from 1, as a Fenwick tree of
+/// differences from the default size. Both the offset of an index and the index at an offset
+/// are found in logarithmic time. Only the span up to the highest customized index is stored.
+/// </summary>
+class dimension_index
+{
+public:
+    /// <summary>
+    /// Convert a size in points to whole pixels at 96 dpi, rounding up.
+    /// </summary>
+    static int points_to_pixels(double points);
+
+    explicit dimension_index(int default_size);
+
+    /// <summary>
+    /// Set the size of index in pixels, which must not be negative. Index 0 is ignored.
+    /// </summary>
+    void set(std::uint32_t index, int size);
+
+    /// <summary>
+    /// Give index the default size again.
+    /// </summary>
+    void reset(std::uint32_t index);
+
+    /// <summary>
+    /// The total size of every index before index, which is where index starts.
+    /// </summary>
+    long long get_offset(std::uint32_t index) const;
+
+    /// <summary>
+    /// The index spanning offset. Negative offsets are in index 1 and indices with a size of
+    /// 0 are never returned.
+    /// </summary>
+    std::uint32_t find(long long offset) const;
+
+private:
+    void grow(std::uint32_t index);
+    long long prefix(std::size_t count) const;
+
+    int default_size_;
+
+    // differences_[i] is the size of index i minus the default, tree_ sums them Fenwick style.
+    // Both have capacity + 1 elements, capacity being 0 or a power of two.
+    std::vector<int> differences_;
+    std::vector<long long> tree_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cctype>
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Lower case copy of text for comparing names that spreadsheet applications treat as equal
+/// regardless of case, like sheet titles and defined names.
+/// </summary>
+inline std::string fold_case(const std::string &text)
+{
+    auto folded = text;
+
+    for(auto &c : folded)
+    {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    return folded;
+}
+
+} // namespace detail
+} // namespace xlnt
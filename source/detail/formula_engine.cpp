@@ -0,0 +1,491 @@
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+#include "cell_impl.hpp"
+#include "formula_engine.hpp"
+#include "workbook_impl.hpp"
+#include "worksheet_impl.hpp"
+
+namespace {
+
+const std::size_t no_position = static_cast<std::size_t>(-1);
+
+// Starting a thread costs about as much as evaluating a few hundred simple formulas, so
+// each thread is given at least this many cells of a level or the level is run serially.
+const std::size_t min_cells_per_thread = 512;
+
+std::uint64_t position_key(std::size_t sheet, column_t column, row_t row)
+{
+    // Rows fit in 21 bits and columns in 15, leaving the high bits for the sheet index.
+    return (static_cast<std::uint64_t>(sheet) << 36) | (static_cast<std::uint64_t>(column) << 21) | row;
+}
+
+// Sort intervals by where they start and record how far each prefix of them reaches.
+template<typename Interval>
+void index_intervals(std::vector<Interval> &intervals)
+{
+    std::sort(intervals.begin(), intervals.end(),
+        [](const Interval &a, const Interval &b) { return a.first < b.first || (a.first == b.first && a.last < b.last); });
+
+    std::uint32_t reach = 0;
+
+    for(auto &interval : intervals)
+    {
+        reach = std::max(reach, interval.last);
+        interval.reach = reach;
+    }
+}
+
+// Call visit with the node of every interval covering position, walking back from the last
+// interval starting at or before it until none of the earlier ones reach it.
+template<typename Interval, typename Visitor>
+void find_intervals(const std::vector<Interval> &intervals, std::uint32_t position, Visitor visit)
+{
+    auto end = std::upper_bound(intervals.begin(), intervals.end(), position,
+        [](std::uint32_t value, const Interval &interval) { return value < interval.first; });
+
+    for(auto i = end; i != intervals.begin() && (i - 1)->reach >= position; --i)
+    {
+        if((i - 1)->last >= position)
+        {
+            visit((i - 1)->node);
+        }
+    }
+}
+
+void store_result(xlnt::detail::cell_impl &cell, const xlnt::detail::formula_value &result)
+{
+    switch(result.type_)
+    {
+    case xlnt::detail::formula_value::type::string:
+        cell.type_ = xlnt::cell::type::string;
+        cell.value_string_ = result.text_;
+        cell.value_numeric_ = 0;
+        break;
+    case xlnt::detail::formula_value::type::boolean:
+        cell.type_ = xlnt::cell::type::boolean;
+        cell.value_string_.clear();
+        cell.value_numeric_ = result.number_;
+        break;
+    case xlnt::detail::formula_value::type::error:
+        cell.type_ = xlnt::cell::type::error;
+        cell.value_string_ = result.text_;
+        cell.value_numeric_ = 0;
+        break;
+    default:
+        // A formula that only refers to an empty cell shows 0.
+        cell.type_ = xlnt::cell::type::numeric;
+        cell.value_string_.clear();
+        cell.value_numeric_ = result.number_;
+        break;
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+formula_engine::formula_engine(workbook_impl &workbook)
+{
+    build(workbook);
+    order();
+}
+
+void formula_engine::build(workbook_impl &workbook)
+{
+    auto sheet_count = workbook.worksheets_.size();
+
+    for(std::size_t sheet = 0; sheet < sheet_count; sheet++)
+    {
+        // Visit each sheet's formulas in row-major order so results don't depend on hash order.
+        std::vector<std::pair<std::pair<row_t, column_t>, cell_impl *>> formula_cells;
+
+        auto &worksheet = *workbook.worksheets_[sheet];
+        worksheet.track_changes_ = true;
+        worksheet.dependencies_changed_ = false;
+        worksheet.clear_changed_cells();
+
+        for(auto &row : worksheet.cell_map_)
+        {
+            for(auto &cell : row.second)
+            {
+                if(!cell.second.formula_.empty() || cell.second.shared_formula_ != no_shared_formula)
+                {
+                    formula_cells.push_back({ { row.first, cell.first }, &cell.second });
+                }
+            }
+        }
+
+        std::sort(formula_cells.begin(), formula_cells.end());
+
+        for(auto &formula_cell : formula_cells)
+        {
+            auto cell = formula_cell.second;
+            nodes_.push_back({ sheet, formula_cell.first.second, formula_cell.first.first, cell,
+                formula_program(cell->self().get_formula(), workbook, sheet), {}, 0 });
+            formula_cells_[position_key(sheet, nodes_.back().column, nodes_.back().row)] = nodes_.size() - 1;
+        }
+    }
+
+    // Formula cells of each sheet by column in ascending row order, so the formulas inside a
+    // referenced block can be found without visiting every position in it.
+    std::vector<std::unordered_map<column_t, std::vector<std::pair<row_t, std::size_t>>>> formula_columns(sheet_count);
+
+    for(std::size_t i = 0; i < nodes_.size(); i++)
+    {
+        formula_columns[nodes_[i].sheet][nodes_[i].column].emplace_back(nodes_[i].row, i);
+    }
+
+    for(std::size_t i = 0; i < nodes_.size(); i++)
+    {
+        for(auto &reference : nodes_[i].program.get_references())
+        {
+            if(reference.first_column == reference.last_column && reference.first_row == reference.last_row)
+            {
+                cell_readers_[position_key(reference.sheet, reference.first_column, reference.first_row)].push_back(i);
+            }
+            else if(reference.last_column - reference.first_column <= reference.last_row - reference.first_row)
+            {
+                for(auto column = reference.first_column; column <= reference.last_column; column++)
+                {
+                    column_readers_[position_key(reference.sheet, column, 0)].push_back({ reference.first_row, reference.last_row, 0, i });
+                }
+            }
+            else
+            {
+                for(auto row = reference.first_row; row <= reference.last_row; row++)
+                {
+                    row_readers_[position_key(reference.sheet, 0, row)].push_back({ reference.first_column, reference.last_column, 0, i });
+                }
+            }
+
+            auto &columns = formula_columns[reference.sheet];
+
+            auto link = [&](const std::vector<std::pair<row_t, std::size_t>> &column)
+            {
+                auto precedent = std::lower_bound(column.begin(), column.end(), std::make_pair(reference.first_row, std::size_t(0)));
+
+                for(; precedent != column.end() && precedent->first <= reference.last_row; ++precedent)
+                {
+                    nodes_[precedent->second].dependents.push_back(i);
+                }
+            };
+
+            if(reference.last_column - reference.first_column < columns.size())
+            {
+                for(auto column = reference.first_column; column <= reference.last_column; column++)
+                {
+                    auto match = columns.find(column);
+
+                    if(match != columns.end())
+                    {
+                        link(match->second);
+                    }
+                }
+            }
+            else
+            {
+                for(auto &column : columns)
+                {
+                    if(column.first >= reference.first_column && column.first <= reference.last_column)
+                    {
+                        link(column.second);
+                    }
+                }
+            }
+        }
+    }
+
+    for(auto &readers : column_readers_)
+    {
+        index_intervals(readers.second);
+    }
+
+    for(auto &readers : row_readers_)
+    {
+        index_intervals(readers.second);
+    }
+}
+
+void formula_engine::order()
+{
+    std::vector<std::size_t> precedent_counts(nodes_.size(), 0);
+
+    for(auto &formula : nodes_)
+    {
+        for(auto dependent : formula.dependents)
+        {
+            precedent_counts[dependent]++;
+        }
+    }
+
+    order_.clear();
+    order_.reserve(nodes_.size());
+
+    for(std::size_t i = 0; i < nodes_.size(); i++)
+    {
+        if(precedent_counts[i] == 0)
+        {
+            order_.push_back(i);
+        }
+    }
+
+    // Kahn's algorithm. Cells on a cycle never reach a count of zero and neither do the
+    // cells reading them, so both are left out.
+    // A cell's level is one more than the deepest of its precedents and is final by the
+    // time the cell is reached.
+    std::size_t level_count = order_.empty() ? 0 : 1;
+
+    for(std::size_t next = 0; next < order_.size(); next++)
+    {
+        auto &precedent = nodes_[order_[next]];
+
+        for(auto dependent : precedent.dependents)
+        {
+            nodes_[dependent].level = std::max(nodes_[dependent].level, precedent.level + 1);
+            level_count = std::max(level_count, nodes_[dependent].level + 1);
+
+            if(--precedent_counts[dependent] == 0)
+            {
+                order_.push_back(dependent);
+            }
+        }
+    }
+
+    // Group the order by level, keeping row-major order within a level. Cells in one level
+    // never read each other so each level can be split between threads.
+    std::vector<std::size_t> level_starts(level_count + 1, 0);
+
+    for(auto index : order_)
+    {
+        level_starts[nodes_[index].level + 1]++;
+    }
+
+    for(std::size_t level = 0; level < level_count; level++)
+    {
+        level_starts[level + 1] += level_starts[level];
+    }
+
+    std::vector<std::size_t> by_level(order_.size());
+
+    for(auto index : order_)
+    {
+        by_level[level_starts[nodes_[index].level]++] = index;
+    }
+
+    order_.swap(by_level);
+
+    positions_.assign(nodes_.size(), no_position);
+
+    for(std::size_t position = 0; position < order_.size(); position++)
+    {
+        positions_[order_[position]] = position;
+    }
+}
+
+void formula_engine::calculate(workbook_impl &workbook)
+{
+    for(auto &worksheet : workbook.worksheets_)
+    {
+        worksheet->clear_changed_cells();
+    }
+
+    evaluate_levels(workbook, order_);
+
+    // Cells left out of the order have no value that could be computed.
+    for(std::size_t i = 0; i < nodes_.size(); i++)
+    {
+        if(positions_[i] == no_position)
+        {
+            store_result(*nodes_[i].cell, formula_value::error("#REF!"));
+        }
+    }
+}
+
+void formula_engine::recalculate(workbook_impl &workbook)
+{
+    std::vector<std::size_t> affected;
+    std::vector<bool> queued(nodes_.size(), false);
+
+    auto enqueue = [&](std::size_t index)
+    {
+        if(!queued[index])
+        {
+            queued[index] = true;
+            affected.push_back(index);
+        }
+    };
+
+    for(std::size_t sheet = 0; sheet < workbook.worksheets_.size(); sheet++)
+    {
+        auto &worksheet = *workbook.worksheets_[sheet];
+
+        for(auto changed : worksheet.changed_cells_)
+        {
+            auto key = position_key(sheet, changed->column_, changed->row_);
+
+            // A formula cell given a value directly is restored by evaluating it again.
+            auto formula_cell = formula_cells_.find(key);
+
+            if(formula_cell != formula_cells_.end())
+            {
+                enqueue(formula_cell->second);
+            }
+
+            auto readers = cell_readers_.find(key);
+
+            if(readers != cell_readers_.end())
+            {
+                for(auto reader : readers->second)
+                {
+                    enqueue(reader);
+                }
+            }
+
+            auto column_readers = column_readers_.find(position_key(sheet, changed->column_, 0));
+
+            if(column_readers != column_readers_.end())
+            {
+                find_intervals(column_readers->second, changed->row_, enqueue);
+            }
+
+            auto row_readers = row_readers_.find(position_key(sheet, 0, changed->row_));
+
+            if(row_readers != row_readers_.end())
+            {
+                find_intervals(row_readers->second, changed->column_, enqueue);
+            }
+        }
+
+        worksheet.clear_changed_cells();
+    }
+
+    for(std::size_t next = 0; next < affected.size(); next++)
+    {
+        for(auto dependent : nodes_[affected[next]].dependents)
+        {
+            enqueue(dependent);
+        }
+    }
+
+    // Evaluate in the order calculate uses, which puts every cell after its precedents.
+    // Cells on or reading a cycle are given their error again in case a value replaced it.
+    auto circular = std::partition(affected.begin(), affected.end(),
+        [this](std::size_t index) { return positions_[index] != no_position; });
+
+    for(auto i = circular; i != affected.end(); ++i)
+    {
+        store_result(*nodes_[*i].cell, formula_value::error("#REF!"));
+    }
+
+    affected.erase(circular, affected.end());
+    std::sort(affected.begin(), affected.end(),
+        [this](std::size_t a, std::size_t b) { return positions_[a] < positions_[b]; });
+
+    evaluate_levels(workbook, affected);
+}
+
+void formula_engine::evaluate_levels(const workbook_impl &workbook, const std::vector<std::size_t> &sequence)
+{
+    auto threads = workbook.calculation_threads_;
+
+    if(threads == 0)
+    {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    std::size_t begin = 0;
+
+    while(begin < sequence.size())
+    {
+        auto end = begin + 1;
+
+        while(end < sequence.size() && nodes_[sequence[end]].level == nodes_[sequence[begin]].level)
+        {
+            end++;
+        }
+
+        auto workers = std::min<std::size_t>(threads, (end - begin) / min_cells_per_thread);
+
+        if(workers <= 1)
+        {
+            for(auto i = begin; i < end; i++)
+            {
+                evaluate(workbook, nodes_[sequence[i]]);
+            }
+        }
+        else
+        {
+            // Each worker gets a fixed slice of the level and writes only its own cells, so
+            // the results are the same however the threads are scheduled.
+            auto run = [&](std::size_t first, std::size_t last, std::exception_ptr &error)
+            {
+                try
+                {
+                    for(auto i = first; i < last; i++)
+                    {
+                        evaluate(workbook, nodes_[sequence[i]]);
+                    }
+                }
+                catch(...)
+                {
+                    error = std::current_exception();
+                }
+            };
+
+            auto slice = [&](std::size_t worker) { return begin + (end - begin) * worker / workers; };
+
+            std::vector<std::exception_ptr> errors(workers);
+            std::vector<std::thread> pool;
+            pool.reserve(workers - 1);
+
+            for(std::size_t worker = 1; worker < workers; worker++)
+            {
+                pool.emplace_back(run, slice(worker), slice(worker + 1), std::ref(errors[worker]));
+            }
+
+            run(slice(0), slice(1), errors[0]);
+
+            for(auto &thread : pool)
+            {
+                thread.join();
+            }
+
+            for(auto &error : errors)
+            {
+                if(error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        begin = end;
+    }
+}
+
+void formula_engine::evaluate(const workbook_impl &workbook, node &formula)
+{
+    store_result(*formula.cell, formula.program.evaluate(workbook));
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <xlnt/common/types.hpp>
+
+#include "formula_program.hpp"
+
+namespace xlnt {
+namespace detail {
+
+struct cell_impl;
+struct workbook_impl;
+
+/// <summary>
+/// Evaluates the formulas in a workbook. Each formula is compiled once and linked to
+/// the formula cells it reads, then cells are evaluated in topological order so every
+/// cell is computed after the cells it depends on. The graph is kept by the workbook
+/// so that changing a few inputs only evaluates the formulas downstream of them.
+/// </summary>
+class formula_engine
+{
+public:
+    /// <summary>
+    /// Build the dependency graph of every formula in workbook and start queueing
+    /// value changes on its sheets.
+    /// </summary>
+    explicit formula_engine(workbook_impl &workbook);
+
+    /// <summary>
+    /// Evaluate every formula and store the results as the cells' values.
+    /// Cells on a circular reference, and every cell reading them, are given the #REF! error.
+    /// </summary>
+    void calculate(workbook_impl &workbook);
+
+    /// <summary>
+    /// Evaluate only the formulas that read, directly or through other formulas, a cell
+    /// whose value was set since the last calculation. The graph must still match the
+    /// workbook's formulas, which the sheets' dependencies_changed_ flags report.
+    /// </summary>
+    void recalculate(workbook_impl &workbook);
+
+private:
+    /// <summary>
+    /// The rows or columns a range formula reads along one column or row of its range.
+    /// Lists of these are sorted by first, and reach is the largest last of the interval and
+    /// every one before it, so a lookup can stop once no earlier interval gets to a position.
+    /// </summary>
+    struct reader_interval
+    {
+        std::uint32_t first;
+        std::uint32_t last;
+        std::uint32_t reach;
+        std::size_t node;
+    };
+
+    struct node
+    {
+        std::size_t sheet;
+        column_t column;
+        row_t row;
+        cell_impl *cell;
+        formula_program program;
+        std::vector<std::size_t> dependents;
+        std::size_t level;
+    };
+
+    void build(workbook_impl &workbook);
+    void order();
+    void evaluate(const workbook_impl &workbook, node &formula);
+
+    /// <summary>
+    /// Evaluate the nodes in sequence, which must be in the order of order_. Each run of
+    /// nodes at the same level is shared between the workbook's calculation threads.
+    /// </summary>
+    void evaluate_levels(const workbook_impl &workbook, const std::vector<std::size_t> &sequence);
+
+    std::vector<node> nodes_;
+
+    // Every node neither on nor downstream of a cycle, by level and then in row-major order.
+    std::vector<std::size_t> order_;
+
+    // Index of each node in order_, or no_position for a node left out of it.
+    std::vector<std::size_t> positions_;
+
+    // Nodes by the position of their own cell and by the single cells they read, keyed
+    // by sheet, column and row.
+    std::unordered_map<std::uint64_t, std::size_t> formula_cells_;
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> cell_readers_;
+
+    // Formulas reading a block of cells, split along its shorter side: a block at least as
+    // tall as it is wide is listed under each of its columns by row interval, keyed with row
+    // 0, and a wider one under each of its rows by column interval, keyed with column 0.
+    std::unordered_map<std::uint64_t, std::vector<reader_interval>> column_readers_;
+    std::unordered_map<std::uint64_t, std::vector<reader_interval>> row_readers_;
+};
+
+} // namespace detail
+} // namespace xlnt
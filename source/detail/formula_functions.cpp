@@ -0,0 +1,1257 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+#include "cell_impl.hpp"
+#include "cell_scan.hpp"
+#include "formula_functions.hpp"
+#include "range_aggregate.hpp"
+#include "workbook_impl.hpp"
+#include "worksheet_impl.hpp"
+
+namespace {
+
+using xlnt::detail::formula_reference;
+using xlnt::detail::formula_value;
+using xlnt::detail::workbook_impl;
+
+formula_value cell_value(const xlnt::detail::cell_impl &cell)
+{
+    switch(cell.type_)
+    {
+    case xlnt::cell::type::numeric:
+        return formula_value::number(cell.value_numeric_);
+    case xlnt::cell::type::string:
+        return formula_value::string(cell.value_string_);
+    case xlnt::cell::type::boolean:
+        return formula_value::boolean(cell.value_numeric_ != 0);
+    case xlnt::cell::type::error:
+        return formula_value::error(cell.value_string_);
+    default:
+        return formula_value();
+    }
+}
+
+// Call f(row, column, value) for every non-empty cell in reference in row-major order.
+template<typename F>
+void for_each_cell(const workbook_impl &workbook, const formula_reference &reference, F f)
+{
+    xlnt::detail::scan_cells(*workbook.worksheets_[reference.sheet], reference.first_column, reference.first_row,
+        reference.last_column, reference.last_row, [&](row_t row, column_t column, const xlnt::detail::cell_impl &cell)
+    {
+        auto value = cell_value(cell);
+
+        if(value.type_ != formula_value::type::empty)
+        {
+            f(row, column, value);
+        }
+    });
+}
+
+bool is_error(const formula_value &value)
+{
+    return value.type_ == formula_value::type::error;
+}
+
+std::string to_upper(std::string text)
+{
+    for(auto &c : text)
+    {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    return text;
+}
+
+std::string number_to_text(long double number)
+{
+    char buffer[64];
+
+    if(number == 0)
+    {
+        return "0";
+    }
+
+    if(number == std::floor(number) && std::fabs(number) < 1e15L)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.0Lf", number);
+    }
+    else
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.15Lg", number);
+    }
+
+    return buffer;
+}
+
+// Call f(number) for each number in arguments. Numbers in referenced cells are used as they
+// are and other cells are skipped, while arguments given directly are coerced to numbers.
+// Returns false with error set if any argument is an error.
+template<typename F>
+bool for_each_number(const formula_value *arguments, std::size_t count, const workbook_impl &workbook, formula_value &error, F f)
+{
+    for(std::size_t i = 0; i < count; i++)
+    {
+        auto &argument = arguments[i];
+
+        if(argument.type_ == formula_value::type::reference)
+        {
+            bool failed = false;
+
+            for_each_cell(workbook, argument.reference_, [&](row_t, column_t, const formula_value &value)
+            {
+                if(failed)
+                {
+                    return;
+                }
+
+                if(value.type_ == formula_value::type::number)
+                {
+                    f(value.number_);
+                }
+                else if(is_error(value))
+                {
+                    error = value;
+                    failed = true;
+                }
+            });
+
+            if(failed)
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        long double number = 0;
+
+        if(!xlnt::detail::to_number(argument, number, error))
+        {
+            return false;
+        }
+
+        f(number);
+    }
+
+    return true;
+}
+
+// Add the numbers in arguments to totals, like for_each_number but passing referenced blocks
+// to aggregate_range so their cells are read without building a value for each one.
+bool aggregate_numbers(const formula_value *arguments, std::size_t count, const workbook_impl &workbook,
+    xlnt::detail::range_aggregate &totals, formula_value &error)
+{
+    for(std::size_t i = 0; i < count; i++)
+    {
+        auto &argument = arguments[i];
+
+        if(argument.type_ == formula_value::type::reference)
+        {
+            auto &reference = argument.reference_;
+            xlnt::detail::aggregate_range(*workbook.worksheets_[reference.sheet], reference.first_column,
+                reference.first_row, reference.last_column, reference.last_row, totals);
+
+            if(totals.error != nullptr)
+            {
+                error = cell_value(*totals.error);
+                return false;
+            }
+
+            continue;
+        }
+
+        long double number = 0;
+
+        if(!xlnt::detail::to_number(argument, number, error))
+        {
+            return false;
+        }
+
+        totals.add(number);
+    }
+
+    return true;
+}
+
+formula_value sum(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    xlnt::detail::range_aggregate totals;
+    formula_value error;
+
+    if(!aggregate_numbers(arguments, count, workbook, totals, error))
+    {
+        return error;
+    }
+
+    return formula_value::number(totals.sum);
+}
+
+formula_value product(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    long double total = 1;
+    bool any = false;
+    formula_value error;
+
+    if(!for_each_number(arguments, count, workbook, error, [&](long double n) { total *= n; any = true; }))
+    {
+        return error;
+    }
+
+    return formula_value::number(any ? total : 0);
+}
+
+formula_value average(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    xlnt::detail::range_aggregate totals;
+    formula_value error;
+
+    if(!aggregate_numbers(arguments, count, workbook, totals, error))
+    {
+        return error;
+    }
+
+    if(totals.numbers == 0)
+    {
+        return formula_value::error("#DIV/0!");
+    }
+
+    return formula_value::number(totals.sum / totals.numbers);
+}
+
+formula_value min_(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    xlnt::detail::range_aggregate totals;
+    formula_value error;
+
+    if(!aggregate_numbers(arguments, count, workbook, totals, error))
+    {
+        return error;
+    }
+
+    return formula_value::number(totals.min);
+}
+
+formula_value max_(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    xlnt::detail::range_aggregate totals;
+    formula_value error;
+
+    if(!aggregate_numbers(arguments, count, workbook, totals, error))
+    {
+        return error;
+    }
+
+    return formula_value::number(totals.max);
+}
+
+formula_value count_values(const formula_value *arguments, std::size_t count, const workbook_impl &workbook, bool numbers_only)
+{
+    std::size_t total = 0;
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        auto &argument = arguments[i];
+
+        if(argument.type_ == formula_value::type::reference)
+        {
+            auto &reference = argument.reference_;
+            xlnt::detail::range_aggregate totals;
+            xlnt::detail::aggregate_range(*workbook.worksheets_[reference.sheet], reference.first_column,
+                reference.first_row, reference.last_column, reference.last_row, totals);
+            total += numbers_only ? totals.numbers : totals.values;
+        }
+        else if(numbers_only)
+        {
+            long double number = 0;
+            formula_value error;
+            total += xlnt::detail::to_number(argument, number, error) && argument.type_ != formula_value::type::empty ? 1 : 0;
+        }
+        else
+        {
+            total += argument.type_ != formula_value::type::empty ? 1 : 0;
+        }
+    }
+
+    return formula_value::number(static_cast<long double>(total));
+}
+
+formula_value count_(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return count_values(arguments, count, workbook, true);
+}
+
+formula_value counta(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return count_values(arguments, count, workbook, false);
+}
+
+formula_value if_(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    bool condition = false;
+    formula_value error;
+
+    if(!xlnt::detail::to_boolean(xlnt::detail::dereference(arguments[0], workbook), condition, error))
+    {
+        return error;
+    }
+
+    if(condition)
+    {
+        return arguments[1];
+    }
+
+    return count > 2 ? arguments[2] : formula_value::boolean(false);
+}
+
+formula_value iferror(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    auto value = xlnt::detail::dereference(arguments[0], workbook);
+    return is_error(value) ? arguments[1] : value;
+}
+
+formula_value logical(const formula_value *arguments, std::size_t count, const workbook_impl &workbook, bool all)
+{
+    bool any_value = false;
+    bool result = all;
+    formula_value error;
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        auto &argument = arguments[i];
+
+        if(argument.type_ == formula_value::type::reference)
+        {
+            bool failed = false;
+
+            for_each_cell(workbook, argument.reference_, [&](row_t, column_t, const formula_value &value)
+            {
+                if(is_error(value))
+                {
+                    error = value;
+                    failed = true;
+                }
+                else if(value.type_ == formula_value::type::number || value.type_ == formula_value::type::boolean)
+                {
+                    auto truth = value.number_ != 0;
+                    result = all ? result && truth : result || truth;
+                    any_value = true;
+                }
+            });
+
+            if(failed)
+            {
+                return error;
+            }
+
+            continue;
+        }
+
+        bool truth = false;
+
+        if(!xlnt::detail::to_boolean(argument, truth, error))
+        {
+            return error;
+        }
+
+        result = all ? result && truth : result || truth;
+        any_value = true;
+    }
+
+    return any_value ? formula_value::boolean(result) : formula_value::error("#VALUE!");
+}
+
+formula_value and_(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return logical(arguments, count, workbook, true);
+}
+
+formula_value or_(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return logical(arguments, count, workbook, false);
+}
+
+formula_value not_(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    bool value = false;
+    formula_value error;
+
+    if(!xlnt::detail::to_boolean(xlnt::detail::dereference(arguments[0], workbook), value, error))
+    {
+        return error;
+    }
+
+    return formula_value::boolean(!value);
+}
+
+// Evaluate the first count arguments as numbers, returning false with error set on failure.
+bool get_numbers(const formula_value *arguments, std::size_t count, const workbook_impl &workbook, long double *numbers, formula_value &error)
+{
+    for(std::size_t i = 0; i < count; i++)
+    {
+        if(!xlnt::detail::to_number(xlnt::detail::dereference(arguments[i], workbook), numbers[i], error))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+formula_value checked_number(long double number)
+{
+    if(std::isnan(number) || std::isinf(number))
+    {
+        return formula_value::error("#NUM!");
+    }
+
+    return formula_value::number(number);
+}
+
+template<long double (*Operation)(long double)>
+formula_value unary_math(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    long double number = 0;
+    formula_value error;
+
+    if(!get_numbers(arguments, 1, workbook, &number, error))
+    {
+        return error;
+    }
+
+    return checked_number(Operation(number));
+}
+
+long double absolute(long double number)
+{
+    return std::fabs(number);
+}
+
+long double integer(long double number)
+{
+    return std::floor(number);
+}
+
+long double square_root(long double number)
+{
+    return number < 0 ? std::nanl("") : std::sqrt(number);
+}
+
+formula_value mod(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    long double numbers[2];
+    formula_value error;
+
+    if(!get_numbers(arguments, 2, workbook, numbers, error))
+    {
+        return error;
+    }
+
+    if(numbers[1] == 0)
+    {
+        return formula_value::error("#DIV/0!");
+    }
+
+    return formula_value::number(numbers[0] - numbers[1] * std::floor(numbers[0] / numbers[1]));
+}
+
+formula_value power(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    long double numbers[2];
+    formula_value error;
+
+    if(!get_numbers(arguments, 2, workbook, numbers, error))
+    {
+        return error;
+    }
+
+    return checked_number(std::pow(numbers[0], numbers[1]));
+}
+
+enum class rounding
+{
+    nearest,
+    up,
+    down
+};
+
+template<rounding Mode>
+formula_value round_(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    long double numbers[2];
+    formula_value error;
+
+    if(!get_numbers(arguments, 2, workbook, numbers, error))
+    {
+        return error;
+    }
+
+    auto factor = std::pow(10.0L, std::trunc(numbers[1]));
+    auto magnitude = std::fabs(numbers[0]) * factor;
+
+    // Excel rounds halves away from zero and ROUNDUP/ROUNDDOWN work on the magnitude.
+    switch(Mode)
+    {
+    case rounding::nearest:
+        magnitude = std::floor(magnitude + 0.5L);
+        break;
+    case rounding::up:
+        magnitude = std::ceil(magnitude);
+        break;
+    case rounding::down:
+        magnitude = std::floor(magnitude);
+        break;
+    }
+
+    return checked_number(std::copysign(magnitude / factor, numbers[0]));
+}
+
+formula_value concatenate(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    std::string result;
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        auto value = xlnt::detail::dereference(arguments[i], workbook);
+
+        if(is_error(value))
+        {
+            return value;
+        }
+
+        result.append(xlnt::detail::to_text(value));
+    }
+
+    return formula_value::string(result);
+}
+
+// Evaluate an argument as text, returning false with error set if it's an error.
+bool get_text(const formula_value &argument, const workbook_impl &workbook, std::string &text, formula_value &error)
+{
+    auto value = xlnt::detail::dereference(argument, workbook);
+
+    if(is_error(value))
+    {
+        error = value;
+        return false;
+    }
+
+    text = xlnt::detail::to_text(value);
+    return true;
+}
+
+formula_value len(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    std::string text;
+    formula_value error;
+
+    if(!get_text(arguments[0], workbook, text, error))
+    {
+        return error;
+    }
+
+    return formula_value::number(static_cast<long double>(text.size()));
+}
+
+int lower(int c)
+{
+    return std::tolower(c);
+}
+
+int upper(int c)
+{
+    return std::toupper(c);
+}
+
+template<int (*Convert)(int)>
+formula_value change_case(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    std::string text;
+    formula_value error;
+
+    if(!get_text(arguments[0], workbook, text, error))
+    {
+        return error;
+    }
+
+    for(auto &c : text)
+    {
+        c = static_cast<char>(Convert(static_cast<unsigned char>(c)));
+    }
+
+    return formula_value::string(text);
+}
+
+// Shared by LEFT, RIGHT and MID: take length characters from start (zero-based) of the first argument.
+formula_value substring(const formula_value *arguments, const workbook_impl &workbook, long double start, long double length, bool from_right)
+{
+    std::string text;
+    formula_value error;
+
+    if(!get_text(arguments[0], workbook, text, error))
+    {
+        return error;
+    }
+
+    if(start < 0 || length < 0)
+    {
+        return formula_value::error("#VALUE!");
+    }
+
+    auto count = static_cast<std::size_t>(std::min(length, static_cast<long double>(text.size())));
+
+    if(from_right)
+    {
+        return formula_value::string(text.substr(text.size() - count));
+    }
+
+    auto first = static_cast<std::size_t>(start);
+    return formula_value::string(first >= text.size() ? std::string() : text.substr(first, count));
+}
+
+formula_value left(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    long double length = 1;
+    formula_value error;
+
+    if(count > 1 && !get_numbers(arguments + 1, 1, workbook, &length, error))
+    {
+        return error;
+    }
+
+    return substring(arguments, workbook, 0, length, false);
+}
+
+formula_value right(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    long double length = 1;
+    formula_value error;
+
+    if(count > 1 && !get_numbers(arguments + 1, 1, workbook, &length, error))
+    {
+        return error;
+    }
+
+    return substring(arguments, workbook, 0, length, true);
+}
+
+formula_value mid(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    long double numbers[2];
+    formula_value error;
+
+    if(!get_numbers(arguments + 1, 2, workbook, numbers, error))
+    {
+        return error;
+    }
+
+    return substring(arguments, workbook, numbers[0] - 1, numbers[1], false);
+}
+
+formula_value isblank(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    return formula_value::boolean(xlnt::detail::dereference(arguments[0], workbook).type_ == formula_value::type::empty);
+}
+
+template<formula_value::type Type>
+formula_value is_type(const formula_value *arguments, std::size_t, const workbook_impl &workbook)
+{
+    return formula_value::boolean(xlnt::detail::dereference(arguments[0], workbook).type_ == Type);
+}
+
+// Return the zero-based position of lookup among the cells along one row or column of a sheet,
+// or -1 if there is none. match_type is 0 for an exact match, 1 for the last value not greater
+// than lookup and -1 for the last value not less than it, assuming the cells are sorted.
+long long find_position(const formula_value &lookup, const workbook_impl &workbook, std::size_t sheet,
+    bool along_row, std::uint32_t fixed, std::uint32_t first, std::uint32_t last, int match_type)
+{
+    long long found = -1;
+    auto lookup_text = lookup.type_ == formula_value::type::string;
+
+    for(auto position = first; position <= last; position++)
+    {
+        auto value = along_row ? xlnt::detail::read_cell(workbook, sheet, position, fixed) : xlnt::detail::read_cell(workbook, sheet, fixed, position);
+
+        if(value.type_ == formula_value::type::empty || (value.type_ == formula_value::type::string) != lookup_text)
+        {
+            continue;
+        }
+
+        auto order = xlnt::detail::compare(value, lookup);
+
+        if(match_type == 0)
+        {
+            if(order == 0)
+            {
+                return position - first;
+            }
+        }
+        else if(order * match_type <= 0)
+        {
+            found = position - first;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return found;
+}
+
+formula_value lookup(const formula_value *arguments, std::size_t count, const workbook_impl &workbook, bool vertical)
+{
+    auto value = xlnt::detail::dereference(arguments[0], workbook);
+
+    if(is_error(value))
+    {
+        return value;
+    }
+
+    if(arguments[1].type_ != formula_value::type::reference)
+    {
+        return formula_value::error("#VALUE!");
+    }
+
+    long double index = 0;
+    formula_value error;
+
+    if(!get_numbers(arguments + 2, 1, workbook, &index, error))
+    {
+        return error;
+    }
+
+    bool approximate = true;
+
+    if(count > 3 && !xlnt::detail::to_boolean(xlnt::detail::dereference(arguments[3], workbook), approximate, error))
+    {
+        return error;
+    }
+
+    auto &table = arguments[1].reference_;
+    auto width = vertical ? table.last_column - table.first_column + 1 : table.last_row - table.first_row + 1;
+
+    if(index < 1)
+    {
+        return formula_value::error("#VALUE!");
+    }
+
+    if(index > width)
+    {
+        return formula_value::error("#REF!");
+    }
+
+    auto offset = static_cast<std::uint32_t>(index) - 1;
+    auto position = vertical
+        ? find_position(value, workbook, table.sheet, false, table.first_column, table.first_row, table.last_row, approximate ? 1 : 0)
+        : find_position(value, workbook, table.sheet, true, table.first_row, table.first_column, table.last_column, approximate ? 1 : 0);
+
+    if(position < 0)
+    {
+        return formula_value::error("#N/A");
+    }
+
+    auto along = static_cast<std::uint32_t>(position);
+
+    return vertical
+        ? xlnt::detail::read_cell(workbook, table.sheet, table.first_column + offset, table.first_row + along)
+        : xlnt::detail::read_cell(workbook, table.sheet, table.first_column + along, table.first_row + offset);
+}
+
+formula_value vlookup(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return lookup(arguments, count, workbook, true);
+}
+
+formula_value hlookup(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return lookup(arguments, count, workbook, false);
+}
+
+formula_value match(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    auto value = xlnt::detail::dereference(arguments[0], workbook);
+
+    if(is_error(value))
+    {
+        return value;
+    }
+
+    long double match_type = 1;
+    formula_value error;
+
+    if(count > 2 && !get_numbers(arguments + 2, 1, workbook, &match_type, error))
+    {
+        return error;
+    }
+
+    auto &table = arguments[1].reference_;
+
+    if(arguments[1].type_ != formula_value::type::reference
+        || (table.first_row != table.last_row && table.first_column != table.last_column))
+    {
+        return formula_value::error("#N/A");
+    }
+
+    auto type = match_type > 0 ? 1 : (match_type < 0 ? -1 : 0);
+    auto position = table.first_row == table.last_row
+        ? find_position(value, workbook, table.sheet, true, table.first_row, table.first_column, table.last_column, type)
+        : find_position(value, workbook, table.sheet, false, table.first_column, table.first_row, table.last_row, type);
+
+    if(position < 0)
+    {
+        return formula_value::error("#N/A");
+    }
+
+    return formula_value::number(static_cast<long double>(position + 1));
+}
+
+formula_value index_(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    long double numbers[2] = { 1, 1 };
+    formula_value error;
+
+    if(!get_numbers(arguments + 1, count - 1, workbook, numbers, error))
+    {
+        return error;
+    }
+
+    if(arguments[0].type_ != formula_value::type::reference)
+    {
+        return numbers[0] == 1 && numbers[1] == 1 ? arguments[0] : formula_value::error("#REF!");
+    }
+
+    auto table = arguments[0].reference_;
+
+    // A single index into a one-row reference selects a column.
+    if(count == 2 && table.first_row == table.last_row)
+    {
+        std::swap(numbers[0], numbers[1]);
+    }
+
+    if(numbers[0] < 1 || numbers[1] < 1
+        || numbers[0] > table.last_row - table.first_row + 1
+        || numbers[1] > table.last_column - table.first_column + 1)
+    {
+        return formula_value::error("#REF!");
+    }
+
+    table.first_row += static_cast<row_t>(numbers[0]) - 1;
+    table.first_column += static_cast<column_t>(numbers[1]) - 1;
+    table.last_row = table.first_row;
+    table.last_column = table.first_column;
+
+    return formula_value::reference(table);
+}
+
+bool wildcard_match(const char *pattern, const char *text)
+{
+    while(*pattern != '\0')
+    {
+        if(*pattern == '*')
+        {
+            pattern++;
+
+            for(auto rest = text; ; rest++)
+            {
+                if(wildcard_match(pattern, rest))
+                {
+                    return true;
+                }
+
+                if(*rest == '\0')
+                {
+                    return false;
+                }
+            }
+        }
+
+        if(*text == '\0' || (*pattern != '?' && *pattern != *text))
+        {
+            return false;
+        }
+
+        pattern++;
+        text++;
+    }
+
+    return *text == '\0';
+}
+
+// A SUMIF/COUNTIF criterion like 5, ">=10", "<>x" or "ab*".
+struct criterion
+{
+    int comparison; // 0 =, 1 <>, 2 <, 3 <=, 4 >, 5 >=
+    formula_value operand;
+    std::string pattern;
+
+    explicit criterion(const formula_value &value) : comparison(0), operand(value)
+    {
+        if(value.type_ != formula_value::type::string)
+        {
+            return;
+        }
+
+        auto &text = value.text_;
+        std::size_t skip = 0;
+        const char *prefixes[] = { "=", "<>", "<", "<=", ">", ">=" };
+
+        for(int i = 0; i < 6; i++)
+        {
+            auto length = std::char_traits<char>::length(prefixes[i]);
+
+            if(text.compare(0, length, prefixes[i]) == 0 && length >= skip)
+            {
+                comparison = i;
+                skip = length;
+            }
+        }
+
+        auto rest = text.substr(skip);
+        char *end = nullptr;
+        auto number = std::strtold(rest.c_str(), &end);
+
+        if(!rest.empty() && end == rest.c_str() + rest.size())
+        {
+            operand = formula_value::number(number);
+        }
+        else if(to_upper(rest) == "TRUE" || to_upper(rest) == "FALSE")
+        {
+            operand = formula_value::boolean(to_upper(rest) == "TRUE");
+        }
+        else
+        {
+            operand = formula_value::string(rest);
+            pattern = to_upper(rest);
+        }
+    }
+
+    bool matches(const formula_value &value) const
+    {
+        if(value.type_ != operand.type_)
+        {
+            return comparison == 1;
+        }
+
+        int order = 0;
+
+        if(operand.type_ == formula_value::type::string && comparison < 2)
+        {
+            order = wildcard_match(pattern.c_str(), to_upper(value.text_).c_str()) ? 0 : 1;
+        }
+        else
+        {
+            order = xlnt::detail::compare(value, operand);
+        }
+
+        switch(comparison)
+        {
+        case 0: return order == 0;
+        case 1: return order != 0;
+        case 2: return order < 0;
+        case 3: return order <= 0;
+        case 4: return order > 0;
+        default: return order >= 0;
+        }
+    }
+};
+
+formula_value conditional(const formula_value *arguments, std::size_t count, const workbook_impl &workbook, bool add)
+{
+    if(arguments[0].type_ != formula_value::type::reference
+        || (count > 2 && arguments[2].type_ != formula_value::type::reference))
+    {
+        return formula_value::error("#VALUE!");
+    }
+
+    auto condition = xlnt::detail::dereference(arguments[1], workbook);
+
+    if(is_error(condition))
+    {
+        return condition;
+    }
+
+    criterion test(condition);
+    auto &range = arguments[0].reference_;
+    long double total = 0;
+
+    for_each_cell(workbook, range, [&](row_t row, column_t column, const formula_value &value)
+    {
+        if(!test.matches(value))
+        {
+            return;
+        }
+
+        if(!add)
+        {
+            total += 1;
+            return;
+        }
+
+        auto summand = value;
+
+        if(count > 2)
+        {
+            auto &sum_range = arguments[2].reference_;
+            summand = xlnt::detail::read_cell(workbook, sum_range.sheet,
+                sum_range.first_column + (column - range.first_column), sum_range.first_row + (row - range.first_row));
+        }
+
+        if(summand.type_ == formula_value::type::number)
+        {
+            total += summand.number_;
+        }
+    });
+
+    return formula_value::number(total);
+}
+
+formula_value sumif(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return conditional(arguments, count, workbook, true);
+}
+
+formula_value countif(const formula_value *arguments, std::size_t count, const workbook_impl &workbook)
+{
+    return conditional(arguments, count, workbook, false);
+}
+
+const std::size_t unlimited = 255;
+
+// Sorted by name for lookup.
+const xlnt::detail::formula_function_definition functions[] =
+{
+    { "ABS", 1, 1, unary_math<absolute> },
+    { "AND", 1, unlimited, and_ },
+    { "AVERAGE", 1, unlimited, average },
+    { "CONCATENATE", 1, unlimited, concatenate },
+    { "COUNT", 1, unlimited, count_ },
+    { "COUNTA", 1, unlimited, counta },
+    { "COUNTIF", 2, 2, countif },
+    { "HLOOKUP", 3, 4, hlookup },
+    { "IF", 2, 3, if_ },
+    { "IFERROR", 2, 2, iferror },
+    { "INDEX", 2, 3, index_ },
+    { "INT", 1, 1, unary_math<integer> },
+    { "ISBLANK", 1, 1, isblank },
+    { "ISERROR", 1, 1, is_type<formula_value::type::error> },
+    { "ISNUMBER", 1, 1, is_type<formula_value::type::number> },
+    { "ISTEXT", 1, 1, is_type<formula_value::type::string> },
+    { "LEFT", 1, 2, left },
+    { "LEN", 1, 1, len },
+    { "LOWER", 1, 1, change_case<lower> },
+    { "MATCH", 2, 3, match },
+    { "MAX", 1, unlimited, max_ },
+    { "MID", 3, 3, mid },
+    { "MIN", 1, unlimited, min_ },
+    { "MOD", 2, 2, mod },
+    { "NOT", 1, 1, not_ },
+    { "OR", 1, unlimited, or_ },
+    { "POWER", 2, 2, power },
+    { "PRODUCT", 1, unlimited, product },
+    { "RIGHT", 1, 2, right },
+    { "ROUND", 2, 2, round_<rounding::nearest> },
+    { "ROUNDDOWN", 2, 2, round_<rounding::down> },
+    { "ROUNDUP", 2, 2, round_<rounding::up> },
+    { "SQRT", 1, 1, unary_math<square_root> },
+    { "SUM", 1, unlimited, sum },
+    { "SUMIF", 2, 3, sumif },
+    { "UPPER", 1, 1, change_case<upper> },
+    { "VLOOKUP", 3, 4, vlookup }
+};
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+bool find_formula_function(const std::string &name, std::uint32_t &index)
+{
+    auto first = std::begin(functions);
+    auto last = std::end(functions);
+    auto match = std::lower_bound(first, last, name,
+        [](const formula_function_definition &definition, const std::string &n) { return n.compare(definition.name) > 0; });
+
+    if(match == last || name != match->name)
+    {
+        return false;
+    }
+
+    index = static_cast<std::uint32_t>(match - first);
+    return true;
+}
+
+const formula_function_definition &get_formula_function(std::uint32_t index)
+{
+    return functions[index];
+}
+
+formula_value read_cell(const workbook_impl &workbook, std::size_t sheet, column_t column, row_t row)
+{
+    auto &cells = workbook.worksheets_[sheet]->cell_map_;
+    auto row_match = cells.find(row);
+
+    if(row_match == cells.end())
+    {
+        return formula_value();
+    }
+
+    auto match = row_match->second.find(column);
+
+    if(match == row_match->second.end())
+    {
+        return formula_value();
+    }
+
+    return cell_value(match->second);
+}
+
+formula_value dereference(const formula_value &value, const workbook_impl &workbook)
+{
+    if(value.type_ != formula_value::type::reference)
+    {
+        return value;
+    }
+
+    auto &reference = value.reference_;
+
+    if(reference.first_column != reference.last_column || reference.first_row != reference.last_row)
+    {
+        return formula_value::error("#VALUE!");
+    }
+
+    return read_cell(workbook, reference.sheet, reference.first_column, reference.first_row);
+}
+
+bool to_number(const formula_value &value, long double &number, formula_value &error)
+{
+    switch(value.type_)
+    {
+    case formula_value::type::number:
+        number = value.number_;
+        return true;
+    case formula_value::type::boolean:
+        number = value.number_ != 0 ? 1 : 0;
+        return true;
+    case formula_value::type::empty:
+        number = 0;
+        return true;
+    case formula_value::type::string:
+    {
+        char *end = nullptr;
+        number = std::strtold(value.text_.c_str(), &end);
+
+        if(!value.text_.empty() && end == value.text_.c_str() + value.text_.size())
+        {
+            return true;
+        }
+
+        error = formula_value::error("#VALUE!");
+        return false;
+    }
+    case formula_value::type::error:
+        error = value;
+        return false;
+    default:
+        error = formula_value::error("#VALUE!");
+        return false;
+    }
+}
+
+bool to_boolean(const formula_value &value, bool &result, formula_value &error)
+{
+    if(value.type_ == formula_value::type::string)
+    {
+        auto upper = to_upper(value.text_);
+
+        if(upper == "TRUE" || upper == "FALSE")
+        {
+            result = upper == "TRUE";
+            return true;
+        }
+
+        error = formula_value::error("#VALUE!");
+        return false;
+    }
+
+    long double number = 0;
+
+    if(!to_number(value, number, error))
+    {
+        return false;
+    }
+
+    result = number != 0;
+    return true;
+}
+
+std::string to_text(const formula_value &value)
+{
+    switch(value.type_)
+    {
+    case formula_value::type::number:
+        return number_to_text(value.number_);
+    case formula_value::type::boolean:
+        return value.number_ != 0 ? "TRUE" : "FALSE";
+    case formula_value::type::string:
+    case formula_value::type::error:
+        return value.text_;
+    default:
+        return "";
+    }
+}
+
+int compare(const formula_value &left, const formula_value &right)
+{
+    // An empty value takes on the type of the other side: 0, "" or FALSE.
+    if(left.type_ == formula_value::type::empty || right.type_ == formula_value::type::empty)
+    {
+        if(left.type_ == right.type_)
+        {
+            return 0;
+        }
+
+        auto &other = left.type_ == formula_value::type::empty ? right : left;
+        formula_value blank;
+        blank.type_ = other.type_ == formula_value::type::string ? formula_value::type::string : other.type_;
+        blank.number_ = 0;
+
+        return left.type_ == formula_value::type::empty ? compare(blank, right) : compare(left, blank);
+    }
+
+    auto rank = [](formula_value::type type)
+    {
+        return type == formula_value::type::number ? 0 : (type == formula_value::type::string ? 1 : 2);
+    };
+
+    if(rank(left.type_) != rank(right.type_))
+    {
+        return rank(left.type_) < rank(right.type_) ? -1 : 1;
+    }
+
+    if(left.type_ == formula_value::type::string)
+    {
+        auto order = to_upper(left.text_).compare(to_upper(right.text_));
+        return order < 0 ? -1 : (order > 0 ? 1 : 0);
+    }
+
+    return left.number_ < right.number_ ? -1 : (left.number_ > right.number_ ? 1 : 0);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "formula_program.hpp"
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Built-in worksheet functions take their evaluated arguments, which may still be
+/// references, and return a value. Arity has been checked by the compiler.
+/// </summary>
+using formula_function = formula_value (*)(const formula_value *arguments, std::size_t count, const workbook_impl &workbook);
+
+struct formula_function_definition
+{
+    const char *name;
+    std::size_t min_arguments;
+    std::size_t max_arguments;
+    formula_function function;
+};
+
+/// <summary>
+/// Set index to the position of the function called name (in upper case) and return true if there is one.
+/// </summary>
+bool find_formula_function(const std::string &name, std::uint32_t &index);
+const formula_function_definition &get_formula_function(std::uint32_t index);
+
+/// <summary>
+/// Return the value of a cell, or an empty value if the cell doesn't exist.
+/// </summary>
+formula_value read_cell(const workbook_impl &workbook, std::size_t sheet, column_t column, row_t row);
+
+/// <summary>
+/// Replace a single-cell reference with the cell's value. Larger references become #VALUE!.
+/// </summary>
+formula_value dereference(const formula_value &value, const workbook_impl &workbook);
+
+/// <summary>
+/// Coerce a dereferenced value the way Excel's operators do. Return false and set
+/// error if it can't be converted.
+/// </summary>
+bool to_number(const formula_value &value, long double &number, formula_value &error);
+bool to_boolean(const formula_value &value, bool &result, formula_value &error);
+std::string to_text(const formula_value &value);
+
+/// <summary>
+/// Order two dereferenced values like Excel's comparison operators: numbers sort before
+/// text, which sorts before booleans, and text is compared without regard to case.
+/// </summary>
+int compare(const formula_value &left, const formula_value &right);
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,760 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/formula/tokenizer.hpp>
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+#include "formula_functions.hpp"
+#include "formula_program.hpp"
+#include "workbook_impl.hpp"
+#include "worksheet_impl.hpp"
+
+namespace {
+
+using xlnt::detail::formula_reference;
+using xlnt::detail::formula_value;
+using xlnt::detail::workbook_impl;
+
+const column_t max_column = 16384;
+const row_t max_row = 1048576;
+
+// Function index used for calls to functions that aren't implemented. They evaluate to #NAME?.
+const std::uint32_t unknown_function = 0xFFFFFFFF;
+
+bool equals_ignore_case(const std::string &left, const std::string &right)
+{
+    if(left.size() != right.size())
+    {
+        return false;
+    }
+
+    for(std::size_t i = 0; i < left.size(); i++)
+    {
+        if(std::toupper(static_cast<unsigned char>(left[i])) != std::toupper(static_cast<unsigned char>(right[i])))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Sheet titles are matched ignoring case, as spreadsheet applications do.
+bool find_sheet(const workbook_impl &workbook, const std::string &title, std::size_t &sheet)
+{
+    auto match = workbook.find_sheet(title, false);
+
+    if(match == nullptr)
+    {
+        return false;
+    }
+
+    for(std::size_t i = 0; i < workbook.worksheets_.size(); i++)
+    {
+        if(workbook.worksheets_[i].get() == match)
+        {
+            sheet = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+enum class part_kind
+{
+    none,
+    cell,
+    column,
+    row
+};
+
+// Parse one side of a reference, like "Sheet1!$A$1", "B" or "12", into a sheet, column and row.
+part_kind parse_part(const std::string &text, const workbook_impl &workbook, std::size_t &sheet, column_t &column, row_t &row)
+{
+    std::size_t i = 0;
+    auto bang = text.rfind('!');
+
+    if(bang != std::string::npos)
+    {
+        auto title = text.substr(0, bang);
+
+        if(title.size() > 1 && title.front() == '\'' && title.back() == '\'')
+        {
+            title = title.substr(1, title.size() - 2);
+
+            for(auto quote = title.find("''"); quote != std::string::npos; quote = title.find("''", quote + 1))
+            {
+                title.erase(quote, 1);
+            }
+        }
+
+        if(!find_sheet(workbook, title, sheet))
+        {
+            return part_kind::none;
+        }
+
+        i = bang + 1;
+    }
+
+    i += i < text.size() && text[i] == '$' ? 1 : 0;
+    std::size_t letters = 0;
+    column = 0;
+
+    while(i < text.size() && std::isalpha(static_cast<unsigned char>(text[i])) && letters < 4)
+    {
+        column = column * 26 + static_cast<column_t>(std::toupper(static_cast<unsigned char>(text[i])) - 'A' + 1);
+        letters++;
+        i++;
+    }
+
+    i += letters > 0 && i < text.size() && text[i] == '$' ? 1 : 0;
+    std::size_t digits = 0;
+    row = 0;
+
+    while(i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])) && digits < 8)
+    {
+        row = row * 10 + static_cast<row_t>(text[i] - '0');
+        digits++;
+        i++;
+    }
+
+    if(i != text.size() || letters > 3 || column > max_column || row > max_row || (digits > 0 && row == 0))
+    {
+        return part_kind::none;
+    }
+
+    if(letters > 0)
+    {
+        return digits > 0 ? part_kind::cell : part_kind::column;
+    }
+
+    return digits > 0 ? part_kind::row : part_kind::none;
+}
+
+// Split a reference token on a ":" that isn't inside a quoted sheet name.
+std::size_t find_colon(const std::string &text)
+{
+    bool quoted = false;
+
+    for(std::size_t i = 0; i < text.size(); i++)
+    {
+        if(text[i] == '\'')
+        {
+            quoted = !quoted;
+        }
+        else if(text[i] == ':' && !quoted)
+        {
+            return i;
+        }
+    }
+
+    return std::string::npos;
+}
+
+bool parse_reference(const std::string &text, const workbook_impl &workbook, std::size_t sheet, formula_reference &result)
+{
+    auto colon = find_colon(text);
+    result.sheet = sheet;
+
+    auto first_kind = parse_part(text.substr(0, colon), workbook, result.sheet, result.first_column, result.first_row);
+
+    if(colon == std::string::npos)
+    {
+        result.last_column = result.first_column;
+        result.last_row = result.first_row;
+
+        return first_kind == part_kind::cell;
+    }
+
+    auto last_sheet = result.sheet;
+    auto last_kind = parse_part(text.substr(colon + 1), workbook, last_sheet, result.last_column, result.last_row);
+
+    if(first_kind == part_kind::none || first_kind != last_kind || last_sheet != result.sheet)
+    {
+        return false;
+    }
+
+    if(first_kind == part_kind::column)
+    {
+        result.first_row = 1;
+        result.last_row = max_row;
+    }
+    else if(first_kind == part_kind::row)
+    {
+        result.first_column = 1;
+        result.last_column = max_column;
+    }
+
+    if(result.first_column > result.last_column)
+    {
+        std::swap(result.first_column, result.last_column);
+    }
+
+    if(result.first_row > result.last_row)
+    {
+        std::swap(result.first_row, result.last_row);
+    }
+
+    return true;
+}
+
+bool find_named_range(const std::string &name, const workbook_impl &workbook, std::size_t sheet, formula_reference &result)
+{
+    // A name local to another sheet can't be used here, only the sheet's own or a workbook one.
+    auto &names = workbook.defined_names_;
+    auto match = names.find(name, workbook.worksheets_[sheet].get());
+    match = match == nullptr ? names.find(name, nullptr) : match;
+
+    if(match == nullptr)
+    {
+        return false;
+    }
+
+    auto target = std::find_if(workbook.worksheets_.begin(), workbook.worksheets_.end(),
+        [match](const std::unique_ptr<xlnt::detail::worksheet_impl> &ws) { return ws.get() == match->sheet; });
+
+    if(target == workbook.worksheets_.end())
+    {
+        return false;
+    }
+
+    result.sheet = static_cast<std::size_t>(target - workbook.worksheets_.begin());
+    result.first_column = match->reference.get_top_left().get_column_index();
+    result.first_row = match->reference.get_top_left().get_row();
+    result.last_column = match->reference.get_bottom_right().get_column_index();
+    result.last_row = match->reference.get_bottom_right().get_row();
+
+    return true;
+}
+
+std::string unquote(const std::string &text)
+{
+    std::string result;
+    result.reserve(text.size());
+
+    for(std::size_t i = 1; i + 1 < text.size(); i++)
+    {
+        result.push_back(text[i]);
+        i += text[i] == '"' ? 1 : 0;
+    }
+
+    return result;
+}
+
+formula_value number_or_error(long double number)
+{
+    if(std::isnan(number) || std::isinf(number))
+    {
+        return formula_value::error("#NUM!");
+    }
+
+    return formula_value::number(number);
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+formula_value formula_value::number(long double number)
+{
+    formula_value result;
+    result.type_ = type::number;
+    result.number_ = number;
+
+    return result;
+}
+
+formula_value formula_value::string(const std::string &text)
+{
+    formula_value result;
+    result.type_ = type::string;
+    result.text_ = text;
+
+    return result;
+}
+
+formula_value formula_value::boolean(bool value)
+{
+    formula_value result;
+    result.type_ = type::boolean;
+    result.number_ = value ? 1 : 0;
+
+    return result;
+}
+
+formula_value formula_value::error(const std::string &code)
+{
+    formula_value result;
+    result.type_ = type::error;
+    result.text_ = code;
+
+    return result;
+}
+
+formula_value formula_value::reference(const formula_reference &reference)
+{
+    formula_value result;
+    result.type_ = type::reference;
+    result.reference_ = reference;
+
+    return result;
+}
+
+formula_value::formula_value() : type_(type::empty), number_(0), reference_{ 0, 0, 0, 0, 0 }
+{
+}
+
+formula_program::formula_program(const std::string &formula, const workbook_impl &workbook, std::size_t sheet)
+    : stack_size_(0),
+      max_stack_size_(0)
+{
+    try
+    {
+        compile(formula.empty() || formula.front() == '=' ? formula : "=" + formula, workbook, sheet);
+    }
+    catch(std::exception &)
+    {
+        instructions_.clear();
+        constants_.clear();
+        references_.clear();
+        stack_size_ = 0;
+        emit_constant(formula_value::error("#NAME?"));
+    }
+}
+
+const std::vector<formula_reference> &formula_program::get_references() const
+{
+    return references_;
+}
+
+void formula_program::emit(opcode code, std::uint32_t argument, std::uint32_t count)
+{
+    instructions_.push_back({ code, argument, count });
+
+    switch(code)
+    {
+    case opcode::push_constant:
+    case opcode::push_reference:
+        stack_size_++;
+        break;
+    case opcode::negate:
+    case opcode::percent:
+        break;
+    case opcode::call:
+        if(stack_size_ < count)
+        {
+            throw std::runtime_error("missing function argument");
+        }
+        stack_size_ = stack_size_ - count + 1;
+        break;
+    default:
+        if(stack_size_ < 2)
+        {
+            throw std::runtime_error("missing operand");
+        }
+        stack_size_--;
+        break;
+    }
+
+    if(stack_size_ == 0)
+    {
+        throw std::runtime_error("missing operand");
+    }
+
+    max_stack_size_ = std::max(max_stack_size_, stack_size_);
+}
+
+void formula_program::emit_constant(const formula_value &value)
+{
+    constants_.push_back(value);
+    emit(opcode::push_constant, static_cast<std::uint32_t>(constants_.size() - 1));
+}
+
+void formula_program::compile(const std::string &formula, const workbook_impl &workbook, std::size_t sheet)
+{
+    using type = tokenizer::token_type;
+    using subtype = tokenizer::token_subtype;
+
+    // Operators, function calls and parentheses waiting for their operands (shunting-yard).
+    struct pending
+    {
+        enum class kind
+        {
+            operation,
+            function,
+            parenthesis
+        };
+
+        kind kind_;
+        opcode code;
+        int precedence;
+        std::uint32_t function;
+        std::uint32_t arguments;
+        std::size_t argument_start;
+    };
+
+    std::vector<pending> operators;
+    tokenizer tokens(formula);
+
+    if(tokens.get_tokens().empty() || tokens.get_tokens().front().type == type::literal)
+    {
+        throw std::runtime_error("not a formula");
+    }
+
+    auto pop_operations = [&](int precedence)
+    {
+        while(!operators.empty() && operators.back().kind_ == pending::kind::operation && operators.back().precedence >= precedence)
+        {
+            emit(operators.back().code);
+            operators.pop_back();
+        }
+    };
+
+    // Close the argument being built for the innermost function, pushing an empty value for
+    // an argument left out like the second one in IF(A1,,1).
+    auto finish_argument = [&](bool closing)
+    {
+        pop_operations(0);
+
+        if(operators.empty() || operators.back().kind_ != pending::kind::function)
+        {
+            throw std::runtime_error("separator outside of function");
+        }
+
+        auto &call = operators.back();
+
+        if(stack_size_ == call.argument_start)
+        {
+            if(closing && call.arguments == 0)
+            {
+                return;
+            }
+
+            emit_constant(formula_value());
+        }
+
+        call.arguments++;
+        call.argument_start = stack_size_;
+    };
+
+    for(auto &token : tokens.get_tokens())
+    {
+        switch(token.type)
+        {
+        case type::operand:
+        {
+            auto text = tokens.get_value(token);
+
+            switch(token.subtype)
+            {
+            case subtype::number:
+                emit_constant(formula_value::number(std::strtold(text.c_str(), nullptr)));
+                break;
+            case subtype::text:
+                emit_constant(formula_value::string(unquote(text)));
+                break;
+            case subtype::logical:
+                emit_constant(formula_value::boolean(equals_ignore_case(text, "TRUE")));
+                break;
+            case subtype::error:
+                emit_constant(formula_value::error(text));
+                break;
+            default:
+            {
+                formula_reference reference;
+
+                if(parse_reference(text, workbook, sheet, reference) || find_named_range(text, workbook, sheet, reference))
+                {
+                    references_.push_back(reference);
+                    emit(opcode::push_reference, static_cast<std::uint32_t>(references_.size() - 1));
+                }
+                else
+                {
+                    emit_constant(formula_value::error(text.find('!') == std::string::npos ? "#NAME?" : "#REF!"));
+                }
+                break;
+            }
+            }
+            break;
+        }
+        case type::function:
+            if(token.subtype == subtype::open)
+            {
+                auto name = tokens.get_value(token);
+                name.pop_back();
+
+                for(auto &c : name)
+                {
+                    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+
+                // Functions added after Excel 2007 are saved with a prefix.
+                if(name.compare(0, 6, "_XLFN.") == 0)
+                {
+                    name = name.substr(6);
+                }
+
+                auto function = unknown_function;
+                find_formula_function(name, function);
+                operators.push_back({ pending::kind::function, opcode::call, 0, function, 0, stack_size_ });
+            }
+            else
+            {
+                finish_argument(true);
+                auto call = operators.back();
+                operators.pop_back();
+
+                if(call.function != unknown_function)
+                {
+                    auto &definition = get_formula_function(call.function);
+
+                    if(call.arguments < definition.min_arguments || call.arguments > definition.max_arguments)
+                    {
+                        throw std::runtime_error("wrong number of arguments");
+                    }
+                }
+
+                // An unknown function's arguments are still evaluated so the stack stays balanced.
+                emit(opcode::call, call.function, call.arguments);
+            }
+            break;
+        case type::parenthesis:
+            if(token.subtype == subtype::open)
+            {
+                operators.push_back({ pending::kind::parenthesis, opcode::call, 0, 0, 0, 0 });
+            }
+            else
+            {
+                pop_operations(0);
+
+                if(operators.empty() || operators.back().kind_ != pending::kind::parenthesis)
+                {
+                    throw std::runtime_error("unbalanced parentheses");
+                }
+
+                operators.pop_back();
+            }
+            break;
+        case type::separator:
+            if(token.subtype != subtype::argument)
+            {
+                throw std::runtime_error("array constants aren't supported");
+            }
+
+            finish_argument(false);
+            break;
+        case type::prefix_operator:
+            if(tokens.equals(token, "-"))
+            {
+                operators.push_back({ pending::kind::operation, opcode::negate, 7, 0, 0, 0 });
+            }
+            break;
+        case type::postfix_operator:
+            emit(opcode::percent);
+            break;
+        case type::infix_operator:
+        {
+            struct binary
+            {
+                const char *symbol;
+                opcode code;
+                int precedence;
+            };
+
+            static const binary operations[] =
+            {
+                { ":", opcode::range, 8 },
+                { "^", opcode::power, 5 },
+                { "*", opcode::multiply, 4 },
+                { "/", opcode::divide, 4 },
+                { "+", opcode::add, 3 },
+                { "-", opcode::subtract, 3 },
+                { "&", opcode::concatenate, 2 },
+                { "=", opcode::equal, 1 },
+                { "<>", opcode::not_equal, 1 },
+                { "<", opcode::less, 1 },
+                { "<=", opcode::less_equal, 1 },
+                { ">", opcode::greater, 1 },
+                { ">=", opcode::greater_equal, 1 }
+            };
+
+            auto match = std::find_if(std::begin(operations), std::end(operations),
+                [&](const binary &operation) { return tokens.equals(token, operation.symbol); });
+
+            if(match == std::end(operations))
+            {
+                throw std::runtime_error("unsupported operator");
+            }
+
+            pop_operations(match->precedence);
+            operators.push_back({ pending::kind::operation, match->code, match->precedence, 0, 0, 0 });
+            break;
+        }
+        case type::whitespace:
+            break;
+        default:
+            throw std::runtime_error("unsupported token");
+        }
+    }
+
+    pop_operations(0);
+
+    if(!operators.empty() || stack_size_ != 1)
+    {
+        throw std::runtime_error("unbalanced formula");
+    }
+}
+
+formula_value formula_program::evaluate(const workbook_impl &workbook) const
+{
+    std::vector<formula_value> stack;
+    stack.reserve(max_stack_size_);
+
+    for(auto &instruction : instructions_)
+    {
+        switch(instruction.code)
+        {
+        case opcode::push_constant:
+            stack.push_back(constants_[instruction.argument]);
+            break;
+        case opcode::push_reference:
+            stack.push_back(formula_value::reference(references_[instruction.argument]));
+            break;
+        case opcode::negate:
+        case opcode::percent:
+        {
+            long double number = 0;
+            formula_value error;
+
+            if(!to_number(dereference(stack.back(), workbook), number, error))
+            {
+                stack.back() = error;
+            }
+            else
+            {
+                stack.back() = formula_value::number(instruction.code == opcode::negate ? -number : number / 100);
+            }
+            break;
+        }
+        case opcode::call:
+        {
+            auto first = stack.size() - instruction.count;
+            auto result = instruction.argument == unknown_function
+                ? formula_value::error("#NAME?")
+                : get_formula_function(instruction.argument).function(stack.data() + first, instruction.count, workbook);
+            stack.resize(first);
+            stack.push_back(std::move(result));
+            break;
+        }
+        case opcode::range:
+        {
+            auto right = stack.back();
+            stack.pop_back();
+            auto &left = stack.back();
+
+            if(left.type_ != formula_value::type::reference || right.type_ != formula_value::type::reference
+                || left.reference_.sheet != right.reference_.sheet)
+            {
+                left = formula_value::error("#VALUE!");
+                break;
+            }
+
+            left.reference_.first_column = std::min(left.reference_.first_column, right.reference_.first_column);
+            left.reference_.first_row = std::min(left.reference_.first_row, right.reference_.first_row);
+            left.reference_.last_column = std::max(left.reference_.last_column, right.reference_.last_column);
+            left.reference_.last_row = std::max(left.reference_.last_row, right.reference_.last_row);
+            break;
+        }
+        default:
+        {
+            auto right = dereference(stack.back(), workbook);
+            stack.pop_back();
+            auto left = dereference(stack.back(), workbook);
+            auto &result = stack.back();
+
+            if(left.type_ == formula_value::type::error || right.type_ == formula_value::type::error)
+            {
+                result = left.type_ == formula_value::type::error ? left : right;
+                break;
+            }
+
+            if(instruction.code == opcode::concatenate)
+            {
+                result = formula_value::string(to_text(left) + to_text(right));
+                break;
+            }
+
+            if(instruction.code >= opcode::equal)
+            {
+                auto order = compare(left, right);
+                bool outcome = false;
+
+                switch(instruction.code)
+                {
+                case opcode::equal: outcome = order == 0; break;
+                case opcode::not_equal: outcome = order != 0; break;
+                case opcode::less: outcome = order < 0; break;
+                case opcode::less_equal: outcome = order <= 0; break;
+                case opcode::greater: outcome = order > 0; break;
+                default: outcome = order >= 0; break;
+                }
+
+                result = formula_value::boolean(outcome);
+                break;
+            }
+
+            long double left_number = 0;
+            long double right_number = 0;
+            formula_value error;
+
+            if(!to_number(left, left_number, error) || !to_number(right, right_number, error))
+            {
+                result = error;
+                break;
+            }
+
+            switch(instruction.code)
+            {
+            case opcode::add:
+                result = formula_value::number(left_number + right_number);
+                break;
+            case opcode::subtract:
+                result = formula_value::number(left_number - right_number);
+                break;
+            case opcode::multiply:
+                result = formula_value::number(left_number * right_number);
+                break;
+            case opcode::divide:
+                result = right_number == 0 ? formula_value::error("#DIV/0!") : formula_value::number(left_number / right_number);
+                break;
+            default:
+                result = left_number == 0 && right_number < 0 ? formula_value::error("#DIV/0!") : number_or_error(std::pow(left_number, right_number));
+                break;
+            }
+            break;
+        }
+        }
+    }
+
+    return dereference(stack.back(), workbook);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/common/types.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct workbook_impl;
+
+/// <summary>
+/// A rectangular block of cells on one worksheet, identified by the worksheet's index in the workbook.
+/// </summary>
+struct formula_reference
+{
+    std::size_t sheet;
+    column_t first_column;
+    row_t first_row;
+    column_t last_column;
+    row_t last_row;
+};
+
+/// <summary>
+/// The result of evaluating all or part of a formula. References are only produced
+/// while evaluating, a finished formula always yields one of the other types.
+/// </summary>
+struct formula_value
+{
+    enum class type
+    {
+        empty,
+        number,
+        string,
+        boolean,
+        error,
+        reference
+    };
+
+    static formula_value number(long double number);
+    static formula_value string(const std::string &text);
+    static formula_value boolean(bool value);
+    static formula_value error(const std::string &code);
+    static formula_value reference(const formula_reference &reference);
+
+    formula_value();
+
+    type type_;
+    long double number_;
+    std::string text_;
+    formula_reference reference_;
+};
+
+/// <summary>
+/// A formula compiled once into a flat postfix program. Evaluating it runs the
+/// instructions over a value stack and reads cells straight from the workbook, so
+/// the formula text is never looked at again.
+/// </summary>
+class formula_program
+{
+public:
+    /// <summary>
+    /// Compile formula, entered in a cell on the worksheet at index sheet. Sheet names and
+    /// defined names are resolved against workbook now. A formula that can't be compiled
+    /// evaluates to the error Excel would show for it, usually #NAME?.
+    /// </summary>
+    formula_program(const std::string &formula, const workbook_impl &workbook, std::size_t sheet);
+
+    formula_value evaluate(const workbook_impl &workbook) const;
+
+    /// <summary>
+    /// Every block of cells the formula reads, used to build the dependency graph.
+    /// </summary>
+    const std::vector<formula_reference> &get_references() const;
+
+private:
+    enum class opcode : std::uint8_t
+    {
+        push_constant,
+        push_reference,
+        negate,
+        percent,
+        add,
+        subtract,
+        multiply,
+        divide,
+        power,
+        concatenate,
+        equal,
+        not_equal,
+        less,
+        less_equal,
+        greater,
+        greater_equal,
+        range,
+        call
+    };
+
+    struct instruction
+    {
+        opcode code;
+        std::uint32_t argument;
+        std::uint32_t count;
+    };
+
+    void compile(const std::string &formula, const workbook_impl &workbook, std::size_t sheet);
+    void emit(opcode code, std::uint32_t argument = 0, std::uint32_t count = 0);
+    void emit_constant(const formula_value &value);
+
+    std::vector<instruction> instructions_;
+    std::vector<formula_value> constants_;
+    std::vector<formula_reference> references_;
+    std::size_t stack_size_;
+    std::size_t max_stack_size_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Mixes the hash of value into seed, boost::hash_combine style.
+/// </summary>
+template<typename T>
+void hash_combine(std::size_t &seed, const T &value)
+{
+    seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,257 @@
+#include <algorithm>
+
+#include "hash_combine.hpp"
+#include "merged_index.hpp"
+
+namespace {
+
+// Ranges merged since the tree was built are scanned one by one until there are this many.
+const std::size_t max_pending = 32;
+
+const std::size_t no_range = static_cast<std::size_t>(-1);
+
+struct bounds
+{
+    explicit bounds(const xlnt::range_reference &reference)
+    : first_column(std::min(reference.get_top_left().get_column_index(), reference.get_bottom_right().get_column_index())),
+      first_row(std::min(reference.get_top_left().get_row(), reference.get_bottom_right().get_row())),
+      last_column(std::max(reference.get_top_left().get_column_index(), reference.get_bottom_right().get_column_index())),
+      last_row(std::max(reference.get_top_left().get_row(), reference.get_bottom_right().get_row()))
+    {
+    }
+
+    bool contains(column_t column, row_t row) const
+    {
+        return column >= first_column && column <= last_column && row >= first_row && row <= last_row;
+    }
+
+    column_t first_column;
+    row_t first_row;
+    column_t last_column;
+    row_t last_row;
+};
+
+std::size_t hash_range(const xlnt::range_reference &reference)
+{
+    std::size_t seed = 0;
+    xlnt::detail::hash_combine(seed, reference.get_top_left().get_column_index());
+    xlnt::detail::hash_combine(seed, reference.get_top_left().get_row());
+    xlnt::detail::hash_combine(seed, reference.get_bottom_right().get_column_index());
+    xlnt::detail::hash_combine(seed, reference.get_bottom_right().get_row());
+
+    return seed;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+const std::size_t merged_index::no_node = static_cast<std::size_t>(-1);
+
+merged_index::merged_index() : removed_count_(0), indexed_(0), root_(no_node)
+{
+}
+
+void merged_index::add(const range_reference &reference)
+{
+    ranges_.push_back(reference);
+    removed_.push_back(false);
+    positions_.emplace(hash_range(reference), ranges_.size() - 1);
+}
+
+bool merged_index::remove(const range_reference &reference)
+{
+    auto candidates = positions_.equal_range(hash_range(reference));
+
+    for(auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+    {
+        if(ranges_[candidate->second] == reference)
+        {
+            removed_[candidate->second] = true;
+            removed_count_++;
+            positions_.erase(candidate);
+
+            // The tree skips removed ranges, so it's only rebuilt once most of it is dead weight.
+            if(removed_count_ * 2 > ranges_.size())
+            {
+                compact();
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const range_reference *merged_index::find(column_t column, row_t row) const
+{
+    if(ranges_.size() - indexed_ > max_pending)
+    {
+        std::vector<std::size_t> live;
+        live.reserve(ranges_.size() - removed_count_);
+
+        for(std::size_t i = 0; i < ranges_.size(); i++)
+        {
+            if(!removed_[i])
+            {
+                live.push_back(i);
+            }
+        }
+
+        nodes_.clear();
+        entries_.clear();
+        root_ = build(live, 0, live.size());
+        indexed_ = ranges_.size();
+    }
+
+    auto best = no_range;
+    auto current = root_;
+
+    while(current != no_node)
+    {
+        auto &tree_node = nodes_[current];
+        auto first = entries_.begin() + static_cast<std::ptrdiff_t>(tree_node.begin);
+        auto last = entries_.begin() + static_cast<std::ptrdiff_t>(tree_node.end);
+
+        // Walk back from the last range starting at or before column while any earlier one reaches it.
+        auto candidate = std::upper_bound(first, last, column,
+            [](column_t value, const entry &e) { return value < e.first_column; });
+
+        while(candidate != first && (candidate - 1)->max_last_column >= column)
+        {
+            --candidate;
+
+            if(candidate->range < best && !removed_[candidate->range] && bounds(ranges_[candidate->range]).contains(column, row))
+            {
+                best = candidate->range;
+            }
+        }
+
+        if(row == tree_node.center)
+        {
+            break;
+        }
+
+        current = row < tree_node.center ? tree_node.left : tree_node.right;
+    }
+
+    if(best != no_range)
+    {
+        return &ranges_[best];
+    }
+
+    return find_pending(column, row);
+}
+
+std::vector<range_reference> merged_index::get_ranges() const
+{
+    std::vector<range_reference> ranges;
+    ranges.reserve(ranges_.size() - removed_count_);
+
+    for(std::size_t i = 0; i < ranges_.size(); i++)
+    {
+        if(!removed_[i])
+        {
+            ranges.push_back(ranges_[i]);
+        }
+    }
+
+    return ranges;
+}
+
+bool merged_index::empty() const
+{
+    return ranges_.size() == removed_count_;
+}
+
+std::size_t merged_index::build(std::vector<std::size_t> &ranges, std::size_t begin, std::size_t end) const
+{
+    if(begin == end)
+    {
+        return no_node;
+    }
+
+    auto first = ranges.begin() + static_cast<std::ptrdiff_t>(begin);
+    auto last = ranges.begin() + static_cast<std::ptrdiff_t>(end);
+    auto middle = first + static_cast<std::ptrdiff_t>((end - begin) / 2);
+
+    // Splitting at the median first row leaves at most half of the ranges on either side.
+    std::nth_element(first, middle, last,
+        [this](std::size_t a, std::size_t b) { return bounds(ranges_[a]).first_row < bounds(ranges_[b]).first_row; });
+    auto center = bounds(ranges_[*middle]).first_row;
+
+    auto left_end = std::partition(first, last,
+        [&](std::size_t i) { return bounds(ranges_[i]).last_row < center; });
+    auto right_begin = std::partition(left_end, last,
+        [&](std::size_t i) { return bounds(ranges_[i]).first_row <= center; });
+
+    node tree_node;
+    tree_node.center = center;
+    tree_node.begin = entries_.size();
+
+    for(auto i = left_end; i != right_begin; ++i)
+    {
+        bounds range_bounds(ranges_[*i]);
+        entries_.push_back({ range_bounds.first_column, range_bounds.last_column, *i });
+    }
+
+    tree_node.end = entries_.size();
+
+    auto node_first = entries_.begin() + static_cast<std::ptrdiff_t>(tree_node.begin);
+    std::sort(node_first, entries_.end(),
+        [](const entry &a, const entry &b) { return a.first_column < b.first_column; });
+
+    for(auto i = tree_node.begin + 1; i < tree_node.end; i++)
+    {
+        entries_[i].max_last_column = std::max(entries_[i].max_last_column, entries_[i - 1].max_last_column);
+    }
+
+    auto left_size = static_cast<std::size_t>(left_end - ranges.begin());
+    auto right_start = static_cast<std::size_t>(right_begin - ranges.begin());
+
+    auto index = nodes_.size();
+    nodes_.push_back(tree_node);
+
+    auto left = build(ranges, begin, left_size);
+    auto right = build(ranges, right_start, end);
+    nodes_[index].left = left;
+    nodes_[index].right = right;
+
+    return index;
+}
+
+const range_reference *merged_index::find_pending(column_t column, row_t row) const
+{
+    for(auto i = indexed_; i < ranges_.size(); i++)
+    {
+        if(!removed_[i] && bounds(ranges_[i]).contains(column, row))
+        {
+            return &ranges_[i];
+        }
+    }
+
+    return nullptr;
+}
+
+void merged_index::compact()
+{
+    ranges_ = get_ranges();
+    removed_.assign(ranges_.size(), false);
+    removed_count_ = 0;
+    positions_.clear();
+
+    for(std::size_t i = 0; i < ranges_.size(); i++)
+    {
+        positions_.emplace(hash_range(ranges_[i]), i);
+    }
+
+    nodes_.clear();
+    entries_.clear();
+    root_ = no_node;
+    indexed_ = 0;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/common/types.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The merged ranges of a worksheet, kept in the order they were merged, with an index answering
+/// which range covers a cell in logarithmic time. Merging and unmerging cost the same however many
+/// cells a range spans, and no per-cell state is kept.
+/// </summary>
+class merged_index
+{
+public:
+    merged_index();
+
+    void add(const range_reference &reference);
+
+    /// <summary>
+    /// Remove reference, which must have been added exactly as given. Returns false if it wasn't.
+    /// </summary>
+    bool remove(const range_reference &reference);
+
+    /// <summary>
+    /// Return the merged range containing the cell at column, row or nullptr if there is none.
+    /// If ranges overlap, the one merged first is returned.
+    /// </summary>
+    const range_reference *find(column_t column, row_t row) const;
+
+    std::vector<range_reference> get_ranges() const;
+
+    bool empty() const;
+
+private:
+    // A centered interval tree over rows. Every node holds the ranges whose rows include its
+    // center, sorted by first column. Ranges containing the same row can only share columns if
+    // they overlap, so normally at most one range per node can contain a given column.
+    struct node
+    {
+        row_t center;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t left;
+        std::size_t right;
+    };
+
+    struct entry
+    {
+        column_t first_column;
+        column_t max_last_column;
+        std::size_t range;
+    };
+
+    static const std::size_t no_node;
+
+    std::size_t build(std::vector<std::size_t> &ranges, std::size_t begin, std::size_t end) const;
+    const range_reference *find_pending(column_t column, row_t row) const;
+    void compact();
+
+    std::vector<range_reference> ranges_;
+    std::vector<bool> removed_;
+    std::size_t removed_count_;
+
+    // Position of each live range in ranges_ by a hash of its bounds.
+    std::unordered_multimap<std::size_t, std::size_t> positions_;
+
+    // The tree covers ranges_ up to indexed_. Ranges merged since are checked one by one until
+    // there are enough of them to be worth rebuilding the tree for.
+    mutable std::size_t indexed_;
+    mutable std::size_t root_;
+    mutable std::vector<node> nodes_;
+    mutable std::vector<entry> entries_;
+};
+
+} // namespace detail
+} // namespace xlnt
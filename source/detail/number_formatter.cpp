@@ -0,0 +1,496 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+
+#include "number_formatter.hpp"
+
+namespace {
+
+const char *const MonthNames[] =
+{
+    "January",
+    "February",
+    "March",
+    "April",
+    "May",
+    "June",
+    "July",
+    "August",
+    "September",
+    "October",
+    "November",
+    "December"
+};
+
+const char *const WeekdayNames[] =
+{
+    "Sunday",
+    "Monday",
+    "Tuesday",
+    "Wednesday",
+    "Thursday",
+    "Friday",
+    "Saturday"
+};
+
+/// <summary>
+/// Split a format string into its sections at each semicolon outside of quotes.
+/// </summary>
+std::vector<std::string> split_sections(const std::string &format_string)
+{
+    std::vector<std::string> sections(1);
+    bool in_quotes = false;
+
+    for(auto c : format_string)
+    {
+        if(c == '"')
+        {
+            in_quotes = !in_quotes;
+        }
+        else if(c == ';' && !in_quotes)
+        {
+            sections.emplace_back();
+            continue;
+        }
+
+        sections.back().push_back(c);
+    }
+
+    return sections;
+}
+
+bool is_valid_color(const std::string &color)
+{
+    static const std::vector<std::string> colors = { "Black", "Green", "White", "Blue", "Magenta", "Yellow", "Cyan", "Red" };
+    return std::find(colors.begin(), colors.end(), color) != colors.end();
+}
+
+bool is_elapsed_time(const std::string &bracket_part)
+{
+    static const std::vector<std::string> bracket_times = { "h", "hh", "m", "mm", "s", "ss" };
+    return std::find(bracket_times.begin(), bracket_times.end(), bracket_part) != bracket_times.end();
+}
+
+bool is_date_format(const std::string &format_string)
+{
+    return !format_string.empty() && format_string.find_first_not_of("/-:, mMyYdDhHsS") == std::string::npos;
+}
+
+// Sakamoto's method, 0 is Sunday.
+int day_of_week(int year, int month, int day)
+{
+    static const int offsets[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+    year -= month < 3 ? 1 : 0;
+    return (year + year / 4 - year / 100 + year / 400 + offsets[month - 1] + day) % 7;
+}
+
+void append_number(std::string &result, int number, bool padded)
+{
+    char buffer[16];
+    auto length = std::snprintf(buffer, sizeof(buffer), padded ? "%02d" : "%d", number);
+    result.append(buffer, static_cast<std::size_t>(length));
+}
+
+void append_general(std::string &result, long double number)
+{
+    char buffer[64];
+    int length = 0;
+
+    if(number == static_cast<long long int>(number))
+    {
+        length = std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long int>(number));
+    }
+    else
+    {
+        length = std::snprintf(buffer, sizeof(buffer), "%Lf", number);
+    }
+
+    result.append(buffer, static_cast<std::size_t>(std::min(length, static_cast<int>(sizeof(buffer)) - 1)));
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+number_formatter::number_formatter(const std::string &format_string) : general_(format_string == "General")
+{
+    if(general_)
+    {
+        return;
+    }
+
+    auto split = split_sections(format_string);
+
+    if(split.size() > 4)
+    {
+        throw std::runtime_error("too many parts");
+    }
+
+    for(const auto &section_string : split)
+    {
+        sections_.push_back(compile_section(section_string));
+    }
+
+    if(sections_.size() > 2 && sections_[2].condition != condition_type::none)
+    {
+        throw std::runtime_error("third section shouldn't have a condition");
+    }
+
+    if(sections_.size() > 3 && sections_[0].condition != condition_type::none)
+    {
+        throw std::runtime_error("too many parts");
+    }
+}
+
+number_formatter::section number_formatter::compile_section(const std::string &section_string)
+{
+    section result;
+    std::string value = section_string;
+    bool has_color = false;
+
+    // Up to two leading bracketed parts give a color and/or a condition.
+    for(int bracket = 0; bracket < 2 && !value.empty() && value.front() == '['; bracket++)
+    {
+        auto close_bracket_index = value.find(']');
+
+        if(close_bracket_index == std::string::npos)
+        {
+            throw std::runtime_error("missing close bracket");
+        }
+
+        auto bracket_part = value.substr(1, close_bracket_index - 1);
+
+        if(is_elapsed_time(bracket_part))
+        {
+            break;
+        }
+
+        value = value.substr(close_bracket_index + 1);
+
+        if(is_valid_color(bracket_part))
+        {
+            if(has_color)
+            {
+                throw std::runtime_error("two colors in one section");
+            }
+
+            has_color = true;
+            continue;
+        }
+
+        if(!bracket_part.empty() && bracket_part.front() == '$')
+        {
+            // Currency and locale such as [$€-407]. Only the symbol is shown.
+            auto symbol = bracket_part.substr(1, bracket_part.find('-') - 1);
+            
+            if(!symbol.empty())
+            {
+                value = "\"" + symbol + "\"" + value;
+            }
+            
+            continue;
+        }
+
+        if(result.condition != condition_type::none)
+        {
+            throw std::runtime_error("two conditions in one section");
+        }
+
+        std::size_t operator_length = 1;
+
+        if(bracket_part.compare(0, 2, "<=") == 0)
+        {
+            result.condition = condition_type::less_or_equal;
+            operator_length = 2;
+        }
+        else if(bracket_part.compare(0, 2, ">=") == 0)
+        {
+            result.condition = condition_type::greater_or_equal;
+            operator_length = 2;
+        }
+        else if(bracket_part.compare(0, 1, "<") == 0)
+        {
+            result.condition = condition_type::less_than;
+        }
+        else if(bracket_part.compare(0, 1, ">") == 0)
+        {
+            result.condition = condition_type::greater_than;
+        }
+        else if(bracket_part.compare(0, 1, "=") == 0)
+        {
+            result.condition = condition_type::equal;
+        }
+        else
+        {
+            throw std::runtime_error("invalid condition");
+        }
+
+        try
+        {
+            result.condition_value = std::stold(bracket_part.substr(operator_length));
+        }
+        catch(const std::logic_error &)
+        {
+            throw std::runtime_error("invalid condition");
+        }
+    }
+
+    result.is_date = is_date_format(value);
+
+    auto append_literal = [&result](const std::string &literal)
+    {
+        if(result.tokens.empty() || result.tokens.back().type != token_type::literal)
+        {
+            result.tokens.push_back({ token_type::literal, "" });
+        }
+
+        result.tokens.back().literal.append(literal);
+    };
+
+    if(!result.is_date)
+    {
+        for(std::size_t i = 0; i < value.size(); i++)
+        {
+            if(value[i] == '@')
+            {
+                result.tokens.push_back({ token_type::text, "" });
+                result.has_text = true;
+            }
+            else if(value[i] == '"')
+            {
+                auto close_quote_index = value.find('"', i + 1);
+
+                if(close_quote_index == std::string::npos)
+                {
+                    throw std::runtime_error("missing close quote");
+                }
+
+                append_literal(value.substr(i + 1, close_quote_index - i - 1));
+                i = close_quote_index;
+            }
+            else if(value[i] == '\\' && i + 1 < value.size())
+            {
+                append_literal(std::string(1, value[++i]));
+            }
+            else
+            {
+                append_literal(std::string(1, value[i]));
+            }
+        }
+
+        return result;
+    }
+
+    for(std::size_t i = 0; i < value.size();)
+    {
+        auto letter = static_cast<char>(std::tolower(value[i]));
+
+        if(letter != 'y' && letter != 'm' && letter != 'd' && letter != 'h' && letter != 's')
+        {
+            append_literal(std::string(1, value[i++]));
+            continue;
+        }
+
+        std::size_t count = 0;
+
+        while(i < value.size() && std::tolower(value[i]) == letter)
+        {
+            count++;
+            i++;
+        }
+
+        switch(letter)
+        {
+        case 'y':
+            result.tokens.push_back({ count <= 2 ? token_type::year_short : token_type::year, "" });
+            break;
+        case 'm':
+            result.tokens.push_back({ count == 1 ? token_type::month : count == 2 ? token_type::month_padded
+                : count == 3 ? token_type::month_abbreviation : count == 4 ? token_type::month_name : token_type::month_letter, "" });
+            break;
+        case 'd':
+            result.tokens.push_back({ count == 1 ? token_type::day : count == 2 ? token_type::day_padded
+                : count == 3 ? token_type::weekday_abbreviation : token_type::weekday_name, "" });
+            break;
+        case 'h':
+            result.tokens.push_back({ count == 1 ? token_type::hour : token_type::hour_padded, "" });
+            break;
+        case 's':
+            result.tokens.push_back({ count == 1 ? token_type::second : token_type::second_padded, "" });
+            break;
+        }
+    }
+
+    // m and mm mean minutes rather than months directly after an hour or directly before a second.
+    token *previous = nullptr;
+
+    for(auto &current : result.tokens)
+    {
+        if(current.type == token_type::literal)
+        {
+            continue;
+        }
+
+        bool is_month = current.type == token_type::month || current.type == token_type::month_padded;
+
+        if(previous != nullptr && (current.type == token_type::second || current.type == token_type::second_padded)
+            && (previous->type == token_type::month || previous->type == token_type::month_padded))
+        {
+            previous->type = previous->type == token_type::month ? token_type::minute : token_type::minute_padded;
+        }
+
+        if(is_month && previous != nullptr && (previous->type == token_type::hour || previous->type == token_type::hour_padded))
+        {
+            current.type = current.type == token_type::month ? token_type::minute : token_type::minute_padded;
+        }
+
+        previous = &current;
+    }
+
+    return result;
+}
+
+bool number_formatter::section::matches(long double number) const
+{
+    switch(condition)
+    {
+    case condition_type::less_than: return number < condition_value;
+    case condition_type::less_or_equal: return number <= condition_value;
+    case condition_type::equal: return number == condition_value;
+    case condition_type::greater_than: return number > condition_value;
+    case condition_type::greater_or_equal: return number >= condition_value;
+    default: return true;
+    }
+}
+
+const number_formatter::section &number_formatter::select_section(long double number) const
+{
+    if(sections_.front().condition != condition_type::none)
+    {
+        if(sections_[0].matches(number))
+        {
+            return sections_[0];
+        }
+
+        if(sections_.size() > 1 && sections_[1].condition != condition_type::none && sections_[1].matches(number))
+        {
+            return sections_[1];
+        }
+
+        if(sections_.size() > 2)
+        {
+            return sections_[2];
+        }
+
+        return sections_.back();
+    }
+
+    if(number > 0 || sections_.size() == 1)
+    {
+        return sections_[0];
+    }
+
+    if(number < 0)
+    {
+        return sections_[1];
+    }
+
+    return sections_.size() > 2 ? sections_[2] : sections_[0];
+}
+
+std::string number_formatter::format(long double number, calendar base_date) const
+{
+    std::string result;
+    format(number, base_date, result);
+
+    return result;
+}
+
+std::string number_formatter::format(const std::string &text) const
+{
+    std::string result;
+    format(text, result);
+
+    return result;
+}
+
+void number_formatter::format(long double number, calendar base_date, std::string &result) const
+{
+    if(general_)
+    {
+        append_general(result, number);
+        return;
+    }
+
+    const auto &selected = select_section(number);
+
+    if(!selected.is_date)
+    {
+        append_general(result, number);
+        return;
+    }
+
+    auto d = datetime::from_number(number, base_date);
+
+    for(const auto &t : selected.tokens)
+    {
+        switch(t.type)
+        {
+        case token_type::literal: result.append(t.literal); break;
+        case token_type::year_short: append_number(result, d.year % 100, true); break;
+        case token_type::year: append_number(result, d.year, false); break;
+        case token_type::month: append_number(result, d.month, false); break;
+        case token_type::month_padded: append_number(result, d.month, true); break;
+        case token_type::month_abbreviation: result.append(MonthNames[d.month - 1], 3); break;
+        case token_type::month_name: result.append(MonthNames[d.month - 1]); break;
+        case token_type::month_letter: result.append(MonthNames[d.month - 1], 1); break;
+        case token_type::day: append_number(result, d.day, false); break;
+        case token_type::day_padded: append_number(result, d.day, true); break;
+        case token_type::weekday_abbreviation: result.append(WeekdayNames[day_of_week(d.year, d.month, d.day)], 3); break;
+        case token_type::weekday_name: result.append(WeekdayNames[day_of_week(d.year, d.month, d.day)]); break;
+        case token_type::hour: append_number(result, d.hour, false); break;
+        case token_type::hour_padded: append_number(result, d.hour, true); break;
+        case token_type::minute: append_number(result, d.minute, false); break;
+        case token_type::minute_padded: append_number(result, d.minute, true); break;
+        case token_type::second: append_number(result, d.second, false); break;
+        case token_type::second_padded: append_number(result, d.second, true); break;
+        case token_type::text: break;
+        }
+    }
+}
+
+void number_formatter::format(const std::string &text, std::string &result) const
+{
+    const section *text_section = nullptr;
+
+    if(sections_.size() > 3)
+    {
+        text_section = &sections_[3];
+    }
+    else if(sections_.size() == 1 && sections_[0].has_text)
+    {
+        text_section = &sections_[0];
+    }
+
+    // Without a text section text is shown unchanged.
+    if(general_ || text_section == nullptr)
+    {
+        result.append(text);
+        return;
+    }
+
+    for(const auto &t : text_section->tokens)
+    {
+        result.append(t.type == token_type::text ? text : t.literal);
+    }
+}
+
+bool number_formatter::is_date() const
+{
+    return !general_ && sections_.front().is_date;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <xlnt/common/datetime.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A number format string parsed once into sections of tokens. Formatting a value
+/// selects a section and walks its tokens without looking at the format string again.
+/// Instances are immutable once constructed so one can be shared by every cell using the format.
+/// </summary>
+class number_formatter
+{
+public:
+    /// <summary>
+    /// Compile format_string. Throws std::runtime_error if it isn't a valid format.
+    /// </summary>
+    explicit number_formatter(const std::string &format_string);
+
+    std::string format(long double number, calendar base_date) const;
+    std::string format(const std::string &text) const;
+
+    /// <summary>
+    /// Append the formatted value to result instead of returning a new string.
+    /// </summary>
+    void format(long double number, calendar base_date, std::string &result) const;
+    void format(const std::string &text, std::string &result) const;
+
+    /// <summary>
+    /// True if numbers in the first section are rendered as a date or time.
+    /// </summary>
+    bool is_date() const;
+
+private:
+    enum class token_type
+    {
+        literal,
+        text,
+        year_short,
+        year,
+        month,
+        month_padded,
+        month_abbreviation,
+        month_name,
+        month_letter,
+        day,
+        day_padded,
+        weekday_abbreviation,
+        weekday_name,
+        hour,
+        hour_padded,
+        minute,
+        minute_padded,
+        second,
+        second_padded
+    };
+
+    struct token
+    {
+        token_type type;
+        std::string literal;
+    };
+
+    enum class condition_type
+    {
+        none,
+        less_than,
+        less_or_equal,
+        equal,
+        greater_than,
+        greater_or_equal
+    };
+
+    struct section
+    {
+        condition_type condition = condition_type::none;
+        long double condition_value = 0;
+        bool is_date = false;
+        bool has_text = false;
+        std::vector<token> tokens;
+
+        bool matches(long double number) const;
+    };
+
+    static section compile_section(const std::string &section_string);
+
+    const section &select_section(long double number) const;
+
+    bool general_;
+    std::vector<section> sections_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,49 @@
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+#include "cell_impl.hpp"
+#include "cell_scan.hpp"
+#include "range_aggregate.hpp"
+#include "worksheet_impl.hpp"
+
+namespace xlnt {
+namespace detail {
+
+void aggregate_range(const worksheet_impl &worksheet, column_t first_column, row_t first_row,
+    column_t last_column, row_t last_row, range_aggregate &totals)
+{
+    scan_cells(worksheet, first_column, first_row, last_column, last_row, [&](row_t, column_t, const cell_impl &cell)
+    {
+        switch(cell.type_)
+        {
+        case cell::type::numeric:
+            totals.add(cell.value_numeric_);
+            totals.values++;
+            break;
+        case cell::type::error:
+            totals.error = totals.error == nullptr ? &cell : totals.error;
+            totals.values++;
+            break;
+        case cell::type::string:
+        case cell::type::boolean:
+            totals.values++;
+            break;
+        default:
+            // Empty cells and formulas that haven't been calculated have no value.
+            break;
+        }
+    });
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/common/types.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct cell_impl;
+struct worksheet_impl;
+
+/// <summary>
+/// Running totals of the numbers in one or more blocks of cells, shared by range's
+/// aggregate functions and by SUM, AVERAGE, MIN, MAX, COUNT and COUNTA in formulas.
+/// </summary>
+struct range_aggregate
+{
+    void add(long double number)
+    {
+        sum += number;
+        min = numbers == 0 || number < min ? number : min;
+        max = numbers == 0 || number > max ? number : max;
+        numbers++;
+    }
+
+    long double sum = 0;
+    long double min = 0;
+    long double max = 0;
+
+    // Numeric cells and all non-empty cells.
+    std::size_t numbers = 0;
+    std::size_t values = 0;
+
+    // The first error cell seen in row-major order, if any. Scanning carries on past it.
+    const cell_impl *error = nullptr;
+};
+
+/// <summary>
+/// Add the numeric cells of worksheet in the given block to totals in row-major order, so that
+/// sums are rounded the same way as adding the cells one by one. Text, boolean and empty cells
+/// are skipped without building a value for them and missing cells aren't created.
+/// </summary>
+void aggregate_range(const worksheet_impl &worksheet, column_t first_column, row_t first_row,
+    column_t last_column, row_t last_row, range_aggregate &totals);
+
+} // namespace detail
+} // namespace xlnt
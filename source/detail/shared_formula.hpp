@@ -0,0 +1,95 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/common/exceptions.hpp>
+#include <xlnt/formula/translate.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A formula written once in a worksheet and used by every cell in reference, as
+/// stored in <f t="shared"> elements. Cells in the group only hold the group's index
+/// and their formula is produced by translating this one from origin when requested.
+/// </summary>
+struct shared_formula
+{
+    shared_formula() : defined_(false)
+    {
+    }
+
+    shared_formula(const cell_reference &origin, const range_reference &reference, const std::string &formula)
+        : defined_(true),
+          origin_(origin),
+          reference_(reference),
+          formula_(formula)
+    {
+    }
+
+    // The translator is a cache so copies start without one.
+    shared_formula(const shared_formula &other)
+        : defined_(other.defined_),
+          origin_(other.origin_),
+          reference_(other.reference_),
+          formula_(other.formula_)
+    {
+    }
+
+    shared_formula(shared_formula &&other) noexcept = default;
+
+    shared_formula &operator=(const shared_formula &other)
+    {
+        defined_ = other.defined_;
+        origin_ = other.origin_;
+        reference_ = other.reference_;
+        formula_ = other.formula_;
+        translator_.reset();
+
+        return *this;
+    }
+
+    shared_formula &operator=(shared_formula &&other) noexcept = default;
+
+    std::string translate(const cell_reference &destination) const
+    {
+        if(destination == origin_)
+        {
+            return formula_;
+        }
+
+        // Formulas read from a file don't start with "=" but the tokenizer needs one
+        // to tell a formula from a literal.
+        auto has_equals = !formula_.empty() && formula_.front() == '=';
+
+        // Text the tokenizer doesn't cover, such as newer error literals, is left as written
+        // rather than making the whole sheet unreadable and unwritable.
+        try
+        {
+            if(!translator_)
+            {
+                translator_.reset(new translator(has_equals ? formula_ : "=" + formula_, origin_));
+            }
+
+            auto translated = translator_->translate_formula(destination);
+
+            return has_equals ? translated : translated.substr(1);
+        }
+        catch(const formula_syntax_exception &)
+        {
+            return formula_;
+        }
+    }
+
+    bool defined_;
+    cell_reference origin_;
+    range_reference reference_;
+    std::string formula_;
+    mutable std::unique_ptr<translator> translator_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -1,8 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <xlnt/reader/load_options.hpp>
+
+#include "component_table.hpp"
+#include "defined_name_index.hpp"
+#include "fold_case.hpp"
+#include "formula_engine.hpp"
+#include "number_formatter.hpp"
+#include "worksheet_impl.hpp"
+
 namespace xlnt {
 namespace detail {
 
@@ -12,12 +25,19 @@ struct workbook_impl
     
     workbook_impl(const workbook_impl &other) 
         : active_sheet_index_(other.active_sheet_index_),
-        worksheets_(other.worksheets_), 
         relationships_(other.relationships_), 
+        relationship_ids_(other.relationship_ids_),
         drawings_(other.drawings_), 
         properties_(other.properties_), 
         guess_types_(other.guess_types_),
         data_only_(other.data_only_),
+        lazy_load_(other.lazy_load_),
+        load_options_(other.load_options_),
+        calculation_threads_(other.calculation_threads_),
+        archive_(other.archive_),
+        unloaded_sheets_(other.unloaded_sheets_),
+        shared_strings_(other.shared_strings_),
+        style_ids_(other.style_ids_),
         styles_(other.styles_),
         alignments_(other.alignments_),
         borders_(other.borders_),
@@ -26,50 +46,210 @@ struct workbook_impl
         number_formats_(other.number_formats_),
         protections_(other.protections_)
     {
+        copy_worksheets(other);
     }
     
+    workbook_impl(workbook_impl &&other) = default;
+    workbook_impl &operator=(workbook_impl &&other) = default;
+    
     workbook_impl &operator=(const workbook_impl &other)
     {
         active_sheet_index_ = other.active_sheet_index_;
-        worksheets_.clear();
-        std::copy(other.worksheets_.begin(), other.worksheets_.end(), back_inserter(worksheets_));
+        copy_worksheets(other);
         relationships_.clear();
         std::copy(other.relationships_.begin(), other.relationships_.end(), std::back_inserter(relationships_));
+        relationship_ids_ = other.relationship_ids_;
         drawings_.clear();
         std::copy(other.drawings_.begin(), other.drawings_.end(), back_inserter(drawings_));
         properties_ = other.properties_;
         guess_types_ = other.guess_types_;
         data_only_ = other.data_only_;
+        lazy_load_ = other.lazy_load_;
+        load_options_ = other.load_options_;
+        calculation_threads_ = other.calculation_threads_;
+        archive_ = other.archive_;
+        unloaded_sheets_ = other.unloaded_sheets_;
+        shared_strings_ = other.shared_strings_;
+        style_ids_ = other.style_ids_;
         styles_ = other.styles_;
         alignments_ = other.alignments_;
         borders_ = other.borders_;
         fills_ = other.fills_;
         fonts_ = other.fonts_;
         number_formats_ = other.number_formats_;
+        number_formatters_.clear();
         protections_ = other.protections_;
+        formula_engine_.reset();
         
         return *this;
     }
 
+    void copy_worksheets(const workbook_impl &other)
+    {
+        worksheets_.clear();
+        worksheets_.reserve(other.worksheets_.size());
+        sheet_titles_.clear();
+        next_suffixes_.clear();
+        std::unordered_map<const worksheet_impl *, worksheet_impl *> copies;
+        
+        for(const auto &ws : other.worksheets_)
+        {
+            worksheets_.push_back(std::make_unique<worksheet_impl>(*ws));
+            index_sheet(worksheets_.back().get());
+            copies[ws.get()] = worksheets_.back().get();
+        }
+        
+        defined_names_ = other.defined_names_;
+        defined_names_.rebind(copies);
+    }
+
+    void index_sheet(worksheet_impl *ws)
+    {
+        sheet_titles_.emplace(fold_case(ws->title_), ws);
+    }
+    
+    // Call before the title of ws changes or ws is removed.
+    void unindex_sheet(const worksheet_impl *ws)
+    {
+        auto matches = sheet_titles_.equal_range(fold_case(ws->title_));
+        
+        for(auto match = matches.first; match != matches.second; ++match)
+        {
+            if(match->second == ws)
+            {
+                sheet_titles_.erase(match);
+                break;
+            }
+        }
+        
+        // Let create_sheet hand out the title again once it's free. A title like Export12 may
+        // have been made from Export with 12 or from Export1 with 2, so both are lowered.
+        auto &title = ws->title_;
+        auto digits = title.find_last_not_of("0123456789") + 1;
+        
+        for(auto split = digits; split < title.size() && title.size() - split < 10; split++)
+        {
+            auto next = next_suffixes_.find(fold_case(title.substr(0, split)));
+            
+            if(title[split] != '0' && next != next_suffixes_.end())
+            {
+                next->second = std::min(next->second, static_cast<std::size_t>(std::stoul(title.substr(split))));
+            }
+        }
+    }
+    
+    // Return the sheet titled title, or one titled the same ignoring case if exact is false.
+    worksheet_impl *find_sheet(const std::string &title, bool exact = true) const
+    {
+        auto folded = fold_case(title);
+        auto matches = sheet_titles_.equal_range(folded);
+        worksheet_impl *found = nullptr;
+        
+        for(auto match = matches.first; match != matches.second; ++match)
+        {
+            if(exact && match->second->title_ != title)
+            {
+                continue;
+            }
+            
+            if(found != nullptr)
+            {
+                // Nothing stops two sheets being given the same title, in which case the first one wins.
+                for(auto &ws : worksheets_)
+                {
+                    if(exact ? ws->title_ == title : fold_case(ws->title_) == folded)
+                    {
+                        return ws.get();
+                    }
+                }
+            }
+            
+            found = match->second;
+        }
+        
+        return found;
+    }
+    
+    // Return the first title made of base and a number from 1 up that no sheet uses yet.
+    std::string next_sheet_title(const std::string &base)
+    {
+        auto &next = next_suffixes_.emplace(fold_case(base), 1).first->second;
+        
+        while(find_sheet(base + std::to_string(next), false) != nullptr)
+        {
+            next++;
+        }
+        
+        return base + std::to_string(next);
+    }
+    
+    void index_relationships()
+    {
+        relationship_ids_.clear();
+        
+        for(std::size_t i = 0; i < relationships_.size(); i++)
+        {
+            relationship_ids_.emplace(relationships_[i].get_id(), i);
+        }
+    }
+
     std::size_t active_sheet_index_;
-    std::vector<worksheet_impl> worksheets_;
+    
+    // Each sheet is separately allocated so that adding, removing or reordering sheets
+    // only moves pointers and never relocates a worksheet_impl or its cells.
+    std::vector<std::unique_ptr<worksheet_impl>> worksheets_;
+    
+    // Sheets by case folded title. Titles are kept up to date by worksheet::set_title and,
+    // since sheets are indexed by pointer, reordering sheets leaves this alone.
+    std::unordered_multimap<std::string, worksheet_impl *> sheet_titles_;
+    
+    // For each case folded base title that create_sheet has numbered, N such that every title
+    // from base1 up to but not including baseN is known to be taken.
+    std::unordered_map<std::string, std::size_t> next_suffixes_;
+    
     std::vector<relationship> relationships_;
+    
+    // Position in relationships_ by id. The first relationship with an id wins.
+    std::unordered_map<std::string, std::size_t> relationship_ids_;
     std::vector<drawing> drawings_;
     
+    // Names defined in the workbook and in each sheet. Names refer to sheets by pointer, so
+    // they're dropped along with a removed sheet and rebound when the sheets are copied.
+    defined_name_index defined_names_;
+    
     document_properties properties_;
     
     bool guess_types_;
     bool data_only_;
+    bool lazy_load_;
+    load_options load_options_;
+    std::size_t calculation_threads_;
+    
+    // Kept from load() while any worksheet is still waiting to be parsed in lazy load mode.
+    // unloaded_sheets_ counts those worksheets so the last one to load can release the rest.
+    std::shared_ptr<zip_file> archive_;
+    std::size_t unloaded_sheets_;
+    std::vector<std::string> shared_strings_;
+    std::vector<std::size_t> style_ids_;
+    
+    // Every distinct style and style component is stored once and referred to by index.
+    // Index 0 of each table is the default, seeded by the constructor.
+    component_table<style> styles_;
     
-    std::vector<style> styles_;
+    component_table<alignment> alignments_;
+    component_table<border> borders_;
+    component_table<fill> fills_;
+    component_table<font> fonts_;
+    component_table<number_format> number_formats_;
+    component_table<protection> protections_;
     
-    std::vector<alignment> alignments_;
-    std::vector<border> borders_;
-    std::vector<fill> fills_;
-    std::vector<font> fonts_;
-    std::vector<number_format> number_formats_;
-    std::vector<protection> protections_;
+    // Compiled number formats by number format index, filled in as they're first used.
+    // The number format table is append-only so entries never go stale.
+    std::vector<std::unique_ptr<number_formatter>> number_formatters_;
     
+    // Dependency graph from the last workbook::calculate, kept so recalculate only has to
+    // evaluate what changed. Dropped whenever sheets are added, removed or reordered.
+    std::unique_ptr<formula_engine> formula_engine_;
 };
 
 } // namespace detail
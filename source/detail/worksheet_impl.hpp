@@ -1,8 +1,18 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <scoped_allocator>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "arena.hpp"
 #include "cell_impl.hpp"
+#include "dimension_index.hpp"
+#include "merged_index.hpp"
+#include "shared_formula.hpp"
 
 namespace xlnt {
 
@@ -10,10 +20,23 @@ class workbook;
 
 namespace detail {
 
+using cell_row = std::unordered_map<column_t, cell_impl, std::hash<column_t>, std::equal_to<column_t>,
+    arena_allocator<std::pair<const column_t, cell_impl>>>;
+
+// The scoped adaptor hands the sheet's arena down to every row map created inside it.
+using cell_map = std::unordered_map<row_t, cell_row, std::hash<row_t>, std::equal_to<row_t>,
+    std::scoped_allocator_adaptor<arena_allocator<std::pair<const row_t, cell_row>>>>;
+
 struct worksheet_impl
 {
     worksheet_impl(workbook *parent_workbook, const std::string &title)
-    : parent_(parent_workbook), title_(title), freeze_panes_("A1"), comment_count_(0)
+    : parent_(parent_workbook),
+      title_(title),
+      freeze_panes_("A1"),
+      arena_(new arena()),
+      cell_map_(cell_map::allocator_type(arena_.get())),
+      comment_count_(0),
+      loaded_(true)
     {
         page_margins_.set_left(0.75);
         page_margins_.set_right(0.75);
@@ -24,49 +47,167 @@ struct worksheet_impl
     }
     
     worksheet_impl(const worksheet_impl &other)
+    : arena_(new arena()),
+      cell_map_(cell_map::allocator_type(arena_.get()))
     {
         *this = other;
     }
     
-    void operator=(const worksheet_impl &other)
+    worksheet_impl(worksheet_impl &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+    
+    worksheet_impl &operator=(const worksheet_impl &other)
     {
+        clear_changed_cells();
         parent_ = other.parent_;
+        row_properties_ = other.row_properties_;
         title_ = other.title_;
         freeze_panes_ = other.freeze_panes_;
         cell_map_ = other.cell_map_;
-        for(auto &row : cell_map_)
-        {
-            for(auto &cell : row.second)
-            {
-                cell.second.parent_ = this;
-            }
-        }
+        highest_row_ = other.highest_row_;
+        reparent_cells();
         relationships_ = other.relationships_;
         page_setup_ = other.page_setup_;
         auto_filter_ = other.auto_filter_;
         page_margins_ = other.page_margins_;
         merged_cells_ = other.merged_cells_;
-        named_ranges_ = other.named_ranges_;
+        shared_formulas_ = other.shared_formulas_;
         comment_count_ = other.comment_count_;
         header_footer_ = other.header_footer_;
+        column_dimensions_ = other.column_dimensions_;
+        row_dimensions_ = other.row_dimensions_;
+        column_widths_ = other.column_widths_;
+        row_heights_ = other.row_heights_;
+        archive_path_ = other.archive_path_;
+        loaded_ = other.loaded_;
+        track_changes_ = false;
+        
+        return *this;
+    }
+    
+    // Moving keeps every cell_impl in its map node, so only the parent pointers need updating.
+    worksheet_impl &operator=(worksheet_impl &&other) noexcept
+    {
+        clear_changed_cells();
+        other.clear_changed_cells();
+        parent_ = other.parent_;
+        row_properties_ = std::move(other.row_properties_);
+        title_ = std::move(other.title_);
+        freeze_panes_ = std::move(other.freeze_panes_);
+        // The map takes the other sheet's allocator, so its arena must come along after
+        // this sheet's old cells have been destroyed.
+        cell_map_ = std::move(other.cell_map_);
+        arena_ = std::move(other.arena_);
+        highest_row_ = other.highest_row_;
+        reparent_cells();
+        relationships_ = std::move(other.relationships_);
+        page_setup_ = std::move(other.page_setup_);
+        auto_filter_ = std::move(other.auto_filter_);
+        page_margins_ = std::move(other.page_margins_);
+        merged_cells_ = std::move(other.merged_cells_);
+        shared_formulas_ = std::move(other.shared_formulas_);
+        comment_count_ = other.comment_count_;
+        header_footer_ = std::move(other.header_footer_);
+        column_dimensions_ = std::move(other.column_dimensions_);
+        row_dimensions_ = std::move(other.row_dimensions_);
+        column_widths_ = std::move(other.column_widths_);
+        row_heights_ = std::move(other.row_heights_);
+        archive_path_ = std::move(other.archive_path_);
+        loaded_ = other.loaded_;
+        track_changes_ = false;
+        
+        return *this;
+    }
+    
+    // Every row added to cell_map_ goes through here so the highest row stays known.
+    cell_row &get_row(row_t row)
+    {
+        highest_row_ = highest_row_ == 0 ? 0 : std::max(highest_row_, row);
+        return cell_map_[row];
+    }
+    
+    // Queue a cell whose value was set so that workbook::recalculate can update the formulas
+    // reading it. Each cell is queued once however often it changes.
+    void value_changed(cell_impl &cell)
+    {
+        if(track_changes_ && !cell.changed_)
+        {
+            cell.changed_ = true;
+            changed_cells_.push_back(&cell);
+        }
+    }
+    
+    // Must be called before any queued cell is erased.
+    void clear_changed_cells()
+    {
+        for(auto cell : changed_cells_)
+        {
+            cell->changed_ = false;
+        }
+        
+        changed_cells_.clear();
+    }
+    
+    void reparent_cells()
+    {
+        for(auto &row : cell_map_)
+        {
+            for(auto &cell : row.second)
+            {
+                cell.second.parent_ = this;
+            }
+        }
     }
     
     workbook *parent_;
     std::unordered_map<row_t, row_properties> row_properties_;
     std::string title_;
     cell_reference freeze_panes_;
-    std::unordered_map<row_t, std::unordered_map<column_t, cell_impl>> cell_map_;
+    
+    // Cells and the row maps holding them are allocated from this arena, which is declared
+    // first so it outlives cell_map_. Dropping the sheet releases its chunks in one pass.
+    std::unique_ptr<arena> arena_;
+    cell_map cell_map_;
+    
+    // The highest row in cell_map_, so appending rows doesn't have to look at every row
+    // already there. 0 means it has to be found again, as after rows have been erased.
+    mutable row_t highest_row_ = 0;
     std::vector<relationship> relationships_;
     page_setup page_setup_;
     range_reference auto_filter_;
     margins page_margins_;
-    std::vector<range_reference> merged_cells_;
-    std::unordered_map<std::string, named_range> named_ranges_;
+    merged_index merged_cells_;
+    
+    // Indexed by the si attribute of <f t="shared">. Cells refer to these by index.
+    std::vector<shared_formula> shared_formulas_;
     std::size_t comment_count_;
     header_footer header_footer_;
     std::unordered_map<column_t, double> column_dimensions_;
     std::unordered_map<row_t, double> row_dimensions_;
+    
+    // Pixel sizes kept in step with the dimensions above for positioning drawings. A column
+    // without a width is 51.85 points wide and a row without a height is 15 points high.
+    dimension_index column_widths_ { dimension_index::points_to_pixels(51.85) };
+    dimension_index row_heights_ { dimension_index::points_to_pixels(15.0) };
+    
+    // Location of this sheet's XML in the source archive and whether it has been parsed yet.
+    // Sheets are only left unloaded by workbook::load when lazy loading is enabled.
+    std::string archive_path_;
+    bool loaded_;
+    
+    // Set by workbook::calculate once the sheet's cells are part of the workbook's dependency
+    // graph. From then on cells whose values are set are queued for workbook::recalculate.
+    // Formula changes and removed cells can't be patched into the graph, so they only ask
+    // for it to be rebuilt.
+    bool track_changes_ = false;
+    bool dependencies_changed_ = false;
+    std::vector<cell_impl *> changed_cells_;
 };
 
+static_assert(std::is_nothrow_move_constructible<cell_impl>::value, "cell_impl must be nothrow movable");
+static_assert(std::is_nothrow_move_constructible<worksheet_impl>::value, "worksheet_impl must be nothrow movable");
+
 } // namespace detail
 } // namespace xlnt
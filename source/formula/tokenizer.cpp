@@ -0,0 +1,407 @@
+#include <cctype>
+#include <cstring>
+
+#include <xlnt/common/exceptions.hpp>
+#include <xlnt/formula/tokenizer.hpp>
+
+namespace {
+
+const char *const error_literals[] = { "#NULL!", "#DIV/0!", "#VALUE!", "#REF!", "#NAME?", "#NUM!", "#N/A", "#GETTING_DATA" };
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool is_word_character(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || static_cast<unsigned char>(c) >= 0x80
+        || c == '_' || c == '.' || c == '$' || c == ':' || c == '!' || c == '\\' || c == '?';
+}
+
+// True if [first, last) could be the mantissa of a number in scientific notation like "1.5".
+bool is_mantissa(const std::string &formula, std::size_t first, std::size_t last)
+{
+    bool has_digit = false;
+
+    for(auto i = first; i < last; i++)
+    {
+        if(is_digit(formula[i]))
+        {
+            has_digit = true;
+        }
+        else if(formula[i] != '.')
+        {
+            return false;
+        }
+    }
+
+    return has_digit;
+}
+
+bool equals_ignore_case(const std::string &formula, std::size_t offset, std::size_t length, const char *value)
+{
+    if(std::strlen(value) != length)
+    {
+        return false;
+    }
+
+    for(std::size_t i = 0; i < length; i++)
+    {
+        if(std::toupper(static_cast<unsigned char>(formula[offset + i])) != value[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace xlnt {
+
+tokenizer::tokenizer(const std::string &formula) : formula_(formula)
+{
+    tokenize();
+}
+
+const std::string &tokenizer::get_formula() const
+{
+    return formula_;
+}
+
+const std::vector<tokenizer::token> &tokenizer::get_tokens() const
+{
+    return tokens_;
+}
+
+std::string tokenizer::get_value(const token &t) const
+{
+    return formula_.substr(t.offset, t.length);
+}
+
+bool tokenizer::equals(const token &t, const char *value) const
+{
+    return std::strlen(value) == t.length && formula_.compare(t.offset, t.length, value) == 0;
+}
+
+void tokenizer::add_token(token_type type, token_subtype subtype, std::size_t offset, std::size_t length)
+{
+    tokens_.push_back({ type, subtype, offset, length });
+}
+
+bool tokenizer::follows_operand() const
+{
+    for(auto t = tokens_.rbegin(); t != tokens_.rend(); ++t)
+    {
+        if(t->type == token_type::whitespace)
+        {
+            continue;
+        }
+
+        return t->type == token_type::operand
+            || t->type == token_type::postfix_operator
+            || t->subtype == token_subtype::close;
+    }
+
+    return false;
+}
+
+std::size_t tokenizer::scan_string(std::size_t offset, char quote) const
+{
+    auto i = offset + 1;
+
+    while(i < formula_.size())
+    {
+        if(formula_[i] == quote)
+        {
+            // A doubled quote is an escaped quote inside the string.
+            if(i + 1 < formula_.size() && formula_[i + 1] == quote)
+            {
+                i += 2;
+                continue;
+            }
+
+            return i + 1;
+        }
+
+        i++;
+    }
+
+    throw formula_syntax_exception(formula_, offset);
+}
+
+std::size_t tokenizer::scan_error(std::size_t offset) const
+{
+    for(auto error : error_literals)
+    {
+        auto length = std::strlen(error);
+
+        if(formula_.compare(offset, length, error) == 0)
+        {
+            return offset + length;
+        }
+    }
+
+    throw formula_syntax_exception(formula_, offset);
+}
+
+std::size_t tokenizer::scan_word(std::size_t offset) const
+{
+    auto i = offset;
+
+    while(i < formula_.size())
+    {
+        auto c = formula_[i];
+
+        if(c == '\'')
+        {
+            i = scan_string(i, '\'');
+        }
+        else if(c == '[')
+        {
+            // Structured and external references may nest brackets, e.g. Table1[[#This Row],[Amount]].
+            std::size_t depth = 0;
+
+            do
+            {
+                if(i == formula_.size())
+                {
+                    throw formula_syntax_exception(formula_, offset);
+                }
+
+                if(formula_[i] == '[')
+                {
+                    depth++;
+                }
+                else if(formula_[i] == ']')
+                {
+                    depth--;
+                }
+
+                i++;
+            } while(depth > 0);
+        }
+        else if(c == '#' && i > offset && formula_[i - 1] == '!')
+        {
+            i = scan_error(i);
+        }
+        else if(is_word_character(c))
+        {
+            i++;
+        }
+        else if((c == '+' || c == '-') && i > offset + 1
+            && (formula_[i - 1] == 'e' || formula_[i - 1] == 'E')
+            && is_mantissa(formula_, offset, i - 1))
+        {
+            i++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+tokenizer::token_subtype tokenizer::classify_word(std::size_t offset, std::size_t length) const
+{
+    if(equals_ignore_case(formula_, offset, length, "TRUE") || equals_ignore_case(formula_, offset, length, "FALSE"))
+    {
+        return token_subtype::logical;
+    }
+
+    auto i = offset;
+    auto end = offset + length;
+    bool has_digit = false;
+
+    while(i < end && is_digit(formula_[i]))
+    {
+        i++;
+        has_digit = true;
+    }
+
+    if(i < end && formula_[i] == '.')
+    {
+        i++;
+
+        while(i < end && is_digit(formula_[i]))
+        {
+            i++;
+            has_digit = true;
+        }
+    }
+
+    if(has_digit && i < end && (formula_[i] == 'e' || formula_[i] == 'E'))
+    {
+        i++;
+
+        if(i < end && (formula_[i] == '+' || formula_[i] == '-'))
+        {
+            i++;
+        }
+
+        has_digit = i < end;
+
+        while(i < end && is_digit(formula_[i]))
+        {
+            i++;
+        }
+    }
+
+    return has_digit && i == end ? token_subtype::number : token_subtype::range;
+}
+
+void tokenizer::tokenize()
+{
+    if(formula_.empty())
+    {
+        return;
+    }
+
+    if(formula_[0] != '=')
+    {
+        add_token(token_type::literal, token_subtype::none, 0, formula_.size());
+        return;
+    }
+
+    tokens_.reserve(formula_.size() / 2 + 1);
+
+    // Innermost open function, parenthesis or array, used to match closing tokens and classify separators.
+    std::vector<token_type> open_groups;
+    std::size_t i = 1;
+
+    while(i < formula_.size())
+    {
+        auto c = formula_[i];
+        auto next = i + 1 < formula_.size() ? formula_[i + 1] : '\0';
+
+        switch(c)
+        {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+        {
+            auto end = i + 1;
+
+            while(end < formula_.size() && std::isspace(static_cast<unsigned char>(formula_[end])))
+            {
+                end++;
+            }
+
+            add_token(token_type::whitespace, token_subtype::none, i, end - i);
+            i = end;
+            break;
+        }
+        case '"':
+        {
+            auto end = scan_string(i, '"');
+            add_token(token_type::operand, token_subtype::text, i, end - i);
+            i = end;
+            break;
+        }
+        case '#':
+        {
+            auto end = scan_error(i);
+            add_token(token_type::operand, token_subtype::error, i, end - i);
+            i = end;
+            break;
+        }
+        case '{':
+        case '(':
+        {
+            auto type = c == '{' ? token_type::array : token_type::parenthesis;
+            open_groups.push_back(type);
+            add_token(type, token_subtype::open, i++, 1);
+            break;
+        }
+        case '}':
+        case ')':
+        {
+            if(open_groups.empty() || (open_groups.back() == token_type::array) != (c == '}'))
+            {
+                throw formula_syntax_exception(formula_, i);
+            }
+
+            add_token(open_groups.back(), token_subtype::close, i++, 1);
+            open_groups.pop_back();
+            break;
+        }
+        case ',':
+            // A comma outside of a function call or array is the union operator, e.g. =SUM((A1,B2)).
+            if(open_groups.empty() || open_groups.back() == token_type::parenthesis)
+            {
+                add_token(token_type::infix_operator, token_subtype::none, i++, 1);
+            }
+            else
+            {
+                add_token(token_type::separator, token_subtype::argument, i++, 1);
+            }
+            break;
+        case ';':
+            if(open_groups.empty() || open_groups.back() != token_type::array)
+            {
+                throw formula_syntax_exception(formula_, i);
+            }
+
+            add_token(token_type::separator, token_subtype::row, i++, 1);
+            break;
+        case '+':
+        case '-':
+            add_token(follows_operand() ? token_type::infix_operator : token_type::prefix_operator, token_subtype::none, i++, 1);
+            break;
+        case '<':
+        case '>':
+        {
+            auto length = (next == '=' || (c == '<' && next == '>')) ? 2 : 1;
+            add_token(token_type::infix_operator, token_subtype::none, i, length);
+            i += length;
+            break;
+        }
+        case '*':
+        case '/':
+        case '^':
+        case '&':
+        case '=':
+        case ':':
+            add_token(token_type::infix_operator, token_subtype::none, i++, 1);
+            break;
+        case '%':
+            add_token(token_type::postfix_operator, token_subtype::none, i++, 1);
+            break;
+        default:
+        {
+            auto end = scan_word(i);
+
+            if(end == i)
+            {
+                throw formula_syntax_exception(formula_, i);
+            }
+
+            if(end < formula_.size() && formula_[end] == '(')
+            {
+                open_groups.push_back(token_type::function);
+                add_token(token_type::function, token_subtype::open, i, end + 1 - i);
+                i = end + 1;
+            }
+            else
+            {
+                add_token(token_type::operand, classify_word(i, end - i), i, end - i);
+                i = end;
+            }
+
+            break;
+        }
+        }
+    }
+
+    if(!open_groups.empty())
+    {
+        throw formula_syntax_exception(formula_, formula_.size());
+    }
+}
+
+} // namespace xlnt
@@ -0,0 +1,352 @@
+#include <cctype>
+
+#include <xlnt/formula/translate.hpp>
+
+namespace {
+
+const column_t max_column = 16384;
+const row_t max_row = 1048576;
+
+enum class reference_kind
+{
+    none,
+    cell,
+    column,
+    row
+};
+
+// Position of the pieces of one side of a reference like "'Sheet 1'!$A1", all relative to the formula string.
+struct reference_part
+{
+    std::size_t reference_first;
+    bool absolute_column;
+    bool absolute_row;
+    column_t column;
+    row_t row;
+};
+
+bool is_letter(char c)
+{
+    return std::isalpha(static_cast<unsigned char>(c)) != 0;
+}
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Return the end of the quoted sheet name starting at first or first itself if it isn't quoted.
+std::size_t skip_quoted(const std::string &formula, std::size_t first, std::size_t last)
+{
+    if(formula[first] != '\'')
+    {
+        return first;
+    }
+
+    auto i = first + 1;
+
+    while(i < last)
+    {
+        if(formula[i] == '\'')
+        {
+            if(i + 1 < last && formula[i + 1] == '\'')
+            {
+                i += 2;
+                continue;
+            }
+
+            return i + 1;
+        }
+
+        i++;
+    }
+
+    return last;
+}
+
+// Return the end of the part starting at first, which is the next ':' outside of a quoted sheet name.
+std::size_t find_part_end(const std::string &formula, std::size_t first, std::size_t last)
+{
+    auto i = skip_quoted(formula, first, last);
+
+    while(i < last && formula[i] != ':')
+    {
+        i++;
+    }
+
+    return i;
+}
+
+reference_kind parse_part(const std::string &formula, std::size_t first, std::size_t last, reference_part &part)
+{
+    part.reference_first = first;
+
+    for(auto i = skip_quoted(formula, first, last); i < last; i++)
+    {
+        if(formula[i] == '!')
+        {
+            part.reference_first = i + 1;
+        }
+    }
+
+    auto i = part.reference_first;
+    part.absolute_column = i < last && formula[i] == '$';
+    i += part.absolute_column ? 1 : 0;
+
+    std::size_t letters = 0;
+    part.column = 0;
+
+    while(i < last && is_letter(formula[i]) && letters < 4)
+    {
+        part.column = part.column * 26 + static_cast<column_t>(std::toupper(static_cast<unsigned char>(formula[i])) - 'A' + 1);
+        letters++;
+        i++;
+    }
+
+    part.absolute_row = false;
+
+    if(letters == 0)
+    {
+        // A lone "$" before digits anchors the row, e.g. "$3" in "$3:$5".
+        part.absolute_row = part.absolute_column;
+        part.absolute_column = false;
+    }
+    else if(i < last && formula[i] == '$')
+    {
+        part.absolute_row = true;
+        i++;
+    }
+
+    std::size_t digits = 0;
+    part.row = 0;
+
+    while(i < last && is_digit(formula[i]) && digits < 8)
+    {
+        part.row = part.row * 10 + static_cast<row_t>(formula[i] - '0');
+        digits++;
+        i++;
+    }
+
+    if(i != last || letters > 3 || part.column > max_column || part.row > max_row)
+    {
+        return reference_kind::none;
+    }
+
+    if(letters > 0 && digits > 0)
+    {
+        return part.row > 0 ? reference_kind::cell : reference_kind::none;
+    }
+
+    if(letters > 0)
+    {
+        return part.absolute_row ? reference_kind::none : reference_kind::column;
+    }
+
+    return digits > 0 && part.row > 0 ? reference_kind::row : reference_kind::none;
+}
+
+bool shift(std::uint32_t value, int delta, std::uint32_t maximum, std::uint32_t &result)
+{
+    auto shifted = static_cast<long long>(value) + delta;
+
+    if(shifted < 1 || shifted > maximum)
+    {
+        return false;
+    }
+
+    result = static_cast<std::uint32_t>(shifted);
+    return true;
+}
+
+// Append the reference in formula[first, last) to result with relative rows and columns shifted.
+void append_translated_range(const std::string &formula, std::size_t first, std::size_t last,
+    int row_delta, int col_delta, std::string &result)
+{
+    auto kind = reference_kind::none;
+    std::size_t part_count = 0;
+    reference_part part;
+
+    // First pass: only rewrite the token if every part is the same kind of reference.
+    for(auto part_first = first; part_first <= last; part_count++)
+    {
+        auto part_last = find_part_end(formula, part_first, last);
+        auto part_kind = parse_part(formula, part_first, part_last, part);
+
+        if(part_kind == reference_kind::none || (part_count > 0 && part_kind != kind))
+        {
+            kind = reference_kind::none;
+            break;
+        }
+
+        kind = part_kind;
+        part_first = part_last + 1;
+    }
+
+    // A lone column or row like "ABC" or "12" is a defined name or a number, not a reference.
+    if(kind == reference_kind::none || (kind != reference_kind::cell && part_count < 2))
+    {
+        result.append(formula, first, last - first);
+        return;
+    }
+
+    auto start = result.size();
+
+    for(auto part_first = first; part_first <= last;)
+    {
+        auto part_last = find_part_end(formula, part_first, last);
+        parse_part(formula, part_first, part_last, part);
+
+        if(part_first != first)
+        {
+            result.push_back(':');
+        }
+
+        result.append(formula, part_first, part.reference_first - part_first);
+
+        if(kind != reference_kind::row)
+        {
+            auto column = part.column;
+
+            if(!part.absolute_column && !shift(part.column, col_delta, max_column, column))
+            {
+                result.resize(start);
+                parse_part(formula, first, find_part_end(formula, first, last), part);
+                result.append(formula, first, part.reference_first - first);
+                result.append("#REF!");
+                return;
+            }
+
+            if(part.absolute_column)
+            {
+                result.push_back('$');
+            }
+
+            result.append(xlnt::cell_reference::column_string_from_index(column));
+        }
+
+        if(kind != reference_kind::column)
+        {
+            auto row = part.row;
+
+            if(!part.absolute_row && !shift(part.row, row_delta, max_row, row))
+            {
+                result.resize(start);
+                parse_part(formula, first, find_part_end(formula, first, last), part);
+                result.append(formula, first, part.reference_first - first);
+                result.append("#REF!");
+                return;
+            }
+
+            if(part.absolute_row)
+            {
+                result.push_back('$');
+            }
+
+            result.append(std::to_string(row));
+        }
+
+        part_first = part_last + 1;
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+
+translator::translator(const std::string &formula, const cell_reference &origin)
+    : tokenizer_(formula),
+      origin_(origin)
+{
+}
+
+const std::vector<tokenizer::token> &translator::get_tokens() const
+{
+    return tokenizer_.get_tokens();
+}
+
+std::string translator::translate_formula(const cell_reference &destination) const
+{
+    std::string result;
+    result.reserve(tokenizer_.get_formula().size());
+    translate_formula(destination, result);
+
+    return result;
+}
+
+void translator::translate_formula(const cell_reference &destination, std::string &result) const
+{
+    auto &formula = tokenizer_.get_formula();
+    auto row_delta = static_cast<int>(destination.get_row()) - static_cast<int>(origin_.get_row());
+    auto col_delta = static_cast<int>(destination.get_column_index()) - static_cast<int>(origin_.get_column_index());
+    std::size_t copied = 0;
+
+    for(auto &token : tokenizer_.get_tokens())
+    {
+        if(token.type != tokenizer::token_type::operand || token.subtype != tokenizer::token_subtype::range)
+        {
+            continue;
+        }
+
+        result.append(formula, copied, token.offset - copied);
+        append_translated_range(formula, token.offset, token.offset + token.length, row_delta, col_delta, result);
+        copied = token.offset + token.length;
+    }
+
+    result.append(formula, copied, formula.size() - copied);
+}
+
+std::string translator::translate_row(const std::string &row_str, int row_delta)
+{
+    reference_part part;
+
+    if(parse_part(row_str, 0, row_str.size(), part) != reference_kind::row || part.absolute_row)
+    {
+        return row_str;
+    }
+
+    row_t row = 0;
+    return shift(part.row, row_delta, max_row, row) ? std::to_string(row) : "#REF!";
+}
+
+std::string translator::translate_col(const std::string &col_str, int col_delta)
+{
+    reference_part part;
+
+    if(parse_part(col_str, 0, col_str.size(), part) != reference_kind::column || part.absolute_column)
+    {
+        return col_str;
+    }
+
+    column_t column = 0;
+    return shift(part.column, col_delta, max_column, column) ? cell_reference::column_string_from_index(column) : "#REF!";
+}
+
+std::pair<std::string, std::string> translator::strip_ws_name(const std::string &range_str)
+{
+    auto bang = std::string::npos;
+
+    for(auto i = skip_quoted(range_str, 0, range_str.size()); i < range_str.size(); i++)
+    {
+        if(range_str[i] == '!')
+        {
+            bang = i;
+        }
+    }
+
+    if(bang == std::string::npos)
+    {
+        return { "", range_str };
+    }
+
+    return { range_str.substr(0, bang + 1), range_str.substr(bang + 1) };
+}
+
+std::string translator::translate_range(const std::string &range_str, int row_delta, int col_delta)
+{
+    std::string result;
+    append_translated_range(range_str, 0, range_str.size(), row_delta, col_delta, result);
+
+    return result;
+}
+
+} // namespace xlnt
@@ -1,4 +1,5 @@
 #include <xlnt/reader/excel_reader.hpp>
+#include <xlnt/reader/load_options.hpp>
 #include <xlnt/workbook/workbook.hpp>
 
 namespace {
@@ -63,5 +64,27 @@ xlnt::workbook load_workbook(const std::vector<std::uint8_t> &bytes, bool guess_
     
     return wb;
 }
+
+workbook load_workbook(const std::string &filename, const load_options &options, bool guess_types, bool data_only)
+{
+    workbook wb;
+    
+    wb.set_guess_types(guess_types);
+    wb.set_data_only(data_only);
+    wb.load(filename, options);
+    
+    return wb;
+}
+
+workbook load_workbook(const std::vector<std::uint8_t> &bytes, const load_options &options, bool guess_types, bool data_only)
+{
+    workbook wb;
+    
+    wb.set_guess_types(guess_types);
+    wb.set_data_only(data_only);
+    wb.load(bytes, options);
+    
+    return wb;
+}
     
 } // namespace xlnt
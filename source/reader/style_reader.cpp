@@ -0,0 +1,415 @@
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/reader/style_reader.hpp>
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/styles/style.hpp>
+#include <xlnt/workbook/workbook.hpp>
+
+#include "detail/include_pugixml.hpp"
+
+namespace {
+
+// Boolean properties are written either as bare elements like <b/> or with an explicit val.
+bool is_true(const pugi::xml_node &node)
+{
+    return node != nullptr && (node.attribute("val") == nullptr || node.attribute("val").as_bool());
+}
+
+// Only indexed colors can be represented by xlnt::color; theme and rgb colors keep the default.
+xlnt::color read_color(const pugi::xml_node &color_node, xlnt::color default_color)
+{
+    if(color_node == nullptr || color_node.attribute("indexed") == nullptr)
+    {
+        return default_color;
+    }
+    
+    return xlnt::color(color_node.attribute("indexed").as_int());
+}
+
+xlnt::border_style border_style_from_string(const std::string &style)
+{
+    static const std::unordered_map<std::string, xlnt::border_style> styles =
+    {
+        { "none", xlnt::border_style::none },
+        { "dashDot", xlnt::border_style::dashdot },
+        { "dashDotDot", xlnt::border_style::dashdotdot },
+        { "dashed", xlnt::border_style::dashed },
+        { "dotted", xlnt::border_style::dotted },
+        { "double", xlnt::border_style::double_ },
+        { "hair", xlnt::border_style::hair },
+        { "medium", xlnt::border_style::medium },
+        { "mediumDashDot", xlnt::border_style::mediumdashdot },
+        { "mediumDashDotDot", xlnt::border_style::mediumdashdotdot },
+        { "mediumDashed", xlnt::border_style::mediumdashed },
+        { "slantDashDot", xlnt::border_style::slantdashdot },
+        { "thick", xlnt::border_style::thick },
+        { "thin", xlnt::border_style::thin }
+    };
+    
+    auto match = styles.find(style);
+    return match == styles.end() ? xlnt::border_style::none : match->second;
+}
+
+xlnt::fill::type pattern_type_from_string(const std::string &type)
+{
+    static const std::unordered_map<std::string, xlnt::fill::type> types =
+    {
+        { "none", xlnt::fill::type::none },
+        { "solid", xlnt::fill::type::solid },
+        { "darkDown", xlnt::fill::type::pattern_darkdown },
+        { "darkGray", xlnt::fill::type::pattern_darkgray },
+        { "darkGrid", xlnt::fill::type::pattern_darkgrid },
+        { "darkHorizontal", xlnt::fill::type::pattern_darkhorizontal },
+        { "darkTrellis", xlnt::fill::type::pattern_darktrellis },
+        { "darkUp", xlnt::fill::type::pattern_darkup },
+        { "darkVertical", xlnt::fill::type::pattern_darkvertical },
+        { "gray0625", xlnt::fill::type::pattern_gray0625 },
+        { "gray125", xlnt::fill::type::pattern_gray125 },
+        { "lightDown", xlnt::fill::type::pattern_lightdown },
+        { "lightGray", xlnt::fill::type::pattern_lightgray },
+        { "lightGrid", xlnt::fill::type::pattern_lightgrid },
+        { "lightHorizontal", xlnt::fill::type::pattern_lighthorizontal },
+        { "lightTrellis", xlnt::fill::type::pattern_lighttrellis },
+        { "lightUp", xlnt::fill::type::pattern_lightup },
+        { "lightVertical", xlnt::fill::type::pattern_lightvertical },
+        { "mediumGray", xlnt::fill::type::pattern_mediumgray }
+    };
+    
+    auto match = types.find(type);
+    return match == types.end() ? xlnt::fill::type::none : match->second;
+}
+
+std::unordered_map<int, std::string> read_number_formats(const pugi::xml_node &num_fmts_node)
+{
+    std::unordered_map<int, std::string> number_formats;
+    
+    for(auto num_fmt_node : num_fmts_node.children("numFmt"))
+    {
+        number_formats[num_fmt_node.attribute("numFmtId").as_int()] = num_fmt_node.attribute("formatCode").as_string();
+    }
+    
+    return number_formats;
+}
+
+xlnt::number_format read_number_format(int number_format_id, const std::unordered_map<int, std::string> &custom_number_formats)
+{
+    auto builtin = xlnt::number_format::builtin_formats().find(number_format_id);
+    
+    if(builtin != xlnt::number_format::builtin_formats().end())
+    {
+        return xlnt::number_format(builtin->second);
+    }
+    
+    auto match = custom_number_formats.find(number_format_id);
+    
+    if(match != custom_number_formats.end())
+    {
+        return xlnt::number_format(match->second);
+    }
+    
+    return xlnt::number_format();
+}
+
+xlnt::font read_font(const pugi::xml_node &font_node)
+{
+    xlnt::font result;
+    
+    if(font_node.child("sz") != nullptr)
+    {
+        result.set_size(font_node.child("sz").attribute("val").as_int());
+    }
+    
+    if(font_node.child("name") != nullptr)
+    {
+        result.set_name(font_node.child("name").attribute("val").as_string());
+    }
+    
+    result.set_bold(is_true(font_node.child("b")));
+    result.set_italic(is_true(font_node.child("i")));
+    result.set_strikethrough(is_true(font_node.child("strike")));
+    result.set_color(read_color(font_node.child("color"), result.get_color()));
+    
+    auto underline_node = font_node.child("u");
+    
+    if(underline_node != nullptr)
+    {
+        std::string underline = underline_node.attribute("val").as_string("single");
+        
+        if(underline == "double")
+        {
+            result.set_underline(xlnt::font::underline::double_);
+        }
+        else if(underline == "doubleAccounting")
+        {
+            result.set_underline(xlnt::font::underline::double_accounting);
+        }
+        else if(underline == "singleAccounting")
+        {
+            result.set_underline(xlnt::font::underline::single_accounting);
+        }
+        else if(underline != "none")
+        {
+            result.set_underline(xlnt::font::underline::single);
+        }
+    }
+    
+    std::string vertical_alignment = font_node.child("vertAlign").attribute("val").as_string();
+    result.set_superscript(vertical_alignment == "superscript");
+    result.set_subscript(vertical_alignment == "subscript");
+    
+    return result;
+}
+
+xlnt::fill read_fill(const pugi::xml_node &fill_node)
+{
+    xlnt::fill result;
+    
+    auto pattern_fill_node = fill_node.child("patternFill");
+    
+    if(pattern_fill_node != nullptr)
+    {
+        result.type_ = pattern_type_from_string(pattern_fill_node.attribute("patternType").as_string("none"));
+        result.start_color = read_color(pattern_fill_node.child("fgColor"), result.start_color);
+        result.end_color = read_color(pattern_fill_node.child("bgColor"), result.end_color);
+        
+        return result;
+    }
+    
+    auto gradient_fill_node = fill_node.child("gradientFill");
+    
+    if(gradient_fill_node != nullptr)
+    {
+        std::string type = gradient_fill_node.attribute("type").as_string("linear");
+        result.type_ = type == "path" ? xlnt::fill::type::gradient_path : xlnt::fill::type::gradient_linear;
+        result.rotation = gradient_fill_node.attribute("degree").as_int();
+        
+        pugi::xml_node first_stop, last_stop;
+        
+        for(auto stop_node : gradient_fill_node.children("stop"))
+        {
+            if(first_stop == nullptr)
+            {
+                first_stop = stop_node;
+            }
+            
+            last_stop = stop_node;
+        }
+        
+        result.start_color = read_color(first_stop.child("color"), result.start_color);
+        result.end_color = read_color(last_stop.child("color"), result.end_color);
+    }
+    
+    return result;
+}
+
+// Sides without a style draw nothing so they are left unset, keeping an empty border equal to the default.
+xlnt::optional<xlnt::side> read_side(const pugi::xml_node &side_node)
+{
+    xlnt::optional<xlnt::side> result;
+    
+    if(side_node != nullptr && side_node.attribute("style") != nullptr)
+    {
+        result.initialized = true;
+        result.value = xlnt::side(border_style_from_string(side_node.attribute("style").as_string()), read_color(side_node.child("color"), xlnt::color::black));
+    }
+    
+    return result;
+}
+
+xlnt::border read_border(const pugi::xml_node &border_node)
+{
+    xlnt::border result;
+    
+    result.start = read_side(border_node.child("start"));
+    result.end = read_side(border_node.child("end"));
+    result.left = read_side(border_node.child("left"));
+    result.right = read_side(border_node.child("right"));
+    result.top = read_side(border_node.child("top"));
+    result.bottom = read_side(border_node.child("bottom"));
+    result.diagonal = read_side(border_node.child("diagonal"));
+    result.vertical = read_side(border_node.child("vertical"));
+    result.horizontal = read_side(border_node.child("horizontal"));
+    
+    result.outline = border_node.attribute("outline").as_bool();
+    result.diagonal_up = border_node.attribute("diagonalUp").as_bool();
+    result.diagonal_down = border_node.attribute("diagonalDown").as_bool();
+    
+    if(result.diagonal_up && result.diagonal_down)
+    {
+        result.diagonal_direction_ = xlnt::diagonal_direction::both;
+    }
+    else if(result.diagonal_up)
+    {
+        result.diagonal_direction_ = xlnt::diagonal_direction::up;
+    }
+    else if(result.diagonal_down)
+    {
+        result.diagonal_direction_ = xlnt::diagonal_direction::down;
+    }
+    
+    return result;
+}
+
+xlnt::alignment read_alignment(const pugi::xml_node &alignment_node)
+{
+    xlnt::alignment result;
+    
+    std::string horizontal = alignment_node.attribute("horizontal").as_string();
+    
+    if(horizontal == "left")
+    {
+        result.set_horizontal(xlnt::alignment::horizontal_alignment::left);
+    }
+    else if(horizontal == "right")
+    {
+        result.set_horizontal(xlnt::alignment::horizontal_alignment::right);
+    }
+    else if(horizontal == "center")
+    {
+        result.set_horizontal(xlnt::alignment::horizontal_alignment::center);
+    }
+    else if(horizontal == "centerContinuous")
+    {
+        result.set_horizontal(xlnt::alignment::horizontal_alignment::center_continuous);
+    }
+    else if(horizontal == "justify")
+    {
+        result.set_horizontal(xlnt::alignment::horizontal_alignment::justify);
+    }
+    
+    std::string vertical = alignment_node.attribute("vertical").as_string();
+    
+    if(vertical == "top")
+    {
+        result.set_vertical(xlnt::alignment::vertical_alignment::top);
+    }
+    else if(vertical == "center")
+    {
+        result.set_vertical(xlnt::alignment::vertical_alignment::center);
+    }
+    else if(vertical == "justify")
+    {
+        result.set_vertical(xlnt::alignment::vertical_alignment::justify);
+    }
+    
+    result.set_text_rotation(alignment_node.attribute("textRotation").as_int());
+    result.set_wrap_text(alignment_node.attribute("wrapText").as_bool());
+    result.set_shrink_to_fit(alignment_node.attribute("shrinkToFit").as_bool());
+    result.set_indent(alignment_node.attribute("indent").as_int());
+    
+    return result;
+}
+
+xlnt::protection read_protection(const pugi::xml_node &protection_node)
+{
+    xlnt::protection result;
+    
+    if(protection_node.attribute("locked") != nullptr)
+    {
+        result.set_locked(protection_node.attribute("locked").as_bool());
+    }
+    
+    if(protection_node.attribute("hidden") != nullptr)
+    {
+        result.set_hidden(protection_node.attribute("hidden").as_bool());
+    }
+    
+    return result;
+}
+
+template<typename T>
+const T &component_at(const std::vector<T> &components, std::size_t index)
+{
+    if(index >= components.size())
+    {
+        throw std::runtime_error("style refers to a missing component");
+    }
+    
+    return components[index];
+}
+
+} // namespace
+
+namespace xlnt {
+
+style_reader::style_reader(workbook &wb) : wb_(wb)
+{
+}
+
+void style_reader::read_styles(const std::string &xml_string)
+{
+    pugi::xml_document doc;
+    doc.load(xml_string.c_str());
+    auto stylesheet_node = doc.child("styleSheet");
+    
+    auto custom_number_formats = read_number_formats(stylesheet_node.child("numFmts"));
+    
+    std::vector<font> fonts;
+    
+    for(auto font_node : stylesheet_node.child("fonts").children("font"))
+    {
+        fonts.push_back(read_font(font_node));
+        wb_.add_font(fonts.back());
+    }
+    
+    std::vector<fill> fills;
+    
+    for(auto fill_node : stylesheet_node.child("fills").children("fill"))
+    {
+        fills.push_back(read_fill(fill_node));
+        wb_.add_fill(fills.back());
+    }
+    
+    std::vector<border> borders;
+    
+    for(auto border_node : stylesheet_node.child("borders").children("border"))
+    {
+        borders.push_back(read_border(border_node));
+        wb_.add_border(borders.back());
+    }
+    
+    style_ids_.clear();
+    
+    for(auto xf_node : stylesheet_node.child("cellXfs").children("xf"))
+    {
+        style xf;
+        
+        xf.set_number_format(read_number_format(xf_node.attribute("numFmtId").as_int(), custom_number_formats));
+        
+        if(!fonts.empty())
+        {
+            xf.set_font(component_at(fonts, xf_node.attribute("fontId").as_uint()));
+        }
+        
+        if(!fills.empty())
+        {
+            xf.set_fill(component_at(fills, xf_node.attribute("fillId").as_uint()));
+        }
+        
+        if(!borders.empty())
+        {
+            xf.set_border(component_at(borders, xf_node.attribute("borderId").as_uint()));
+        }
+        
+        xf.set_alignment(read_alignment(xf_node.child("alignment")));
+        xf.set_protection(read_protection(xf_node.child("protection")));
+        xf.set_quote_prefix(xf_node.attribute("quotePrefix").as_bool());
+        xf.set_pivot_button(xf_node.attribute("pivotButton").as_bool());
+        
+        style_ids_.push_back(wb_.add_style(xf));
+    }
+}
+
+const std::vector<std::size_t> &style_reader::get_style_ids() const
+{
+    return style_ids_;
+}
+
+} // namespace xlnt
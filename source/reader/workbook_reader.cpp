@@ -132,12 +132,14 @@ std::vector<relationship> read_relationships(zip_file &archive, const std::strin
         std::string type = relationship.attribute("Type").as_string();
         std::string target = relationship.attribute("Target").as_string();
         
-        if(target[0] != '/' && target.substr(0, 2) != "..")
+        bool external = std::string(relationship.attribute("TargetMode").as_string()) == "External";
+        
+        if(!external && target[0] != '/' && target.substr(0, 2) != "..")
         {
             target = dirname + "/" + target;
         }
         
-        if(target[0] == '/')
+        if(!external && target[0] == '/')
         {
             target = target.substr(1);
         }
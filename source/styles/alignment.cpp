@@ -0,0 +1,29 @@
+#include <xlnt/styles/alignment.hpp>
+
+#include "detail/hash_combine.hpp"
+
+namespace xlnt {
+
+bool alignment::operator==(const alignment &other) const
+{
+    return horizontal_ == other.horizontal_
+        && vertical_ == other.vertical_
+        && text_rotation_ == other.text_rotation_
+        && wrap_text_ == other.wrap_text_
+        && shrink_to_fit_ == other.shrink_to_fit_
+        && indent_ == other.indent_;
+}
+
+std::size_t alignment::hash() const
+{
+    std::size_t seed = 0;
+    detail::hash_combine(seed, static_cast<int>(horizontal_));
+    detail::hash_combine(seed, static_cast<int>(vertical_));
+    detail::hash_combine(seed, text_rotation_);
+    detail::hash_combine(seed, indent_);
+    detail::hash_combine(seed, static_cast<int>(wrap_text_) << 1 | static_cast<int>(shrink_to_fit_));
+    
+    return seed;
+}
+
+} // namespace xlnt
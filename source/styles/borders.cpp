@@ -1,11 +1,62 @@
-
 #include <xlnt/styles/border.hpp>
 
+#include "detail/hash_combine.hpp"
+
+namespace {
+
+void combine_side(std::size_t &seed, const xlnt::optional<xlnt::side> &side)
+{
+    xlnt::detail::hash_combine(seed, side.initialized ? side.value.hash() : std::size_t(0));
+}
+
+} // namespace
+
 namespace xlnt {
 
 side::side(border_style style, color c) : style_(style), color_(c)
 {
     
 }
+
+std::size_t side::hash() const
+{
+    std::size_t seed = 0;
+    detail::hash_combine(seed, static_cast<int>(style_));
+    detail::hash_combine(seed, color_.hash());
+    
+    return seed;
+}
+
+bool border::operator==(const border &other) const
+{
+    return start == other.start
+        && end == other.end
+        && left == other.left
+        && right == other.right
+        && top == other.top
+        && bottom == other.bottom
+        && diagonal == other.diagonal
+        && vertical == other.vertical
+        && horizontal == other.horizontal
+        && outline == other.outline
+        && diagonal_up == other.diagonal_up
+        && diagonal_down == other.diagonal_down
+        && diagonal_direction_ == other.diagonal_direction_;
+}
+
+std::size_t border::hash() const
+{
+    std::size_t seed = 0;
+    
+    for(auto side : { &start, &end, &left, &right, &top, &bottom, &diagonal, &vertical, &horizontal })
+    {
+        combine_side(seed, *side);
+    }
+    
+    detail::hash_combine(seed, static_cast<int>(outline) << 2 | static_cast<int>(diagonal_up) << 1 | static_cast<int>(diagonal_down));
+    detail::hash_combine(seed, static_cast<int>(diagonal_direction_));
+    
+    return seed;
+}
     
 } // namespace xlnt
@@ -0,0 +1,26 @@
+#include <xlnt/styles/fill.hpp>
+
+#include "detail/hash_combine.hpp"
+
+namespace xlnt {
+
+bool fill::operator==(const fill &other) const
+{
+    return type_ == other.type_
+        && rotation == other.rotation
+        && start_color == other.start_color
+        && end_color == other.end_color;
+}
+
+std::size_t fill::hash() const
+{
+    std::size_t seed = 0;
+    detail::hash_combine(seed, static_cast<int>(type_));
+    detail::hash_combine(seed, rotation);
+    detail::hash_combine(seed, start_color.hash());
+    detail::hash_combine(seed, end_color.hash());
+    
+    return seed;
+}
+
+} // namespace xlnt
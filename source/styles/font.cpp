@@ -0,0 +1,38 @@
+#include <xlnt/styles/font.hpp>
+
+#include "detail/hash_combine.hpp"
+
+namespace xlnt {
+
+bool font::operator==(const font &other) const
+{
+    return name_ == other.name_
+        && size_ == other.size_
+        && bold_ == other.bold_
+        && italic_ == other.italic_
+        && superscript_ == other.superscript_
+        && subscript_ == other.subscript_
+        && underline_ == other.underline_
+        && strikethrough_ == other.strikethrough_
+        && color_ == other.color_;
+}
+
+std::size_t font::hash() const
+{
+    std::size_t seed = 0;
+    detail::hash_combine(seed, name_);
+    detail::hash_combine(seed, size_);
+    detail::hash_combine(seed, static_cast<int>(underline_));
+    detail::hash_combine(seed, color_.hash());
+    
+    std::size_t flags = bold_;
+    flags = flags << 1 | italic_;
+    flags = flags << 1 | superscript_;
+    flags = flags << 1 | subscript_;
+    flags = flags << 1 | strikethrough_;
+    detail::hash_combine(seed, flags);
+    
+    return seed;
+}
+
+} // namespace xlnt
@@ -1,5 +1,7 @@
 #include <xlnt/styles/protection.hpp>
 
+#include "detail/hash_combine.hpp"
+
 namespace xlnt {
 
 protection::protection() : protection(type::unprotected)
@@ -12,4 +14,13 @@ protection::protection(type t) : locked_(t), hidden_(type::inherit)
     
 }
 
+std::size_t protection::hash() const
+{
+    std::size_t seed = 0;
+    detail::hash_combine(seed, static_cast<int>(locked_));
+    detail::hash_combine(seed, static_cast<int>(hidden_));
+    
+    return seed;
+}
+
 } // namespace xlnt
@@ -1,49 +1,51 @@
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/styles/style.hpp>
 
-#include "font.hpp"
-#include "number_format.hpp"
-#include "protection.hpp"
-
-namespace {
-
-template <class T>
-void hash_combine(std::size_t& seed, const T& v)
-{
-    std::hash<T> hasher;
-    seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-}
-    
-}
+#include "detail/hash_combine.hpp"
 
 namespace xlnt {
 
 style::style()
+    : style_index_(0),
+      alignment_index_(0),
+      border_index_(0),
+      fill_index_(0),
+      font_index_(0),
+      number_format_index_(0),
+      protection_index_(0),
+      pivot_button_(false),
+      quote_prefix_(false)
 {
 }
 
+// Styles live in one workbook table each and refer to components by their index in
+// that workbook's component tables, so comparing indices is enough.
 std::size_t style::hash() const
 {
-    /*
-    std::size_t seed = 100;
-    std::hash<std::string> string_hash;
-    auto font_ = get_font();
-    hash_combine(seed, string_hash(font_.name_));
-    hash_combine(seed, font_.size_);
-    hash_combine(seed, static_cast<std::size_t>(font_.underline_));
-    std::size_t bools = font_.bold_;
-    bools = bools << 1 & font_.italic_;
-    bools = bools << 1 & font_.strikethrough_;
-    bools = bools << 1 & font_.superscript_;
-    bools = bools << 1 & font_.subscript_;
-    hash_combine(seed, bools);
-     */
-    std::size_t seed = 100;
-    hash_combine(seed, number_format_.hash());
+    std::size_t seed = 0;
+    detail::hash_combine(seed, alignment_index_);
+    detail::hash_combine(seed, border_index_);
+    detail::hash_combine(seed, fill_index_);
+    detail::hash_combine(seed, font_index_);
+    detail::hash_combine(seed, number_format_index_);
+    detail::hash_combine(seed, protection_index_);
+    detail::hash_combine(seed, static_cast<int>(pivot_button_) << 1 | static_cast<int>(quote_prefix_));
     
     return seed;
 }
 
+bool style::operator==(const style &other) const
+{
+    return alignment_index_ == other.alignment_index_
+        && border_index_ == other.border_index_
+        && fill_index_ == other.fill_index_
+        && font_index_ == other.font_index_
+        && number_format_index_ == other.number_format_index_
+        && protection_index_ == other.protection_index_
+        && pivot_button_ == other.pivot_button_
+        && quote_prefix_ == other.quote_prefix_;
+}
+
 const number_format style::get_number_format() const
 {
     return number_format_;
@@ -84,4 +86,44 @@ bool style::quote_prefix() const
     return quote_prefix_;
 }
 
+void style::set_alignment(const alignment &alignment_)
+{
+    this->alignment_ = alignment_;
+}
+
+void style::set_border(const border &border_)
+{
+    this->border_ = border_;
+}
+
+void style::set_fill(const fill &fill_)
+{
+    this->fill_ = fill_;
+}
+
+void style::set_font(const font &font_)
+{
+    this->font_ = font_;
+}
+
+void style::set_number_format(const number_format &number_format_)
+{
+    this->number_format_ = number_format_;
+}
+
+void style::set_protection(const protection &protection_)
+{
+    this->protection_ = protection_;
+}
+
+void style::set_pivot_button(bool pivot)
+{
+    pivot_button_ = pivot;
+}
+
+void style::set_quote_prefix(bool quote)
+{
+    quote_prefix_ = quote;
+}
+
 } // namespace xlnt
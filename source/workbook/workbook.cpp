@@ -12,7 +12,9 @@
 #include <xlnt/common/relationship.hpp>
 #include <xlnt/common/zip_file.hpp>
 #include <xlnt/drawing/drawing.hpp>
+#include <xlnt/reader/load_options.hpp>
 #include <xlnt/reader/shared_strings_reader.hpp>
+#include <xlnt/reader/style_reader.hpp>
 #include <xlnt/reader/workbook_reader.hpp>
 #include <xlnt/reader/worksheet_reader.hpp>
 #include <xlnt/styles/alignment.hpp>
@@ -32,6 +34,7 @@
 #include <xlnt/writer/workbook_writer.hpp>
 
 #include "detail/cell_impl.hpp"
+#include "detail/formula_engine.hpp"
 #include "detail/include_pugixml.hpp"
 #include "detail/workbook_impl.hpp"
 #include "detail/worksheet_impl.hpp"
@@ -58,6 +61,31 @@ static std::string create_temporary_filename()
 #endif
 }
 
+std::vector<xlnt::relationship> read_worksheet_relationships(xlnt::zip_file &archive, const std::string &worksheet_path)
+{
+    auto separator_index = worksheet_path.find_last_of('/');
+    auto rels_path = worksheet_path.substr(0, separator_index) + "/_rels/" + worksheet_path.substr(separator_index + 1) + ".rels";
+    
+    if(!archive.has_file(rels_path))
+    {
+        return {};
+    }
+    
+    return xlnt::read_relationships(archive, worksheet_path);
+}
+
+// Called when a lazily loaded sheet is parsed or removed. The archive and lookup tables are
+// released once no sheet is left waiting for them.
+void release_unloaded_sheet(xlnt::detail::workbook_impl &impl)
+{
+    if(--impl.unloaded_sheets_ == 0)
+    {
+        impl.archive_.reset();
+        impl.shared_strings_.clear();
+        impl.style_ids_.clear();
+    }
+}
+
 template <class T>
 void hash_combine(std::size_t& seed, const T& v)
 {
@@ -70,8 +98,21 @@ void hash_combine(std::size_t& seed, const T& v)
 namespace xlnt {
 namespace detail {
 
-workbook_impl::workbook_impl() : active_sheet_index_(0), guess_types_(false), data_only_(false)
+workbook_impl::workbook_impl() : active_sheet_index_(0), guess_types_(false), data_only_(false), lazy_load_(false), calculation_threads_(1), unloaded_sheets_(0)
 {
+    alignments_.intern(alignment());
+    borders_.intern(border());
+    fills_.intern(fill());
+    
+    // Spreadsheet applications reserve the second fill for the gray125 pattern.
+    fill gray125;
+    gray125.type_ = fill::type::pattern_gray125;
+    fills_.intern(gray125);
+    
+    fonts_.intern(font());
+    number_formats_.intern(number_format());
+    protections_.intern(protection());
+    styles_.intern(style());
 }
 
 } // namespace detail
@@ -152,58 +193,64 @@ bool workbook::const_iterator::operator==(const const_iterator &comparand) const
     
 worksheet workbook::get_sheet_by_name(const std::string &name)
 {
-    for(auto &impl : d_->worksheets_)
+    auto match = d_->find_sheet(name);
+
+    if(match == nullptr)
     {
-        if(impl.title_ == name)
-        {
-            return worksheet(&impl);
-        }
+        return worksheet();
     }
 
-    return worksheet();
+    load_sheet(*match);
+    return worksheet(match);
 }
 
 worksheet workbook::get_sheet_by_index(std::size_t index)
 {
-    return worksheet(&d_->worksheets_[index]);
+    load_sheet(*d_->worksheets_.at(index));
+    return worksheet(d_->worksheets_[index].get());
 }
     
 const worksheet workbook::get_sheet_by_index(std::size_t index) const
 {
-    return worksheet(&d_->worksheets_.at(index));
+    load_sheet(*d_->worksheets_.at(index));
+    return worksheet(d_->worksheets_.at(index).get());
 }
 
 worksheet workbook::get_active_sheet()
 {
-    return worksheet(&d_->worksheets_[d_->active_sheet_index_]);
+    load_sheet(*d_->worksheets_.at(d_->active_sheet_index_));
+    return worksheet(d_->worksheets_[d_->active_sheet_index_].get());
 }
 
-bool workbook::has_named_range(const std::string &name) const
+void workbook::load_sheet(detail::worksheet_impl &impl) const
 {
-    for(auto worksheet : *this)
+    if(impl.loaded_)
     {
-        if(worksheet.has_named_range(name))
-        {
-            return true;
-        }
+        return;
     }
-    return false;
+    
+    const auto &options = d_->load_options_;
+    auto relationships = options.skip_hyperlinks ? std::vector<relationship>() : read_worksheet_relationships(*d_->archive_, impl.archive_path_);
+    
+    read_worksheet(worksheet(&impl), d_->archive_->read(impl.archive_path_), d_->shared_strings_, d_->style_ids_, relationships, options);
+    impl.loaded_ = true;
+    release_unloaded_sheet(*d_);
+}
+
+bool workbook::has_named_range(const std::string &name) const
+{
+    return d_->defined_names_.find_any(name) != nullptr;
 }
 
 worksheet workbook::create_sheet()
 {   
-    std::string title = "Sheet1";
-    int index = 1;
-
-    while(get_sheet_by_name(title) != nullptr)
-    {
-        title = "Sheet" + std::to_string(++index);
-    }
-
-    d_->worksheets_.push_back(detail::worksheet_impl(this, title));
+    auto title = d_->next_sheet_title("Sheet");
+    d_->worksheets_.push_back(std::make_unique<detail::worksheet_impl>(this, title));
+    d_->index_sheet(d_->worksheets_.back().get());
+    d_->formula_engine_.reset();
 	create_relationship("rId" + std::to_string(d_->relationships_.size() + 1), "xl/worksheets/sheet" + std::to_string(d_->worksheets_.size()) + ".xml", relationship::type::worksheet);
 	
-	return worksheet(&d_->worksheets_.back());
+	return worksheet(d_->worksheets_.back().get());
 }
 
 void workbook::add_sheet(xlnt::worksheet worksheet)
@@ -216,7 +263,14 @@ void workbook::add_sheet(xlnt::worksheet worksheet)
         }
     }
     
-    d_->worksheets_.emplace_back(*worksheet.d_);
+    // The copy can only be parsed from the archive of the workbook it came from.
+    worksheet.d_->parent_->load_sheet(*worksheet.d_);
+    
+    d_->worksheets_.push_back(std::make_unique<detail::worksheet_impl>(*worksheet.d_));
+    d_->worksheets_.back()->parent_ = this;
+    d_->index_sheet(d_->worksheets_.back().get());
+    d_->defined_names_.copy_sheet(worksheet.d_->parent_->d_->defined_names_, worksheet.d_, d_->worksheets_.back().get());
+    d_->formula_engine_.reset();
 }
 
 void workbook::add_sheet(xlnt::worksheet worksheet, std::size_t index)
@@ -227,54 +281,52 @@ void workbook::add_sheet(xlnt::worksheet worksheet, std::size_t index)
 
 int workbook::get_index(xlnt::worksheet worksheet)
 {
-    int i = 0;
-    for(auto ws : *this)
+    for(std::size_t i = 0; i < d_->worksheets_.size(); i++)
     {
-        if(worksheet == ws)
+        if(worksheet.d_ == d_->worksheets_[i].get())
         {
-            return i;
+            return static_cast<int>(i);
         }
-        i++;
     }
     throw std::runtime_error("worksheet isn't owned by this workbook");
 }
 
 void workbook::create_named_range(const std::string &name, worksheet range_owner, const range_reference &reference)
 {
-    auto match = get_sheet_by_name(range_owner.get_title());
-    if(match != nullptr)
+    if(range_owner.d_ == nullptr || range_owner.d_->parent_ != this)
     {
-        match.create_named_range(name, reference);
-        return;
+        throw std::runtime_error("worksheet isn't owned by this workbook");
     }
-    throw std::runtime_error("worksheet isn't owned by this workbook");
+    
+    d_->defined_names_.set(name, nullptr, range_owner.d_, reference);
+    d_->formula_engine_.reset();
 }
 
 void workbook::remove_named_range(const std::string &name)
 {
-    for(auto ws : *this)
+    auto match = d_->defined_names_.find_any(name);
+    
+    if(match == nullptr)
     {
-        if(ws.has_named_range(name))
-        {
-            ws.remove_named_range(name);
-            return;
-        }
+        throw std::runtime_error("named range not found");
     }
     
-    throw std::runtime_error("named range not found");
+    d_->defined_names_.remove(name, match->scope);
+    d_->formula_engine_.reset();
 }
 
 range workbook::get_named_range(const std::string &name)
 {
-    for(auto ws : *this)
+    auto match = d_->defined_names_.find_any(name);
+    
+    if(match == nullptr)
     {
-        if(ws.has_named_range(name))
-        {
-            return ws.get_named_range(name);
-        }
+        throw std::runtime_error("named range not found");
     }
     
-    throw std::runtime_error("named range not found");
+    load_sheet(*match->sheet);
+    
+    return worksheet(match->sheet).get_range(match->reference);
 }
 
 bool workbook::load(const std::istream &stream)
@@ -294,27 +346,51 @@ bool workbook::load(const std::istream &stream)
     return true;
 }
     
+bool workbook::load(const std::vector<unsigned char> &data, const load_options &options)
+{
+    set_load_options(options);
+    return load(data);
+}
+
+bool workbook::load(const std::string &filename, const load_options &options)
+{
+    set_load_options(options);
+    return load(filename);
+}
+    
 bool workbook::load(const std::vector<unsigned char> &data)
 {
-    xlnt::zip_file archive;
-    archive.load(data);
-    return load(archive);
+    auto archive = std::make_shared<zip_file>();
+    archive->load(data);
+    
+    if(d_->lazy_load_)
+    {
+        // Let load(zip_file &) keep this archive for deferred sheets instead of copying it.
+        d_->archive_ = archive;
+    }
+    
+    return load(*archive);
 }
 
 bool workbook::load(const std::string &filename)
 {
-    zip_file f;
+    auto archive = std::make_shared<zip_file>();
 
     try
     {
-        f.load(filename);
+        archive->load(filename);
     }
     catch(std::exception e)
     {
         throw invalid_file_exception(filename);
     }
     
-    return load(f);
+    if(d_->lazy_load_)
+    {
+        d_->archive_ = archive;
+    }
+    
+    return load(*archive);
 }
     
 bool workbook::load(xlnt::zip_file &archive)
@@ -327,6 +403,8 @@ bool workbook::load(xlnt::zip_file &archive)
         throw invalid_file_exception("");
     }
     
+    auto owned_archive = d_->archive_.get() == &archive ? d_->archive_ : nullptr;
+    
     clear();
     
     auto workbook_relationships = read_relationships(archive, "xl/workbook.xml");
@@ -346,56 +424,138 @@ bool workbook::load(xlnt::zip_file &archive)
     
     auto sheets_node = root_node.child("sheets");
     
-    std::vector<std::string> shared_strings;
+    auto &shared_strings = d_->shared_strings_;
     
     if(archive.has_file("xl/sharedStrings.xml"))
     {
         shared_strings = read_shared_strings(archive.read("xl/sharedStrings.xml"));
     }
 
-    std::vector<int> number_format_ids;
-    std::unordered_map<int, std::string> custom_number_formats;
+    auto &style_ids = d_->style_ids_;
+    const auto &options = d_->load_options_;
     
-    if(archive.has_file("xl/styles.xml"))
+    if(!options.skip_styles && archive.has_file("xl/styles.xml"))
     {
-        pugi::xml_document styles_doc;
-        styles_doc.load(archive.read("xl/styles.xml").c_str());
-        auto stylesheet_node = styles_doc.child("styleSheet");
-        auto cell_xfs_node = stylesheet_node.child("cellXfs");
-
-        for(auto xf_node : cell_xfs_node.children("xf"))
-        {
-            number_format_ids.push_back(xf_node.attribute("numFmtId").as_int());
-        }
-        
-        auto num_fmts_node = stylesheet_node.child("numFmts");
-        
-        for(auto num_fmt_node : num_fmts_node.children("numFmt"))
-        {
-            custom_number_formats[num_fmt_node.attribute("numFmtId").as_int()] = num_fmt_node.attribute("formatCode").as_string();
-        }
+        style_reader reader(*this);
+        reader.read_styles(archive.read("xl/styles.xml"));
+        style_ids = reader.get_style_ids();
     }
     
+    std::vector<bool> skipped(d_->relationships_.size(), false);
+    
     for(auto sheet_node : sheets_node.children("sheet"))
     {
 		std::string rel_id = sheet_node.attribute("r:id").as_string();
-		auto rel = std::find_if(d_->relationships_.begin(), d_->relationships_.end(),
-			[&](relationship &r) { return r.get_id() == rel_id; });
+		auto rel_index = d_->relationship_ids_.find(rel_id);
 
-		if (rel == d_->relationships_.end())
+		if (rel_index == d_->relationship_ids_.end())
 		{
 			throw std::runtime_error("relationship not found");
 		}
 
-        auto ws = create_sheet(sheet_node.attribute("name").as_string(), *rel);
-        auto sheet_filename = rel->get_target_uri();
+        auto rel = d_->relationships_.begin() + static_cast<std::ptrdiff_t>(rel_index->second);
+        std::string title = sheet_node.attribute("name").as_string();
+        auto archive_path = rel->get_target_uri();
+        
+        if(!options.sheets.empty() && std::find(options.sheets.begin(), options.sheets.end(), title) == options.sheets.end())
+        {
+            // Dropped after the loop so the positions in the relationship index stay valid.
+            skipped[rel_index->second] = true;
+            continue;
+        }
+        
+        // Sheets are kept in document order and renumbered consecutively so the writer's
+        // filename-to-index mapping holds even when part names in the archive have gaps.
+        *rel = relationship(relationship::type::worksheet, rel_id, "xl/worksheets/sheet" + std::to_string(d_->worksheets_.size() + 1) + ".xml");
+        auto ws = create_sheet(title, *rel);
+        ws.d_->archive_path_ = archive_path;
+        ws.d_->loaded_ = false;
+    }
+    
+    if(std::find(skipped.begin(), skipped.end(), true) != skipped.end())
+    {
+        std::size_t kept = 0;
+        
+        for(std::size_t i = 0; i < d_->relationships_.size(); i++)
+        {
+            if(!skipped[i])
+            {
+                d_->relationships_[kept++] = d_->relationships_[i];
+            }
+        }
+        
+        d_->relationships_.erase(d_->relationships_.begin() + static_cast<std::ptrdiff_t>(kept), d_->relationships_.end());
+        d_->index_relationships();
+    }
+
+    if(d_->lazy_load_ && !d_->worksheets_.empty())
+    {
+        if(owned_archive == nullptr)
+        {
+            // The caller's archive may not outlive this workbook so keep a private copy for deferred sheets.
+            std::vector<unsigned char> archive_bytes;
+            archive.save(archive_bytes);
+            owned_archive = std::make_shared<zip_file>(archive_bytes);
+        }
+        
+        d_->archive_ = owned_archive;
+        d_->unloaded_sheets_ = d_->worksheets_.size();
+        
+        return true;
+    }
 
-        read_worksheet(ws, archive.read(sheet_filename).c_str(), shared_strings, number_format_ids, custom_number_formats);
+    for(auto &ws : d_->worksheets_)
+    {
+        auto relationships = options.skip_hyperlinks ? std::vector<relationship>() : read_worksheet_relationships(archive, ws->archive_path_);
+        read_worksheet(worksheet(ws.get()), archive.read(ws->archive_path_), shared_strings, style_ids, relationships, options);
+        ws->loaded_ = true;
     }
+    
+    shared_strings.clear();
+    style_ids.clear();
 
     return true;
 }
 
+void workbook::calculate()
+{
+    for(auto &ws : d_->worksheets_)
+    {
+        load_sheet(*ws);
+    }
+    
+    d_->formula_engine_ = std::make_unique<detail::formula_engine>(*d_);
+    d_->formula_engine_->calculate(*d_);
+}
+
+void workbook::recalculate()
+{
+    auto current = d_->formula_engine_ != nullptr;
+    
+    for(auto &ws : d_->worksheets_)
+    {
+        current = current && ws->track_changes_ && !ws->dependencies_changed_;
+    }
+    
+    if(!current)
+    {
+        calculate();
+        return;
+    }
+    
+    d_->formula_engine_->recalculate(*d_);
+}
+
+std::size_t workbook::get_calculation_threads() const
+{
+    return d_->calculation_threads_;
+}
+
+void workbook::set_calculation_threads(std::size_t threads)
+{
+    d_->calculation_threads_ = threads;
+}
+
 void workbook::set_guess_types(bool guess)
 {
     d_->guess_types_ = guess;
@@ -406,48 +566,75 @@ bool workbook::get_guess_types() const
     return d_->guess_types_;
 }
 
+void workbook::set_lazy_load(bool lazy_load)
+{
+    d_->lazy_load_ = lazy_load;
+}
+
+bool workbook::get_lazy_load() const
+{
+    return d_->lazy_load_;
+}
+
+void workbook::set_load_options(const load_options &options)
+{
+    d_->load_options_ = options;
+}
+
+const load_options &workbook::get_load_options() const
+{
+    return d_->load_options_;
+}
+
 void workbook::create_relationship(const std::string &id, const std::string &target, relationship::type type)
 {
     d_->relationships_.push_back(relationship(type, id, target));
+    d_->relationship_ids_.emplace(id, d_->relationships_.size() - 1);
 }
 
 relationship workbook::get_relationship(const std::string &id) const
 {
-    for(auto &rel : d_->relationships_)
+    auto match = d_->relationship_ids_.find(id);
+
+    if(match == d_->relationship_ids_.end())
     {
-        if(rel.get_id() == id)
-        {
-            return rel;
-        }
+        throw std::runtime_error("");
     }
 
-    throw std::runtime_error("");
+    return d_->relationships_[match->second];
 }
     
 void workbook::remove_sheet(worksheet ws)
 {
-    auto match_iter = std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(), [=](detail::worksheet_impl &comp) { return worksheet(&comp) == ws; });
+    auto match_iter = std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(), [=](const std::unique_ptr<detail::worksheet_impl> &comp) { return comp.get() == ws.d_; });
 
     if(match_iter == d_->worksheets_.end())
     {
         throw std::runtime_error("worksheet not owned by this workbook");
     }
 
-    
+    if(!ws.d_->loaded_)
+    {
+        release_unloaded_sheet(*d_);
+    }
+
+    d_->defined_names_.remove_sheet(ws.d_);
+    d_->unindex_sheet(ws.d_);
     d_->worksheets_.erase(match_iter);
+    d_->formula_engine_.reset();
 }
 
 worksheet workbook::create_sheet(std::size_t index)
 {
-    create_sheet();
+    auto ws = create_sheet();
     
-	if (index != d_->worksheets_.size() - 1)
-	{
-		std::swap(d_->worksheets_.back(), d_->worksheets_[index]);
-		d_->worksheets_.pop_back();
-	}
+    if(index < d_->worksheets_.size() - 1)
+    {
+        // Shift the later sheets right by one, moving only their pointers.
+        std::rotate(d_->worksheets_.begin() + static_cast<std::ptrdiff_t>(index), d_->worksheets_.end() - 1, d_->worksheets_.end());
+    }
     
-    return worksheet(&d_->worksheets_[index]);
+    return ws;
 }
 
 //TODO: There should be a better way to do this...
@@ -467,16 +654,12 @@ std::size_t workbook::index_from_ws_filename(const std::string &ws_filename)
     
 worksheet workbook::create_sheet(const std::string &title, const relationship &rel)
 {
-	d_->worksheets_.push_back(detail::worksheet_impl(this, title));
-
-	auto index = index_from_ws_filename(rel.get_target_uri());
-	if (index != d_->worksheets_.size() - 1)
-	{
-		std::swap(d_->worksheets_.back(), d_->worksheets_[index]);
-		d_->worksheets_.pop_back();
-	}
+	auto index = std::min(index_from_ws_filename(rel.get_target_uri()), d_->worksheets_.size());
+	auto position = d_->worksheets_.insert(d_->worksheets_.begin() + static_cast<std::ptrdiff_t>(index), std::make_unique<detail::worksheet_impl>(this, title));
+	d_->index_sheet(position->get());
+	d_->formula_engine_.reset();
 
-	return worksheet(&d_->worksheets_[index]);
+	return worksheet(position->get());
 }
 
 worksheet workbook::create_sheet(std::size_t index, const std::string &title)
@@ -500,19 +683,7 @@ worksheet workbook::create_sheet(const std::string &title)
         throw sheet_title_exception(title);
     }
     
-    std::string unique_title = title;
-    
-    if(std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(), [&](detail::worksheet_impl &ws) { return worksheet(&ws).get_title() == unique_title; }) != d_->worksheets_.end())
-    {
-        std::size_t suffix = 1;
-        
-        while(std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(), [&](detail::worksheet_impl &ws) { return worksheet(&ws).get_title() == unique_title; }) != d_->worksheets_.end())
-        {
-            unique_title = title + std::to_string(suffix);
-            suffix++;
-        }
-    }
-    
+    auto unique_title = d_->find_sheet(title, false) == nullptr ? title : d_->next_sheet_title(title);
     auto ws = create_sheet();
     ws.set_title(unique_title);
 
@@ -543,9 +714,9 @@ std::vector<std::string> workbook::get_sheet_names() const
 {
     std::vector<std::string> names;
     
-    for(auto ws : *this)
+    for(auto &ws : d_->worksheets_)
     {
-        names.push_back(ws.get_title());
+        names.push_back(ws->title_);
     }
     
     return names;
@@ -558,25 +729,32 @@ worksheet workbook::operator[](const std::string &name)
 
 worksheet workbook::operator[](std::size_t index)
 {
-    return worksheet(&d_->worksheets_[index]);
+    return get_sheet_by_index(index);
 }
 
 void workbook::clear()
 {
     d_->worksheets_.clear();
+    d_->sheet_titles_.clear();
+    d_->next_suffixes_.clear();
+    d_->defined_names_.clear();
+    d_->formula_engine_.reset();
+    d_->archive_.reset();
+    d_->unloaded_sheets_ = 0;
     d_->relationships_.clear();
+    d_->relationship_ids_.clear();
     d_->active_sheet_index_ = 0;
     d_->drawings_.clear();
     d_->properties_ = document_properties();
 }
 
-bool workbook::save(std::vector<unsigned char> &data)
+bool workbook::save(std::vector<unsigned char> &data) const
 {
     data = save_virtual_workbook(*this);
     return true;
 }
 
-bool workbook::save(const std::string &filename)
+bool workbook::save(const std::string &filename) const
 {
     return save_workbook(*this, filename);
 }
@@ -629,14 +807,14 @@ void swap(workbook &left, workbook &right)
     using std::swap;
     swap(left.d_, right.d_);
     
-    for(auto ws : left)
+    for(auto &ws : left.d_->worksheets_)
     {
-        ws.set_parent(left);
+        ws->parent_ = &left;
     }
     
-    for(auto ws : right)
+    for(auto &ws : right.d_->worksheets_)
     {
-        ws.set_parent(right);
+        ws->parent_ = &right;
     }
 }
     
@@ -655,9 +833,9 @@ workbook::workbook(const workbook &other) : workbook()
 {
     *d_.get() = *other.d_.get();
     
-    for(auto ws : *this)
+    for(auto &ws : d_->worksheets_)
     {
-        ws.set_parent(*this);
+        ws->parent_ = this;
     }
 }
 
@@ -671,34 +849,34 @@ void workbook::set_data_only(bool data_only)
     d_->data_only_ = data_only;
 }
 
-void workbook::add_border(xlnt::border /*b*/)
+void workbook::add_border(xlnt::border b)
 {
-    
+    d_->borders_.intern(b);
 }
 
-void workbook::add_alignment(xlnt::alignment /*a*/)
+void workbook::add_alignment(xlnt::alignment a)
 {
-    
+    d_->alignments_.intern(a);
 }
 
-void workbook::add_protection(xlnt::protection /*p*/)
+void workbook::add_protection(xlnt::protection p)
 {
-    
+    d_->protections_.intern(p);
 }
 
-void workbook::add_number_format(const std::string &/*format*/)
+void workbook::add_number_format(const std::string &format)
 {
-    
+    d_->number_formats_.intern(number_format(format));
 }
 
-void workbook::add_fill(xlnt::fill &/*f*/)
+void workbook::add_fill(xlnt::fill &f)
 {
-    
+    d_->fills_.intern(f);
 }
 
-void workbook::add_font(xlnt::font /*f*/)
+void workbook::add_font(xlnt::font f)
 {
-    
+    d_->fonts_.intern(f);
 }
 
 void workbook::set_code_name(const std::string &/*code_name*/)
@@ -706,12 +884,12 @@ void workbook::set_code_name(const std::string &/*code_name*/)
     
 }
 
-bool workbook::has_loaded_theme()
+bool workbook::has_loaded_theme() const
 {
     return false;
 }
 
-std::string workbook::get_loaded_theme()
+std::string workbook::get_loaded_theme() const
 {
     return "";
 }
@@ -720,12 +898,12 @@ std::vector<named_range> workbook::get_named_ranges() const
 {
     std::vector<named_range> named_ranges;
     
-    for(auto ws : *this)
+    for(auto name : d_->defined_names_.get_names())
     {
-        for(auto &ws_named_range : ws.d_->named_ranges_)
-        {
-            named_ranges.push_back(ws_named_range.second);
-        }
+        std::vector<named_range::target> targets;
+        load_sheet(*name->sheet);
+        targets.push_back({ worksheet(name->sheet), name->reference });
+        named_ranges.push_back(named_range(name->name, targets));
     }
     
     return named_ranges;
@@ -733,7 +911,19 @@ std::vector<named_range> workbook::get_named_ranges() const
 
 std::size_t workbook::add_style(xlnt::style style_)
 {
-    return 1;
+    style_.alignment_index_ = d_->alignments_.intern(style_.alignment_);
+    style_.border_index_ = d_->borders_.intern(style_.border_);
+    style_.fill_index_ = d_->fills_.intern(style_.fill_);
+    style_.font_index_ = d_->fonts_.intern(style_.font_);
+    style_.number_format_index_ = d_->number_formats_.intern(style_.number_format_);
+    style_.protection_index_ = d_->protections_.intern(style_.protection_);
+    
+    return d_->styles_.intern(style_);
+}
+
+style workbook::get_style(std::size_t style_id)
+{
+    return d_->styles_[style_id];
 }
 
 const number_format &workbook::get_number_format(std::size_t style_id) const
@@ -748,40 +938,11 @@ const font &workbook::get_font(std::size_t style_id) const
 
 std::size_t workbook::set_font(const font &font_, std::size_t style_id)
 {
-    auto match = std::find(d_->fonts_.begin(), d_->fonts_.end(), font_);
-    auto font_index = 0;
-    
-    if(match == d_->fonts_.end())
-    {
-        d_->fonts_.push_back(font_);
-        font_index = d_->fonts_.size() - 1;
-    }
-    else
-    {
-        font_index = match - d_->fonts_.begin();
-    }
-    
-    auto existing_style = d_->styles_[style_id];
+    auto new_style = d_->styles_[style_id];
+    new_style.font_index_ = d_->fonts_.intern(font_);
+    new_style.font_ = font_;
     
-    if(font_index == existing_style.font_index_)
-    {
-        // no change
-        return style_id;
-    }
-    
-    auto new_style = existing_style;
-    new_style.font_index_ = font_index;
-    
-    auto style_match = std::find(d_->styles_.begin(), d_->styles_.end(), new_style);
-
-    if(style_match != d_->styles_.end())
-    {
-        return style_match - d_->styles_.begin();
-    }
-    
-    d_->styles_.push_back(new_style);
-    
-    return d_->styles_.size() - 1;
+    return d_->styles_.intern(new_style);
 }
 
 const fill &workbook::get_fill(std::size_t style_id) const
@@ -791,7 +952,11 @@ const fill &workbook::get_fill(std::size_t style_id) const
 
 std::size_t workbook::set_fill(const fill &fill_, std::size_t style_id)
 {
-    return style_id;
+    auto new_style = d_->styles_[style_id];
+    new_style.fill_index_ = d_->fills_.intern(fill_);
+    new_style.fill_ = fill_;
+    
+    return d_->styles_.intern(new_style);
 }
 
 const border &workbook::get_border(std::size_t style_id) const
@@ -801,7 +966,11 @@ const border &workbook::get_border(std::size_t style_id) const
 
 std::size_t workbook::set_border(const border &border_, std::size_t style_id)
 {
-    return style_id;
+    auto new_style = d_->styles_[style_id];
+    new_style.border_index_ = d_->borders_.intern(border_);
+    new_style.border_ = border_;
+    
+    return d_->styles_.intern(new_style);
 }
 
 const alignment &workbook::get_alignment(std::size_t style_id) const
@@ -811,17 +980,25 @@ const alignment &workbook::get_alignment(std::size_t style_id) const
 
 std::size_t workbook::set_alignment(const alignment &alignment_, std::size_t style_id)
 {
-    return style_id;
+    auto new_style = d_->styles_[style_id];
+    new_style.alignment_index_ = d_->alignments_.intern(alignment_);
+    new_style.alignment_ = alignment_;
+    
+    return d_->styles_.intern(new_style);
 }
 
 const protection &workbook::get_protection(std::size_t style_id) const
 {
-    return d_->protections_[d_->styles_[style_id].number_format_index_];
+    return d_->protections_[d_->styles_[style_id].protection_index_];
 }
 
 std::size_t workbook::set_protection(const protection &protection_, std::size_t style_id)
 {
-    return style_id;
+    auto new_style = d_->styles_[style_id];
+    new_style.protection_index_ = d_->protections_.intern(protection_);
+    new_style.protection_ = protection_;
+    
+    return d_->styles_.intern(new_style);
 }
 
 bool workbook::get_pivot_button(std::size_t style_id) const
@@ -836,70 +1013,64 @@ bool workbook::get_quote_prefix(std::size_t style_id) const
 
 std::size_t workbook::set_number_format(const xlnt::number_format &format, std::size_t style_id)
 {
-    auto match = std::find(d_->number_formats_.begin(), d_->number_formats_.end(), format);
-    auto format_index = 0;
-    
-    if(match == d_->number_formats_.end())
-    {
-        d_->number_formats_.push_back(format);
-        format_index = d_->number_formats_.size() - 1;
-    }
-    else
-    {
-        format_index = match - d_->number_formats_.begin();
-    }
+    auto new_style = d_->styles_[style_id];
+    new_style.number_format_index_ = d_->number_formats_.intern(format);
+    new_style.number_format_ = format;
     
-    if(d_->styles_.empty())
-    {
-        style new_style;
-        new_style.style_index_ = 0;
-        new_style.alignment_index_ = 0;
-        new_style.border_index_ = 0;
-        new_style.fill_index_ = 0;
-        new_style.font_index_ = 0;
-        new_style.number_format_index_ = format_index;
-        new_style.protection_index_ = 0;
-        d_->styles_.push_back(new_style);
-        return 0;
-    }
+    return d_->styles_.intern(new_style);
+}
     
-    auto existing_style = d_->styles_[style_id];
+const detail::number_formatter &workbook::get_number_formatter(std::size_t style_id) const
+{
+    auto index = d_->styles_[style_id].number_format_index_;
+    auto &formatters = d_->number_formatters_;
     
-    if(format_index == existing_style.number_format_index_)
+    if(formatters.size() <= index)
     {
-        // no change
-        return style_id;
+        formatters.resize(index + 1);
     }
     
-    auto new_style = existing_style;
-    new_style.number_format_index_ = format_index;
-    new_style.number_format_ = format;
-    
-    auto style_match = std::find(d_->styles_.begin(), d_->styles_.end(), new_style);
-    
-    if(style_match != d_->styles_.end())
+    if(!formatters[index])
     {
-        return style_match - d_->styles_.begin();
+        formatters[index] = std::make_unique<detail::number_formatter>(d_->number_formats_[index].get_format_string());
     }
     
-    d_->styles_.push_back(new_style);
-    
-    return d_->styles_.size() - 1;
+    return *formatters[index];
 }
     
 std::vector<style> workbook::get_styles() const
 {
-    return d_->styles_;
+    return d_->styles_.get_values();
 }
 
 std::vector<number_format> workbook::get_number_formats() const
 {
-    return d_->number_formats_;
+    return d_->number_formats_.get_values();
 }
 
 std::vector<font> workbook::get_fonts() const
 {
-    return d_->fonts_;
+    return d_->fonts_.get_values();
+}
+
+std::vector<alignment> workbook::get_alignments() const
+{
+    return d_->alignments_.get_values();
+}
+
+std::vector<border> workbook::get_borders() const
+{
+    return d_->borders_.get_values();
+}
+
+std::vector<fill> workbook::get_fills() const
+{
+    return d_->fills_.get_values();
+}
+
+std::vector<protection> workbook::get_protections() const
+{
+    return d_->protections_.get_values();
 }
     
 } // namespace xlnt
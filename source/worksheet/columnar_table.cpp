@@ -0,0 +1,807 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/columnar_table.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+#include "detail/worksheet_impl.hpp"
+
+namespace {
+
+enum value_kind
+{
+    kind_null = 0,
+    kind_numeric = 1,
+    kind_boolean = 2,
+    kind_text = 4
+};
+
+std::size_t bitmap_size(std::size_t length)
+{
+    return (length + 7) / 8;
+}
+
+void set_bit(std::vector<std::uint8_t> &bitmap, std::size_t index)
+{
+    bitmap[index / 8] |= static_cast<std::uint8_t>(1 << (index % 8));
+}
+
+bool get_bit(const void *bitmap, std::int64_t index)
+{
+    auto bytes = static_cast<const std::uint8_t *>(bitmap);
+    return ((bytes[index / 8] >> (index % 8)) & 1) != 0;
+}
+
+int get_kind(const xlnt::detail::cell_impl *cell)
+{
+    if(cell == nullptr)
+    {
+        return kind_null;
+    }
+
+    switch(cell->type_)
+    {
+    case xlnt::cell::type::numeric:
+        return kind_numeric;
+    case xlnt::cell::type::boolean:
+        return kind_boolean;
+    case xlnt::cell::type::string:
+    case xlnt::cell::type::error:
+    case xlnt::cell::type::formula:
+        return kind_text;
+    case xlnt::cell::type::null:
+        return cell->formula_.empty() && cell->shared_formula_ == xlnt::detail::no_shared_formula ? kind_null : kind_text;
+    }
+
+    return kind_null;
+}
+
+std::string format_number(long double number)
+{
+    auto value = static_cast<double>(number);
+    char buffer[32];
+
+    // Use the shortest representation that parses back to the same double.
+    for(int precision = 15; precision <= 17; precision++)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+
+        if(std::strtod(buffer, nullptr) == value)
+        {
+            break;
+        }
+    }
+
+    return buffer;
+}
+
+std::string get_text(const xlnt::detail::cell_impl &cell)
+{
+    switch(cell.type_)
+    {
+    case xlnt::cell::type::numeric:
+        return format_number(cell.value_numeric_);
+    case xlnt::cell::type::boolean:
+        return cell.value_numeric_ != 0 ? "TRUE" : "FALSE";
+    case xlnt::cell::type::string:
+    case xlnt::cell::type::error:
+        return cell.value_string_;
+    default:
+        break;
+    }
+
+    // Cells of a shared formula hold only the group's index, so the formula is translated.
+    auto formula = cell.shared_formula_ != xlnt::detail::no_shared_formula
+        ? const_cast<xlnt::detail::cell_impl &>(cell).self().get_formula() : cell.formula_;
+
+    if(!formula.empty() && formula.front() != '=')
+    {
+        return "=" + formula;
+    }
+
+    return formula;
+}
+
+// Cells are cleared before being written, so this is also where writes are reported to the
+// sheet for recalculation. Removing a formula changes the dependency graph itself.
+void clear_cell(xlnt::detail::cell_impl &cell)
+{
+    if(!cell.formula_.empty() || cell.shared_formula_ != xlnt::detail::no_shared_formula)
+    {
+        cell.parent_->dependencies_changed_ = true;
+    }
+    else
+    {
+        cell.parent_->value_changed(cell);
+    }
+
+    cell.value_numeric_ = 0;
+    cell.value_string_.clear();
+    cell.formula_.clear();
+    cell.shared_formula_ = xlnt::detail::no_shared_formula;
+    cell.type_ = xlnt::cell::type::null;
+    cell.has_hyperlink_ = false;
+    cell.hyperlink_ = xlnt::relationship();
+    cell.has_style_ = false;
+    cell.style_id_ = 0;
+    cell.xf_index_ = 0;
+}
+
+struct schema_private
+{
+    std::string name;
+    std::vector<ArrowSchema *> children;
+    ArrowSchema *dictionary = nullptr;
+};
+
+struct array_private
+{
+    std::shared_ptr<const xlnt::columnar_table> table;
+    std::vector<const void *> buffers;
+    std::vector<ArrowArray *> children;
+    ArrowArray *dictionary = nullptr;
+};
+
+void release_schema(ArrowSchema *schema)
+{
+    auto data = static_cast<schema_private *>(schema->private_data);
+
+    for(auto child : data->children)
+    {
+        if(child->release != nullptr)
+        {
+            child->release(child);
+        }
+
+        delete child;
+    }
+
+    if(data->dictionary != nullptr)
+    {
+        if(data->dictionary->release != nullptr)
+        {
+            data->dictionary->release(data->dictionary);
+        }
+
+        delete data->dictionary;
+    }
+
+    delete data;
+    schema->release = nullptr;
+}
+
+void release_array(ArrowArray *array)
+{
+    auto data = static_cast<array_private *>(array->private_data);
+
+    for(auto child : data->children)
+    {
+        if(child->release != nullptr)
+        {
+            child->release(child);
+        }
+
+        delete child;
+    }
+
+    if(data->dictionary != nullptr)
+    {
+        if(data->dictionary->release != nullptr)
+        {
+            data->dictionary->release(data->dictionary);
+        }
+
+        delete data->dictionary;
+    }
+
+    delete data;
+    array->release = nullptr;
+}
+
+void init_schema(ArrowSchema *schema, const char *format, const std::string &name, std::int64_t flags)
+{
+    auto data = new schema_private;
+    data->name = name;
+
+    schema->format = format;
+    schema->name = data->name.c_str();
+    schema->metadata = nullptr;
+    schema->flags = flags;
+    schema->n_children = 0;
+    schema->children = nullptr;
+    schema->dictionary = nullptr;
+    schema->release = &release_schema;
+    schema->private_data = data;
+}
+
+array_private *init_array(ArrowArray *array, std::shared_ptr<const xlnt::columnar_table> table,
+    std::int64_t length, std::int64_t null_count, std::vector<const void *> buffers)
+{
+    auto data = new array_private;
+    data->table = table;
+    data->buffers = buffers;
+
+    array->length = length;
+    array->null_count = null_count;
+    array->offset = 0;
+    array->n_buffers = static_cast<std::int64_t>(data->buffers.size());
+    array->buffers = data->buffers.empty() ? nullptr : data->buffers.data();
+    array->n_children = 0;
+    array->children = nullptr;
+    array->dictionary = nullptr;
+    array->release = &release_array;
+    array->private_data = data;
+
+    return data;
+}
+
+const char *get_arrow_format(xlnt::columnar_type type)
+{
+    switch(type)
+    {
+    case xlnt::columnar_type::float64:
+        return "g";
+    case xlnt::columnar_type::boolean:
+        return "b";
+    case xlnt::columnar_type::dictionary:
+        return "i";
+    default:
+        return "n";
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+
+columnar_table::columnar_table() : row_count_(0)
+{
+    dictionary_offsets_.push_back(0);
+}
+
+columnar_table columnar_table::from_worksheet(worksheet ws)
+{
+    return from_worksheet(ws, ws.calculate_dimension());
+}
+
+columnar_table columnar_table::from_worksheet(worksheet ws, const range_reference &reference)
+{
+    auto first_column = reference.get_top_left().get_column_index();
+    auto first_row = reference.get_top_left().get_row();
+    std::size_t width = reference.get_width() + 1;
+    std::size_t height = reference.get_height() + 1;
+
+    // Gather cell pointers column by column so each column can be classified and
+    // filled with a single pass over contiguous memory.
+    std::vector<const detail::cell_impl *> cells(width * height, nullptr);
+
+    for(std::size_t row_offset = 0; row_offset < height; row_offset++)
+    {
+        auto row_match = ws.d_->cell_map_.find(static_cast<row_t>(first_row + row_offset));
+
+        if(row_match == ws.d_->cell_map_.end())
+        {
+            continue;
+        }
+
+        auto &row = row_match->second;
+
+        if(row.size() <= width)
+        {
+            for(auto &entry : row)
+            {
+                if(entry.first >= first_column && entry.first - first_column < width)
+                {
+                    cells[(entry.first - first_column) * height + row_offset] = &entry.second;
+                }
+            }
+        }
+        else
+        {
+            for(std::size_t column_offset = 0; column_offset < width; column_offset++)
+            {
+                auto cell_match = row.find(static_cast<column_t>(first_column + column_offset));
+
+                if(cell_match != row.end())
+                {
+                    cells[column_offset * height + row_offset] = &cell_match->second;
+                }
+            }
+        }
+    }
+
+    columnar_table table;
+    table.columns_.reserve(width);
+
+    for(std::size_t column_offset = 0; column_offset < width; column_offset++)
+    {
+        auto column_cells = cells.data() + column_offset * height;
+        int kinds = kind_null;
+
+        for(std::size_t row_offset = 0; row_offset < height; row_offset++)
+        {
+            kinds |= get_kind(column_cells[row_offset]);
+        }
+
+        columnar_column column;
+        column.name = cell_reference::column_string_from_index(static_cast<column_t>(first_column + column_offset));
+        column.length = height;
+        column.validity.assign(bitmap_size(height), 0);
+
+        if(kinds == kind_numeric)
+        {
+            column.type = columnar_type::float64;
+            column.values.assign(height, 0);
+        }
+        else if(kinds == kind_boolean)
+        {
+            column.type = columnar_type::boolean;
+            column.booleans.assign(bitmap_size(height), 0);
+        }
+        else if(kinds != kind_null)
+        {
+            column.type = columnar_type::dictionary;
+            column.indices.assign(height, 0);
+        }
+
+        for(std::size_t row_offset = 0; row_offset < height; row_offset++)
+        {
+            auto cell = column_cells[row_offset];
+
+            if(get_kind(cell) == kind_null)
+            {
+                column.null_count++;
+                continue;
+            }
+
+            set_bit(column.validity, row_offset);
+
+            switch(column.type)
+            {
+            case columnar_type::float64:
+                column.values[row_offset] = static_cast<double>(cell->value_numeric_);
+                break;
+            case columnar_type::boolean:
+                if(cell->value_numeric_ != 0)
+                {
+                    set_bit(column.booleans, row_offset);
+                }
+                break;
+            case columnar_type::dictionary:
+                column.indices[row_offset] = table.intern(get_text(*cell));
+
+                if(cell->type_ == cell::type::error)
+                {
+                    if(column.errors.empty())
+                    {
+                        column.errors.assign(bitmap_size(height), 0);
+                    }
+
+                    set_bit(column.errors, row_offset);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        table.add_column(column);
+    }
+
+    table.row_count_ = height;
+
+    return table;
+}
+
+columnar_table columnar_table::from_arrow(const ArrowSchema *schema, const ArrowArray *array)
+{
+    if(schema == nullptr || array == nullptr || schema->format == nullptr || std::string(schema->format) != "+s")
+    {
+        throw std::runtime_error("expected an arrow struct array");
+    }
+
+    if(schema->n_children != array->n_children)
+    {
+        throw std::runtime_error("arrow schema and array have different numbers of children");
+    }
+
+    columnar_table table;
+    auto length = static_cast<std::size_t>(array->length);
+
+    // Rows that are null in the struct itself are null in every column.
+    const void *struct_validity = array->null_count != 0 && array->n_buffers > 0 ? array->buffers[0] : nullptr;
+
+    for(std::int64_t child_index = 0; child_index < schema->n_children; child_index++)
+    {
+        auto child_schema = schema->children[child_index];
+        auto child_array = array->children[child_index];
+        std::string format = child_schema->format;
+        auto offset = array->offset + child_array->offset;
+        const void *validity = child_array->null_count != 0 && child_array->n_buffers > 0 ? child_array->buffers[0] : nullptr;
+
+        columnar_column column;
+        column.name = child_schema->name == nullptr ? "" : child_schema->name;
+        column.length = length;
+        column.validity.assign(bitmap_size(length), 0);
+
+        if(format == "n")
+        {
+            column.null_count = length;
+            table.add_column(column);
+            continue;
+        }
+
+        if(format == "b")
+        {
+            column.type = columnar_type::boolean;
+            column.booleans.assign(bitmap_size(length), 0);
+        }
+        else if(format == "g" || format == "f" || format == "l" || (format == "i" && child_schema->dictionary == nullptr))
+        {
+            column.type = columnar_type::float64;
+            column.values.assign(length, 0);
+        }
+        else if(format == "u" || format == "i")
+        {
+            column.type = columnar_type::dictionary;
+            column.indices.assign(length, 0);
+        }
+        else
+        {
+            throw std::runtime_error("unsupported arrow format: " + format);
+        }
+
+        // Dictionary entries are interned into the table's own dictionary on first use.
+        const ArrowArray *dictionary = nullptr;
+        std::vector<std::int32_t> remapped;
+
+        if(format == "i" && child_schema->dictionary != nullptr)
+        {
+            if(child_array->dictionary == nullptr || std::string(child_schema->dictionary->format) != "u")
+            {
+                throw std::runtime_error("unsupported arrow dictionary format: " + std::string(child_schema->dictionary->format));
+            }
+
+            dictionary = child_array->dictionary;
+            remapped.assign(static_cast<std::size_t>(dictionary->length), -1);
+        }
+
+        for(std::size_t row = 0; row < length; row++)
+        {
+            auto index = offset + static_cast<std::int64_t>(row);
+
+            if((struct_validity != nullptr && !get_bit(struct_validity, array->offset + static_cast<std::int64_t>(row)))
+                || (validity != nullptr && !get_bit(validity, index)))
+            {
+                column.null_count++;
+                continue;
+            }
+
+            if(format == "b")
+            {
+                if(get_bit(child_array->buffers[1], index))
+                {
+                    set_bit(column.booleans, row);
+                }
+            }
+            else if(format == "g")
+            {
+                column.values[row] = static_cast<const double *>(child_array->buffers[1])[index];
+            }
+            else if(format == "f")
+            {
+                column.values[row] = static_cast<const float *>(child_array->buffers[1])[index];
+            }
+            else if(format == "l")
+            {
+                column.values[row] = static_cast<double>(static_cast<const std::int64_t *>(child_array->buffers[1])[index]);
+            }
+            else if(dictionary == nullptr && format == "i")
+            {
+                column.values[row] = static_cast<const std::int32_t *>(child_array->buffers[1])[index];
+            }
+            else if(format == "u")
+            {
+                auto offsets = static_cast<const std::int32_t *>(child_array->buffers[1]);
+                auto data = static_cast<const char *>(child_array->buffers[2]);
+                column.indices[row] = table.intern(std::string(data + offsets[index], data + offsets[index + 1]));
+            }
+            else
+            {
+                auto key = static_cast<const std::int32_t *>(child_array->buffers[1])[index];
+
+                if(key < 0 || key >= dictionary->length)
+                {
+                    throw std::runtime_error("arrow dictionary index out of range");
+                }
+
+                auto dictionary_index = dictionary->offset + key;
+                const void *dictionary_validity = dictionary->null_count != 0 ? dictionary->buffers[0] : nullptr;
+
+                if(dictionary_validity != nullptr && !get_bit(dictionary_validity, dictionary_index))
+                {
+                    column.null_count++;
+                    continue;
+                }
+
+                if(remapped[key] == -1)
+                {
+                    auto offsets = static_cast<const std::int32_t *>(dictionary->buffers[1]);
+                    auto data = static_cast<const char *>(dictionary->buffers[2]);
+                    remapped[key] = table.intern(std::string(data + offsets[dictionary_index], data + offsets[dictionary_index + 1]));
+                }
+
+                column.indices[row] = remapped[key];
+            }
+
+            set_bit(column.validity, row);
+        }
+
+        table.add_column(column);
+    }
+
+    table.row_count_ = length;
+
+    return table;
+}
+
+void columnar_table::to_worksheet(worksheet ws, const cell_reference &top_left) const
+{
+    auto first_column = top_left.get_column_index();
+    auto first_row = top_left.get_row();
+    auto &cell_map = ws.d_->cell_map_;
+
+    for(std::size_t row_offset = 0; row_offset < row_count_; row_offset++)
+    {
+        auto row_index = static_cast<row_t>(first_row + row_offset);
+        auto row_match = cell_map.find(row_index);
+        auto row = row_match == cell_map.end() ? nullptr : &row_match->second;
+
+        for(std::size_t column_offset = 0; column_offset < columns_.size(); column_offset++)
+        {
+            auto &column = columns_[column_offset];
+            auto column_index = static_cast<column_t>(first_column + column_offset);
+
+            if(column.type == columnar_type::null || !column.is_valid(row_offset))
+            {
+                if(row != nullptr)
+                {
+                    auto cell_match = row->find(column_index);
+
+                    if(cell_match != row->end())
+                    {
+                        clear_cell(cell_match->second);
+                    }
+                }
+
+                continue;
+            }
+
+            if(row == nullptr)
+            {
+                row = &ws.d_->get_row(row_index);
+            }
+
+            auto cell_match = row->find(column_index);
+
+            if(cell_match == row->end())
+            {
+                cell_match = row->emplace(column_index, detail::cell_impl(ws.d_, column_index, row_index)).first;
+            }
+
+            auto &cell = cell_match->second;
+            clear_cell(cell);
+
+            switch(column.type)
+            {
+            case columnar_type::float64:
+                cell.value_numeric_ = column.values[row_offset];
+                cell.type_ = cell::type::numeric;
+                break;
+            case columnar_type::boolean:
+                cell.value_numeric_ = ((column.booleans[row_offset / 8] >> (row_offset % 8)) & 1) ? 1 : 0;
+                cell.type_ = cell::type::boolean;
+                break;
+            case columnar_type::dictionary:
+            {
+                // Only text starting with '=' is reinterpreted, so strings such as "#N/A" stay
+                // strings unless the column marks them as errors.
+                auto text = check_string(get_dictionary_value(static_cast<std::size_t>(column.indices[row_offset])));
+
+                if(column.is_error(row_offset))
+                {
+                    cell.value_string_ = std::move(text);
+                    cell.type_ = cell::type::error;
+                }
+                else if(text.size() > 1 && text.front() == '=')
+                {
+                    cell.formula_ = std::move(text);
+                    cell.type_ = cell::type::formula;
+                }
+                else
+                {
+                    cell.value_string_ = std::move(text);
+                    cell.type_ = cell::type::string;
+                }
+
+                break;
+            }
+            default:
+                break;
+            }
+
+            if(!cell.formula_.empty())
+            {
+                ws.d_->dependencies_changed_ = true;
+            }
+        }
+    }
+}
+
+void columnar_table::to_arrow(ArrowSchema *schema, ArrowArray *array) const
+{
+    auto table = std::make_shared<const columnar_table>(*this);
+    auto column_count = table->columns_.size();
+
+    init_schema(schema, "+s", "", 0);
+    auto schema_data = static_cast<schema_private *>(schema->private_data);
+
+    auto array_data = init_array(array, table, static_cast<std::int64_t>(table->row_count_), 0, { nullptr });
+
+    for(std::size_t i = 0; i < column_count; i++)
+    {
+        auto &column = table->columns_[i];
+
+        auto child_schema = new ArrowSchema;
+        schema_data->children.push_back(child_schema);
+        init_schema(child_schema, get_arrow_format(column.type), column.name, ARROW_FLAG_NULLABLE);
+
+        auto child_array = new ArrowArray;
+        array_data->children.push_back(child_array);
+        auto length = static_cast<std::int64_t>(column.length);
+        auto null_count = static_cast<std::int64_t>(column.null_count);
+
+        switch(column.type)
+        {
+        case columnar_type::float64:
+            init_array(child_array, table, length, null_count, { column.validity.data(), column.values.data() });
+            break;
+        case columnar_type::boolean:
+            init_array(child_array, table, length, null_count, { column.validity.data(), column.booleans.data() });
+            break;
+        case columnar_type::dictionary:
+        {
+            auto child_data = init_array(child_array, table, length, null_count, { column.validity.data(), column.indices.data() });
+
+            auto dictionary_schema = new ArrowSchema;
+            static_cast<schema_private *>(child_schema->private_data)->dictionary = dictionary_schema;
+            child_schema->dictionary = dictionary_schema;
+            init_schema(dictionary_schema, "u", "", 0);
+
+            auto dictionary_array = new ArrowArray;
+            child_data->dictionary = dictionary_array;
+            child_array->dictionary = dictionary_array;
+            init_array(dictionary_array, table, static_cast<std::int64_t>(table->get_dictionary_size()), 0,
+                { nullptr, table->dictionary_offsets_.data(), table->dictionary_data_.data() });
+            break;
+        }
+        default:
+            init_array(child_array, table, length, length, {});
+            break;
+        }
+    }
+
+    schema->n_children = static_cast<std::int64_t>(column_count);
+    schema->children = schema_data->children.data();
+    array->n_children = static_cast<std::int64_t>(column_count);
+    array->children = array_data->children.data();
+}
+
+std::size_t columnar_table::get_row_count() const
+{
+    return row_count_;
+}
+
+std::size_t columnar_table::get_column_count() const
+{
+    return columns_.size();
+}
+
+columnar_column &columnar_table::get_column(std::size_t index)
+{
+    return columns_.at(index);
+}
+
+const columnar_column &columnar_table::get_column(std::size_t index) const
+{
+    return columns_.at(index);
+}
+
+void columnar_table::add_column(const columnar_column &column)
+{
+    if(!columns_.empty() && column.length != row_count_)
+    {
+        throw std::runtime_error("column length doesn't match table row count");
+    }
+
+    auto bytes = bitmap_size(column.length);
+    bool valid = column.validity.size() >= bytes && (column.errors.empty() || column.errors.size() >= bytes);
+
+    switch(column.type)
+    {
+    case columnar_type::float64:
+        valid = valid && column.values.size() >= column.length;
+        break;
+    case columnar_type::boolean:
+        valid = valid && column.booleans.size() >= bytes;
+        break;
+    case columnar_type::dictionary:
+        valid = valid && column.indices.size() >= column.length;
+
+        for(std::size_t i = 0; valid && i < column.length; i++)
+        {
+            valid = !column.is_valid(i) || (column.indices[i] >= 0 && static_cast<std::size_t>(column.indices[i]) < get_dictionary_size());
+        }
+        break;
+    default:
+        break;
+    }
+
+    if(!valid)
+    {
+        throw std::runtime_error("column buffers don't match its length");
+    }
+
+    row_count_ = column.length;
+    columns_.push_back(column);
+}
+
+std::int32_t columnar_table::intern(const std::string &value)
+{
+    auto match = dictionary_lookup_.find(value);
+
+    if(match != dictionary_lookup_.end())
+    {
+        return match->second;
+    }
+
+    auto index = static_cast<std::int32_t>(get_dictionary_size());
+    dictionary_data_.insert(dictionary_data_.end(), value.begin(), value.end());
+    dictionary_offsets_.push_back(static_cast<std::int32_t>(dictionary_data_.size()));
+    dictionary_lookup_[value] = index;
+
+    return index;
+}
+
+std::size_t columnar_table::get_dictionary_size() const
+{
+    return dictionary_offsets_.size() - 1;
+}
+
+std::string columnar_table::get_dictionary_value(std::size_t index) const
+{
+    auto begin = dictionary_data_.begin() + dictionary_offsets_.at(index);
+    auto end = dictionary_data_.begin() + dictionary_offsets_.at(index + 1);
+
+    return std::string(begin, end);
+}
+
+const std::vector<std::int32_t> &columnar_table::get_dictionary_offsets() const
+{
+    return dictionary_offsets_;
+}
+
+const std::vector<char> &columnar_table::get_dictionary_data() const
+{
+    return dictionary_data_;
+}
+
+} // namespace xlnt
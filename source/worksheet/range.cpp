@@ -1,8 +1,30 @@
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/common/exceptions.hpp>
+#include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
+#include "detail/cell_impl.hpp"
+#include "detail/number_formatter.hpp"
+#include "detail/range_aggregate.hpp"
+#include "detail/worksheet_impl.hpp"
+
+namespace {
+
+xlnt::detail::range_aggregate aggregate(const xlnt::detail::worksheet_impl &ws, const xlnt::range_reference &reference)
+{
+    xlnt::detail::range_aggregate totals;
+    xlnt::detail::aggregate_range(ws, reference.get_top_left().get_column_index(), reference.get_top_left().get_row(),
+        reference.get_bottom_right().get_column_index(), reference.get_bottom_right().get_row(), totals);
+    
+    return totals;
+}
+
+} // namespace
+
 namespace xlnt {
 
 template<>
@@ -165,6 +187,163 @@ bool range::contains(const cell_reference &ref)
     return ref_.get_top_left().get_column_index() <= ref.get_column_index() && ref_.get_bottom_right().get_column_index() >= ref.get_column_index() && ref_.get_top_left().get_row() <= ref.get_row() && ref_.get_bottom_right().get_row() >= ref.get_row();
 }
 
+range_reference range::render_text(std::string &text, std::vector<std::size_t> &offsets) const
+{
+    text.clear();
+    offsets.clear();
+    
+    const auto &wb = ws_.get_parent();
+    const auto base_date = wb.get_properties().excel_base_date;
+    const auto &cells = ws_.d_->cell_map_;
+    
+    // Formatters by style id, looked up in the workbook once for each distinct style in the range.
+    std::vector<const detail::number_formatter *> formatters;
+    
+    auto get_formatter = [&](std::size_t style_id) -> const detail::number_formatter &
+    {
+        if(formatters.size() <= style_id)
+        {
+            formatters.resize(style_id + 1, nullptr);
+        }
+        
+        if(formatters[style_id] == nullptr)
+        {
+            formatters[style_id] = &wb.get_number_formatter(style_id);
+        }
+        
+        return *formatters[style_id];
+    };
+    
+    auto render = [&](const detail::cell_impl &c)
+    {
+        switch(c.type_)
+        {
+        case cell::type::numeric:
+            get_formatter(c.style_id_).format(c.value_numeric_, base_date, text);
+            break;
+        case cell::type::string:
+        case cell::type::formula:
+        case cell::type::error:
+            get_formatter(c.style_id_).format(c.value_string_, text);
+            break;
+        case cell::type::boolean:
+            text.append(c.value_numeric_ == 0 ? "FALSE" : "TRUE");
+            break;
+        default:
+            break;
+        }
+    };
+    
+    // Stop at the last row and column holding a cell so a range such as A1:XFD1048576
+    // doesn't produce an offset for every position on the sheet.
+    const auto first_row = ref_.get_top_left().get_row();
+    const auto last_row = std::max(first_row, std::min(ref_.get_bottom_right().get_row(), ws_.get_highest_row()));
+    const auto first_column = ref_.get_top_left().get_column_index();
+    auto last_column = first_column;
+    
+    for(auto row = first_row; row <= last_row; row++)
+    {
+        auto row_match = cells.find(row);
+        
+        if(row_match != cells.end())
+        {
+            for(auto &c : row_match->second)
+            {
+                if(c.first > last_column && c.first <= ref_.get_bottom_right().get_column_index())
+                {
+                    last_column = c.first;
+                }
+            }
+        }
+    }
+    
+    offsets.reserve(static_cast<std::size_t>(last_row - first_row + 1) * (last_column - first_column + 1) + 1);
+    
+    if(order_ == major_order::row)
+    {
+        for(auto row = first_row; row <= last_row; row++)
+        {
+            auto row_match = cells.find(row);
+            
+            for(auto column = first_column; column <= last_column; column++)
+            {
+                offsets.push_back(text.size());
+                
+                if(row_match == cells.end())
+                {
+                    continue;
+                }
+                
+                auto match = row_match->second.find(column);
+                
+                if(match != row_match->second.end())
+                {
+                    render(match->second);
+                }
+            }
+        }
+    }
+    else
+    {
+        for(auto column = first_column; column <= last_column; column++)
+        {
+            for(auto row = first_row; row <= last_row; row++)
+            {
+                offsets.push_back(text.size());
+                auto row_match = cells.find(row);
+                
+                if(row_match == cells.end())
+                {
+                    continue;
+                }
+                
+                auto match = row_match->second.find(column);
+                
+                if(match != row_match->second.end())
+                {
+                    render(match->second);
+                }
+            }
+        }
+    }
+    
+    offsets.push_back(text.size());
+    
+    return range_reference(first_column, first_row, last_column, last_row);
+}
+
+long double range::sum() const
+{
+    return aggregate(*ws_.d_, ref_).sum;
+}
+
+long double range::min() const
+{
+    return aggregate(*ws_.d_, ref_).min;
+}
+
+long double range::max() const
+{
+    return aggregate(*ws_.d_, ref_).max;
+}
+
+long double range::average() const
+{
+    auto totals = aggregate(*ws_.d_, ref_);
+    
+    if(totals.numbers == 0)
+    {
+        throw data_type_exception();
+    }
+    
+    return totals.sum / totals.numbers;
+}
+
+std::size_t range::count() const
+{
+    return aggregate(*ws_.d_, ref_).numbers;
+}
+
 cell range::get_cell(const cell_reference &ref)
 {
     return (*this)[ref.get_row()][ref.get_column_index()];
@@ -4,12 +4,22 @@
 #include <xlnt/common/datetime.hpp>
 #include <xlnt/common/exceptions.hpp>
 #include <xlnt/common/relationship.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/workbook/document_properties.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
+#include "detail/cell_scan.hpp"
+#include "detail/workbook_impl.hpp"
 #include "detail/worksheet_impl.hpp"
 
 namespace xlnt {
@@ -53,9 +63,8 @@ std::string worksheet::unique_sheet_name(const std::string &value) const
 
 void worksheet::create_named_range(const std::string &name, const range_reference &reference)
 {
-    std::vector<named_range::target> targets;
-    targets.push_back({*this, reference});
-    d_->named_ranges_[name] = named_range(name, targets);
+    d_->parent_->d_->defined_names_.set(name, d_, d_, reference);
+    d_->dependencies_changed_ = true;
 }
 
 range worksheet::operator()(const xlnt::cell_reference &top_left, const xlnt::cell_reference &bottom_right)
@@ -70,7 +79,24 @@ cell worksheet::operator[](const cell_reference &ref)
 
 std::vector<range_reference> worksheet::get_merged_ranges() const
 {
-    return d_->merged_cells_;
+    return d_->merged_cells_.get_ranges();
+}
+
+bool worksheet::is_merged(const cell_reference &reference) const
+{
+    return d_->merged_cells_.find(reference.get_column_index(), reference.get_row()) != nullptr;
+}
+
+range_reference worksheet::get_merged_range(const cell_reference &reference) const
+{
+    auto match = d_->merged_cells_.find(reference.get_column_index(), reference.get_row());
+    
+    if(match == nullptr)
+    {
+        throw std::runtime_error("cell not merged");
+    }
+    
+    return *match;
 }
 
 margins &worksheet::get_page_margins()
@@ -132,7 +158,9 @@ void worksheet::garbage_collect()
 
             if(current_cell.garbage_collectible())
             {
+                d_->clear_changed_cells();
                 cell_iter = cell_map_iter->second.erase(cell_iter);
+                d_->dependencies_changed_ = true;
                 continue;
             }
 
@@ -142,6 +170,7 @@ void worksheet::garbage_collect()
         if(cell_map_iter->second.empty())
         {
             cell_map_iter = d_->cell_map_.erase(cell_map_iter);
+            d_->highest_row_ = 0;
             continue;
         }
 
@@ -173,7 +202,13 @@ std::string worksheet::get_title() const
 
 void worksheet::set_title(const std::string &title)
 {
+    auto &workbook = *d_->parent_->d_;
+    workbook.unindex_sheet(d_);
     d_->title_ = title;
+    workbook.index_sheet(d_);
+    
+    // Formulas refer to sheets by title, so the references they resolve to may have changed.
+    workbook.formula_engine_.reset();
 }
 
 cell_reference worksheet::get_frozen_panes() const
@@ -206,21 +241,53 @@ const std::unordered_map<row_t, double> &worksheet::get_row_dimensions() const
     return d_->row_dimensions_;
 }
 
-cell worksheet::get_cell(const cell_reference &reference)
+void worksheet::set_column_width(column_t column, double width)
 {
-    if(d_->cell_map_.find(reference.get_row()) == d_->cell_map_.end())
+    if(column == 0)
+    {
+        throw std::runtime_error("columns are numbered from 1");
+    }
+    
+    if(width < 0)
+    {
+        d_->column_dimensions_.erase(column);
+        d_->column_widths_.reset(column);
+        return;
+    }
+    
+    d_->column_dimensions_[column] = width;
+    d_->column_widths_.set(column, detail::dimension_index::points_to_pixels(width));
+}
+
+void worksheet::set_row_height(row_t row, double height)
+{
+    if(row == 0)
+    {
+        throw std::runtime_error("rows are numbered from 1");
+    }
+    
+    if(height < 0)
     {
-        d_->cell_map_[reference.get_row()] = std::unordered_map<column_t, detail::cell_impl>();
+        d_->row_dimensions_.erase(row);
+        d_->row_heights_.reset(row);
+        return;
     }
     
-    auto &row = d_->cell_map_[reference.get_row()];
+    d_->row_dimensions_[row] = height;
+    d_->row_heights_.set(row, detail::dimension_index::points_to_pixels(height));
+}
+
+cell worksheet::get_cell(const cell_reference &reference)
+{
+    auto &row = d_->get_row(reference.get_row());
+    auto match = row.find(reference.get_column_index());
     
-    if(row.find(reference.get_column_index()) == row.end())
+    if(match == row.end())
     {
-        row[reference.get_column_index()] = detail::cell_impl(d_, reference.get_column_index(), reference.get_row());
+        match = row.emplace(reference.get_column_index(), detail::cell_impl(d_, reference.get_column_index(), reference.get_row())).first;
     }
     
-    return cell(&row[reference.get_column_index()]);
+    return cell(&match->second);
 }
 
 const cell worksheet::get_cell(const cell_reference &reference) const
@@ -240,12 +307,14 @@ bool worksheet::has_row_properties(row_t row) const
 
 range worksheet::get_named_range(const std::string &name)
 {
-    if(!has_named_range(name))
+    auto match = d_->parent_->d_->defined_names_.find_for_sheet(name, d_);
+    
+    if(match == nullptr)
     {
         throw named_range_exception();
     }
     
-    return get_range(d_->named_ranges_[name].get_targets()[0].second);
+    return get_range(match->reference);
 }
 
 column_t worksheet::get_lowest_column() const
@@ -287,14 +356,19 @@ row_t worksheet::get_lowest_row() const
 
 row_t worksheet::get_highest_row() const
 {
-    row_t highest = 1;
-    
-    for(auto &row : d_->cell_map_)
+    if(d_->highest_row_ == 0)
     {
-        highest = std::max(highest, (row_t)row.first);
+        row_t highest = 1;
+        
+        for(auto &row : d_->cell_map_)
+        {
+            highest = std::max(highest, (row_t)row.first);
+        }
+        
+        d_->highest_row_ = highest;
     }
     
-    return highest;
+    return d_->highest_row_;
 }
 
 column_t worksheet::get_highest_column() const
@@ -359,28 +433,33 @@ relationship worksheet::create_relationship(relationship::type type, const std::
 
 void worksheet::merge_cells(const range_reference &reference)
 {
-    d_->merged_cells_.push_back(reference);
-    bool first = true;
-
-    for(auto row : get_range(reference))
+    d_->merged_cells_.add(reference);
+    
+    // Only the top-left cell keeps its value. Cells that don't exist are left that way.
+    std::vector<cell_reference> covered;
+    auto top_left = reference.get_top_left();
+    auto bottom_right = reference.get_bottom_right();
+    
+    detail::scan_cells(*d_, top_left.get_column_index(), top_left.get_row(), bottom_right.get_column_index(), bottom_right.get_row(),
+        [&](row_t row, column_t column, const detail::cell_impl &)
     {
-        for(auto cell : row)
+        if(column != top_left.get_column_index() || row != top_left.get_row())
         {
-            cell.set_merged(true);
-
-            if(!first)
-            {
-                if(cell.get_data_type() == cell::type::string)
-                {
-                    cell.set_value("");
-                }
-                else
-                {
-                    cell.clear_value();
-                }
-            }
-
-            first = false;
+            covered.push_back(cell_reference(column, row));
+        }
+    });
+    
+    for(auto &covered_reference : covered)
+    {
+        auto cell = get_cell(covered_reference);
+        
+        if(cell.get_data_type() == cell::type::string)
+        {
+            cell.set_value("");
+        }
+        else
+        {
+            cell.clear_value();
         }
     }
 }
@@ -392,22 +471,10 @@ void worksheet::merge_cells(column_t start_column, row_t start_row, column_t end
 
 void worksheet::unmerge_cells(const range_reference &reference)
 {
-    auto match = std::find(d_->merged_cells_.begin(), d_->merged_cells_.end(), reference);
-    
-    if(match == d_->merged_cells_.end())
+    if(!d_->merged_cells_.remove(reference))
     {
         throw std::runtime_error("cells not merged");
     }
-    
-    d_->merged_cells_.erase(match);
-    
-    for(auto row : get_range(reference))
-    {
-        for(auto cell : row)
-        {
-            cell.set_merged(false);
-        }
-    }
 }
     
 void worksheet::unmerge_cells(column_t start_column, row_t start_row, column_t end_column, row_t end_row)
@@ -575,17 +642,21 @@ range worksheet::operator[](const std::string &name)
 
 bool worksheet::has_named_range(const std::string &name)
 {
-    return d_->named_ranges_.find(name) != d_->named_ranges_.end();
+    return d_->parent_->d_->defined_names_.find_for_sheet(name, d_) != nullptr;
 }
 
 void worksheet::remove_named_range(const std::string &name)
 {
-    if(!has_named_range(name))
+    auto &names = d_->parent_->d_->defined_names_;
+    auto match = names.find_for_sheet(name, d_);
+    
+    if(match == nullptr)
     {
         throw std::runtime_error("worksheet doesn't have named range");
     }
 
-    d_->named_ranges_.erase(name);
+    names.remove(name, match->scope);
+    d_->dependencies_changed_ = true;
 }
 
 void worksheet::reserve(std::size_t n)
@@ -643,59 +714,34 @@ std::vector<std::string> worksheet::get_formula_attributes() const
     return {};
 }
 
-cell_reference worksheet::get_point_pos(int left, int top) const
+void worksheet::add_shared_formula(std::size_t index, const cell_reference &origin, const range_reference &reference, const std::string &formula)
 {
-    static const double DefaultColumnWidth = 51.85;
-    static const double DefaultRowHeight = 15.0;
-
-    auto points_to_pixels = [](double value, double dpi) { return (int)std::ceil(value * dpi / 72); };
-    
-    auto default_height = points_to_pixels(DefaultRowHeight, 96.0);
-    auto default_width = points_to_pixels(DefaultColumnWidth, 96.0);
-
-    column_t current_column = 1;
-    row_t current_row = 1;
-
-    int left_pos = 0;
-    int top_pos = 0;
-
-    while(left_pos <= left)
+    if(index >= d_->shared_formulas_.size())
     {
-        current_column++;
-
-        if(d_->column_dimensions_.find(current_column) != d_->column_dimensions_.end())
-        {
-            auto cdw = d_->column_dimensions_.at(current_column);
-
-            if(cdw >= 0)
-            {
-                left_pos += points_to_pixels(cdw, 96.0);
-                continue;
-            }
-        }
-
-        left_pos += default_width;
+        d_->shared_formulas_.resize(index + 1);
     }
+    
+    d_->shared_formulas_[index] = detail::shared_formula(origin, reference, formula);
+}
 
-    while(top_pos <= top)
-    {
-        current_row++;
-
-        if(d_->row_dimensions_.find(current_row) != d_->row_dimensions_.end())
-        {
-            auto cdh = d_->column_dimensions_.at(current_row);
-
-            if(cdh >= 0)
-            {
-                top_pos += points_to_pixels(cdh, 96.0);
-                continue;
-            }
-        }
+bool worksheet::has_shared_formula(std::size_t index) const
+{
+    return index < d_->shared_formulas_.size() && d_->shared_formulas_[index].defined_;
+}
 
-        top_pos += default_height;
+range_reference worksheet::get_shared_formula_reference(std::size_t index) const
+{
+    if(!has_shared_formula(index))
+    {
+        throw std::runtime_error("worksheet doesn't have shared formula");
     }
+    
+    return d_->shared_formulas_[index].reference_;
+}
 
-    return {current_column - 1, current_row - 1};
+cell_reference worksheet::get_point_pos(int left, int top) const
+{
+    return { d_->column_widths_.find(left), d_->row_heights_.find(top) };
 }
 
 cell_reference worksheet::get_point_pos(const std::pair<int, int> &point) const
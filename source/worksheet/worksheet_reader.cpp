@@ -1,5 +1,9 @@
+#include <algorithm>
+
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/common/relationship.hpp>
+#include <xlnt/reader/load_options.hpp>
 #include <xlnt/reader/worksheet_reader.hpp>
 #include <xlnt/styles/number_format.hpp>
 #include <xlnt/workbook/workbook.hpp>
@@ -10,22 +14,146 @@
 
 namespace {
     
-void read_worksheet_common(xlnt::worksheet ws, const pugi::xml_node &root_node, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids, const std::unordered_map<int, std::string> &custom_number_formats)
+// Resolves each xf of a number-format-only style table to a workbook style id.
+std::vector<std::size_t> get_style_ids(xlnt::workbook &wb, const std::vector<int> &number_format_ids, const std::unordered_map<int, std::string> &custom_number_formats)
+{
+    std::vector<std::size_t> style_ids;
+    
+    for(auto number_format_id : number_format_ids)
+    {
+        auto format = xlnt::number_format::lookup_format(number_format_id);
+        auto match = custom_number_formats.find(number_format_id);
+        
+        if(format != xlnt::number_format::format::unknown)
+        {
+            style_ids.push_back(wb.set_number_format(xlnt::number_format(format), 0));
+        }
+        else if(match != custom_number_formats.end())
+        {
+            style_ids.push_back(wb.set_number_format(xlnt::number_format(match->second), 0));
+        }
+        else
+        {
+            style_ids.push_back(0);
+        }
+    }
+    
+    return style_ids;
+}
+
+/// <summary>
+/// The column and row filters of load_options, with the selected columns turned into a table
+/// once per sheet so that each parsed cell costs a single lookup instead of a search.
+/// </summary>
+class cell_filter
+{
+public:
+    explicit cell_filter(const xlnt::load_options &options)
+        : min_row_(options.min_row),
+          max_row_(options.max_row)
+    {
+        for(auto column : options.columns)
+        {
+            if(column >= columns_.size())
+            {
+                columns_.resize(column + 1, false);
+            }
+            
+            columns_[column] = true;
+        }
+    }
+    
+    /// <summary>
+    /// Same as load_options::includes.
+    /// </summary>
+    bool includes(column_t column, row_t row) const
+    {
+        return row >= min_row_ && row <= max_row_ && includes_column(column);
+    }
+    
+    /// <summary>
+    /// Whether every cell of reference passes the filters: its rows lie between min_row and
+    /// max_row and each of its columns is selected.
+    /// </summary>
+    bool includes_range(const xlnt::range_reference &reference) const
+    {
+        if(reference.get_top_left().get_row() < min_row_ || reference.get_bottom_right().get_row() > max_row_)
+        {
+            return false;
+        }
+        
+        if(columns_.empty())
+        {
+            return true;
+        }
+        
+        if(reference.get_bottom_right().get_column_index() >= columns_.size())
+        {
+            return false;
+        }
+        
+        for(auto column = reference.get_top_left().get_column_index(); column <= reference.get_bottom_right().get_column_index(); column++)
+        {
+            if(!includes_column(column))
+            {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    /// <summary>
+    /// Narrow the rows first_row to last_row to those between min_row and max_row, and lower
+    /// last_column to the last selected column. Returns false if no row is left.
+    /// </summary>
+    bool clip(row_t &first_row, row_t &last_row, column_t &last_column) const
+    {
+        first_row = std::max(first_row, min_row_);
+        last_row = std::min(last_row, max_row_);
+        
+        if(!columns_.empty())
+        {
+            last_column = std::min(last_column, static_cast<column_t>(columns_.size() - 1));
+        }
+        
+        return first_row <= last_row;
+    }
+    
+private:
+    bool includes_column(column_t column) const
+    {
+        return columns_.empty() || (column < columns_.size() && columns_[column]);
+    }
+    
+    row_t min_row_;
+    row_t max_row_;
+    
+    // Indexed by column, empty when every column is loaded.
+    std::vector<bool> columns_;
+};
+    
+void read_worksheet_common(xlnt::worksheet ws, const pugi::xml_node &root_node, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids, const std::vector<xlnt::relationship> &relationships, const xlnt::load_options &options)
 {
-    auto dimension_node = root_node.child("dimension");
-    std::string dimension = dimension_node.attribute("ref").as_string();
-    auto full_range = xlnt::range_reference(dimension);
     auto sheet_data_node = root_node.child("sheetData");
     auto merge_cells_node = root_node.child("mergeCells");
     
+    cell_filter filter(options);
+    
     if(merge_cells_node != nullptr)
     {
         int count = merge_cells_node.attribute("count").as_int();
         
         for(auto merge_cell_node : merge_cells_node.children("mergeCell"))
         {
-            ws.merge_cells(merge_cell_node.attribute("ref").as_string());
+            xlnt::range_reference reference(merge_cell_node.attribute("ref").as_string());
             count--;
+            
+            // A range that is partly filtered out would cover cells that weren't loaded, so skip it.
+            if(filter.includes_range(reference))
+            {
+                ws.merge_cells(reference);
+            }
         }
         
         if(count != 0)
@@ -34,115 +162,135 @@ void read_worksheet_common(xlnt::worksheet ws, const pugi::xml_node &root_node,
         }
     }
     
-    for(auto row_node : sheet_data_node.children("row"))
+    bool read_formulas = !options.skip_formulas && !ws.get_parent().get_data_only();
+    
+    // The first cell of a shared formula group holds the formula text and the range it covers,
+    // the others only the group index. Groups are kept even if their first cell is filtered out.
+    auto read_shared_formula = [&](const pugi::xml_node &formula_node, const xlnt::cell_reference &reference)
     {
-        int row_index = row_node.attribute("r").as_int();
-        std::string span_string = row_node.attribute("spans").as_string();
-        auto colon_index = span_string.find(':');
+        auto ref_attribute = formula_node.attribute("ref");
         
-        column_t min_column = 0;
-        column_t max_column = 0;
+        if(ref_attribute != nullptr && std::string(formula_node.attribute("t").as_string()) == "shared")
+        {
+            auto index = static_cast<std::size_t>(formula_node.attribute("si").as_uint());
+            ws.add_shared_formula(index, reference, xlnt::range_reference(ref_attribute.as_string()), formula_node.text().as_string());
+        }
+    };
+    
+    row_t row_index = 0;
+    
+    for(auto row_node : sheet_data_node.children("row"))
+    {
+        auto row_attribute = row_node.attribute("r");
+        row_index = row_attribute != nullptr ? static_cast<row_t>(row_attribute.as_uint()) : row_index + 1;
         
-        if(colon_index != std::string::npos)
+        if(row_index < options.min_row)
         {
-            min_column = static_cast<column_t>(std::stoll(span_string.substr(0, colon_index)));
-            max_column = static_cast<column_t>(std::stoll(span_string.substr(colon_index + 1)));
+            if(read_formulas)
+            {
+                for(auto cell_node : row_node.children("c"))
+                {
+                    auto formula_node = cell_node.child("f");
+                    
+                    if(formula_node != nullptr && cell_node.attribute("r") != nullptr)
+                    {
+                        read_shared_formula(formula_node, xlnt::cell_reference(cell_node.attribute("r").as_string()));
+                    }
+                }
+            }
+            
+            continue;
         }
-        else
+        
+        if(row_index > options.max_row)
         {
-            min_column = static_cast<column_t>(full_range.get_top_left().get_column_index());
-            max_column = static_cast<column_t>(full_range.get_bottom_right().get_column_index());
+            // Rows are stored in ascending order so nothing after this can be included.
+            break;
         }
         
-        for(column_t i = min_column; i <= max_column; i++)
+        column_t column_index = 0;
+        
+        for(auto cell_node : row_node.children("c"))
         {
-            std::string address = xlnt::cell_reference::column_string_from_index(i) + std::to_string(row_index);
-            auto cell_node = row_node.find_child_by_attribute("c", "r", address.c_str());
+            auto reference_attribute = cell_node.attribute("r");
+            column_index = reference_attribute != nullptr ? xlnt::cell_reference(reference_attribute.as_string()).get_column_index() : column_index + 1;
             
-            if(cell_node != nullptr)
+            auto formula_node = cell_node.child("f");
+            bool has_formula = formula_node != nullptr;
+            bool shared_formula = has_formula && std::string(formula_node.attribute("t").as_string()) == "shared";
+            
+            if(shared_formula && read_formulas)
             {
-                bool has_value = cell_node.child("v") != nullptr;
-                std::string value_string = cell_node.child("v").text().as_string();
-                
-                bool has_type = cell_node.attribute("t") != nullptr;
-                std::string type = cell_node.attribute("t").as_string();
-                
-                bool has_style = cell_node.attribute("s") != nullptr;
-                std::string style = cell_node.attribute("s").as_string();
-                
-                bool has_formula = cell_node.child("f") != nullptr;
-                bool shared_formula = has_formula && cell_node.child("f").attribute("t") != nullptr && std::string(cell_node.child("f").attribute("t").as_string()) == "shared";
-                
-                if(has_formula && !shared_formula && !ws.get_parent().get_data_only())
-                {
-                    std::string formula = cell_node.child("f").text().as_string();
-                    ws.get_cell(address).set_formula(formula);
-                }
+                read_shared_formula(formula_node, xlnt::cell_reference(column_index, row_index));
+            }
+            
+            if(!filter.includes(column_index, row_index))
+            {
+                continue;
+            }
+            
+            auto cell = ws.get_cell(xlnt::cell_reference(column_index, row_index));
+            
+            bool has_value = cell_node.child("v") != nullptr;
+            std::string value_string = cell_node.child("v").text().as_string();
+            
+            bool has_type = cell_node.attribute("t") != nullptr;
+            std::string type = cell_node.attribute("t").as_string();
+            
+            bool has_style = cell_node.attribute("s") != nullptr;
+            
+            if(shared_formula && read_formulas)
+            {
+                auto index = static_cast<std::size_t>(formula_node.attribute("si").as_uint());
                 
-                if(has_type && type == "inlineStr") // inline string
-                {
-                    std::string inline_string = cell_node.child("is").child("t").text().as_string();
-                    ws.get_cell(address).set_value(inline_string);
-                }
-                else if(has_type && type == "s" && !has_formula) // shared string
-                {
-                    auto shared_string_index = std::stoll(value_string);
-                    auto shared_string = string_table.at(static_cast<std::size_t>(shared_string_index));
-                    ws.get_cell(address).set_value(shared_string);
-                }
-                else if(has_type && type == "b") // boolean
+                if(ws.has_shared_formula(index))
                 {
-                    ws.get_cell(address).set_value(value_string != "0");
+                    cell.set_shared_formula(index);
                 }
-                else if(has_type && type == "str")
-                {
-                    ws.get_cell(address).set_value(value_string);
-                }
-                else if(has_value)
-                {
-                    try
-                    {
-                        ws.get_cell(address).set_value(std::stold(value_string));
-                    }
-                    catch(std::invalid_argument)
-                    {
-                        ws.get_cell(address).set_value(value_string);
-                    }
-                }
-                
-                if(has_style)
+            }
+            else if(has_formula && read_formulas)
+            {
+                std::string formula = formula_node.text().as_string();
+                cell.set_formula(formula);
+            }
+            
+            if(has_type && type == "inlineStr") // inline string
+            {
+                std::string inline_string = cell_node.child("is").child("t").text().as_string();
+                cell.set_value(inline_string);
+            }
+            else if(has_type && type == "s" && !has_formula) // shared string
+            {
+                auto shared_string_index = std::stoll(value_string);
+                auto shared_string = string_table.at(static_cast<std::size_t>(shared_string_index));
+                cell.set_value(shared_string);
+            }
+            else if(has_type && type == "b") // boolean
+            {
+                cell.set_value(value_string != "0");
+            }
+            else if(has_type && type == "str")
+            {
+                cell.set_value(value_string);
+            }
+            else if(has_value)
+            {
+                try
                 {
-                    auto style_index = static_cast<std::size_t>(std::stoll(style));
-                    
-                    if(number_format_ids.size() > style_index)
-                    {
-                        auto number_format_id = number_format_ids.at(style_index);
-                        auto format = xlnt::number_format::lookup_format(number_format_id);
-                        
-                        if(format == xlnt::number_format::format::unknown)
-                        {
-                            auto match = custom_number_formats.find(number_format_id);
-                            
-                            if(match != custom_number_formats.end())
-                            {
-                                xlnt::number_format nf(match->second);
-                                auto cell = ws.get_cell(address);
-                                cell.set_number_format(nf);
-                            }
-                        }
-                        else
-                        {
-                            xlnt::number_format nf(format);
-                            auto cell = ws.get_cell(address);
-                            cell.set_number_format(nf);
-                        }
-                    }
+                    cell.set_value(std::stold(value_string));
                 }
-                else
+                catch(const std::invalid_argument &)
                 {
-                    ws.get_cell(address).set_number_format(xlnt::number_format(xlnt::number_format::format::general));
+                    cell.set_value(value_string);
                 }
             }
+            
+            if(has_style && !options.skip_styles)
+            {
+                // Cells referring to an xf that isn't in the table keep the default style.
+                auto xf_index = static_cast<std::size_t>(cell_node.attribute("s").as_uint());
+                cell.set_style_id(xf_index < style_ids.size() ? style_ids[xf_index] : 0);
+            }
         }
     }
     
@@ -153,6 +301,52 @@ void read_worksheet_common(xlnt::worksheet ws, const pugi::xml_node &root_node,
         xlnt::range_reference ref(auto_filter_node.attribute("ref").as_string());
         ws.auto_filter(ref);
     }
+    
+    auto hyperlinks_node = root_node.child("hyperlinks");
+    
+    if(hyperlinks_node != nullptr && !options.skip_hyperlinks)
+    {
+        // Each cell of a link's range is tagged, so large ranges are cut down to the cells
+        // loaded from sheetData. The first cell of a range is always kept so that a link on
+        // an empty cell isn't lost.
+        auto used = ws.calculate_dimension().get_bottom_right();
+        
+        for(auto hyperlink_node : hyperlinks_node.children("hyperlink"))
+        {
+            std::string relationship_id = hyperlink_node.attribute("r:id").as_string();
+            auto match = std::find_if(relationships.begin(), relationships.end(),
+                [&](const xlnt::relationship &r) { return r.get_id() == relationship_id; });
+            
+            // Links to locations inside the workbook have no relationship and aren't supported yet.
+            if(match == relationships.end() || match->get_target_uri().find(':') == std::string::npos)
+            {
+                continue;
+            }
+            
+            xlnt::range_reference reference(hyperlink_node.attribute("ref").as_string());
+            auto top_left = reference.get_top_left();
+            auto first_row = top_left.get_row();
+            auto last_row = std::min(reference.get_bottom_right().get_row(), std::max(used.get_row(), first_row));
+            auto first_column = top_left.get_column_index();
+            auto last_column = std::min(reference.get_bottom_right().get_column_index(), std::max(used.get_column_index(), first_column));
+            
+            if(!filter.clip(first_row, last_row, last_column))
+            {
+                continue;
+            }
+            
+            for(auto row = first_row; row <= last_row; row++)
+            {
+                for(auto column = first_column; column <= last_column; column++)
+                {
+                    if(filter.includes(column, row))
+                    {
+                        ws.get_cell(xlnt::cell_reference(column, row)).set_hyperlink(match->get_target_uri());
+                    }
+                }
+            }
+        }
+    }
 }
     
 } // namespace
@@ -160,26 +354,31 @@ void read_worksheet_common(xlnt::worksheet ws, const pugi::xml_node &root_node,
 namespace xlnt {
 
 void read_worksheet(worksheet ws, const std::string &xml_string, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids, const std::unordered_map<int, std::string> &custom_number_formats)
+{
+    read_worksheet(ws, xml_string, string_table, get_style_ids(ws.get_parent(), number_format_ids, custom_number_formats), {}, load_options());
+}
+
+void read_worksheet(worksheet ws, const std::string &xml_string, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids, const std::vector<relationship> &relationships, const load_options &options)
 {
     pugi::xml_document doc;
     doc.load(xml_string.c_str());
-    read_worksheet_common(ws, doc.child("worksheet"), string_table, number_format_ids, custom_number_formats);
+    read_worksheet_common(ws, doc.child("worksheet"), string_table, style_ids, relationships, options);
 }
 
 void read_worksheet(worksheet ws, std::istream &stream, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids, const std::unordered_map<int, std::string> &custom_number_formats)
 {
     pugi::xml_document doc;
     doc.load(stream);
-    read_worksheet_common(ws, doc.child("worksheet"), string_table, number_format_ids, custom_number_formats);
+    read_worksheet_common(ws, doc.child("worksheet"), string_table, get_style_ids(ws.get_parent(), number_format_ids, custom_number_formats), {}, load_options());
 }
 
-worksheet read_worksheet(std::istream &handle, xlnt::workbook &wb, const std::string &title, const std::vector<std::string> &string_table, const std::unordered_map<int, std::string> &custom_number_formats)
+worksheet read_worksheet(std::istream &handle, xlnt::workbook &wb, const std::string &title, const std::vector<std::string> &string_table)
 {
     auto ws = wb.create_sheet();
     ws.set_title(title);
     pugi::xml_document doc;
     doc.load(handle);
-    read_worksheet_common(ws, doc.child("worksheet"), string_table, {}, custom_number_formats);
+    read_worksheet_common(ws, doc.child("worksheet"), string_table, {}, {}, load_options());
     return ws;
 }
     
@@ -1,4 +1,5 @@
 #include <sstream>
+#include <vector>
 #include <pugixml.hpp>
 
 #include <xlnt/styles/alignment.hpp>
@@ -7,49 +8,383 @@
 #include <xlnt/styles/font.hpp>
 #include <xlnt/styles/number_format.hpp>
 #include <xlnt/styles/protection.hpp>
+#include <xlnt/styles/style.hpp>
 #include <xlnt/writer/style_writer.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/cell/cell.hpp>
 
-namespace xlnt {
+namespace {
 
-style_writer::style_writer(xlnt::workbook &wb) : wb_(wb)
+std::string fill_type_to_string(xlnt::fill::type type)
 {
-  
+    switch(type)
+    {
+    case xlnt::fill::type::solid: return "solid";
+    case xlnt::fill::type::pattern_darkdown: return "darkDown";
+    case xlnt::fill::type::pattern_darkgray: return "darkGray";
+    case xlnt::fill::type::pattern_darkgrid: return "darkGrid";
+    case xlnt::fill::type::pattern_darkhorizontal: return "darkHorizontal";
+    case xlnt::fill::type::pattern_darktrellis: return "darkTrellis";
+    case xlnt::fill::type::pattern_darkup: return "darkUp";
+    case xlnt::fill::type::pattern_darkvertical: return "darkVertical";
+    case xlnt::fill::type::pattern_gray0625: return "gray0625";
+    case xlnt::fill::type::pattern_gray125: return "gray125";
+    case xlnt::fill::type::pattern_lightdown: return "lightDown";
+    case xlnt::fill::type::pattern_lightgray: return "lightGray";
+    case xlnt::fill::type::pattern_lightgrid: return "lightGrid";
+    case xlnt::fill::type::pattern_lighthorizontal: return "lightHorizontal";
+    case xlnt::fill::type::pattern_lighttrellis: return "lightTrellis";
+    case xlnt::fill::type::pattern_lightup: return "lightUp";
+    case xlnt::fill::type::pattern_lightvertical: return "lightVertical";
+    case xlnt::fill::type::pattern_mediumgray: return "mediumGray";
+    default: return "none";
+    }
 }
 
-std::string style_writer::write_table() const
+std::string border_style_to_string(xlnt::border_style style)
 {
-    pugi::xml_document doc;
-    auto style_sheet_node = doc.append_child("styleSheet");
-    style_sheet_node.append_attribute("xmlns").set_value("http://schemas.openxmlformats.org/spreadsheetml/2006/main");
-    style_sheet_node.append_attribute("xmlns:mc").set_value("http://schemas.openxmlformats.org/markup-compatibility/2006");
-    style_sheet_node.append_attribute("mc:Ignorable").set_value("x14ac");
-    style_sheet_node.append_attribute("xmlns:x14ac").set_value("http://schemas.microsoft.com/office/spreadsheetml/2009/9/ac");
-    
-    auto num_fmts_node = style_sheet_node.append_child("numFmts");
-    auto num_fmts = wb_.get_number_formats();
-    num_fmts_node.append_attribute("count").set_value(static_cast<int>(num_fmts.size()));
-    
-    int custom_index = 164;
+    switch(style)
+    {
+    case xlnt::border_style::dashdot: return "dashDot";
+    case xlnt::border_style::dashdotdot: return "dashDotDot";
+    case xlnt::border_style::dashed: return "dashed";
+    case xlnt::border_style::dotted: return "dotted";
+    case xlnt::border_style::double_: return "double";
+    case xlnt::border_style::hair: return "hair";
+    case xlnt::border_style::medium: return "medium";
+    case xlnt::border_style::mediumdashdot: return "mediumDashDot";
+    case xlnt::border_style::mediumdashdotdot: return "mediumDashDotDot";
+    case xlnt::border_style::mediumdashed: return "mediumDashed";
+    case xlnt::border_style::slantdashdot: return "slantDashDot";
+    case xlnt::border_style::thick: return "thick";
+    case xlnt::border_style::thin: return "thin";
+    default: return "none";
+    }
+}
+
+void write_fill(pugi::xml_node fill_node, const xlnt::fill &f)
+{
+    const xlnt::fill default_fill;
     
-    for(auto &num_fmt : num_fmts)
+    if(f.type_ == xlnt::fill::type::gradient_linear || f.type_ == xlnt::fill::type::gradient_path)
     {
-        auto num_fmt_node = num_fmts_node.append_child("numFmt");
+        auto gradient_fill_node = fill_node.append_child("gradientFill");
         
-        if(num_fmt.get_format_code() == number_format::format::unknown)
+        if(f.type_ == xlnt::fill::type::gradient_path)
         {
-            num_fmt_node.append_attribute("numFmtId").set_value(custom_index++);
+            gradient_fill_node.append_attribute("type").set_value("path");
         }
         else
         {
-            num_fmt_node.append_attribute("numFmtId").set_value(num_fmt.get_format_index());
+            gradient_fill_node.append_attribute("degree").set_value(f.rotation);
+        }
+        
+        auto start_node = gradient_fill_node.append_child("stop");
+        start_node.append_attribute("position").set_value(0);
+        start_node.append_child("color").append_attribute("indexed").set_value(f.start_color.get_index());
+        
+        auto end_node = gradient_fill_node.append_child("stop");
+        end_node.append_attribute("position").set_value(1);
+        end_node.append_child("color").append_attribute("indexed").set_value(f.end_color.get_index());
+        
+        return;
+    }
+    
+    auto pattern_fill_node = fill_node.append_child("patternFill");
+    pattern_fill_node.append_attribute("patternType").set_value(fill_type_to_string(f.type_).c_str());
+    
+    // Colors left at their defaults are omitted so the reserved none and gray125 fills keep their usual form.
+    if(!(f.start_color == default_fill.start_color))
+    {
+        pattern_fill_node.append_child("fgColor").append_attribute("indexed").set_value(f.start_color.get_index());
+    }
+    
+    if(!(f.end_color == default_fill.end_color))
+    {
+        pattern_fill_node.append_child("bgColor").append_attribute("indexed").set_value(f.end_color.get_index());
+    }
+}
+
+void write_side(pugi::xml_node border_node, const char *name, const xlnt::optional<xlnt::side> &side, bool always)
+{
+    if(!side.initialized)
+    {
+        if(always)
+        {
+            border_node.append_child(name);
         }
         
-        num_fmt_node.append_attribute("formatCode").set_value(num_fmt.get_format_string().c_str());
+        return;
+    }
+    
+    auto side_node = border_node.append_child(name);
+    side_node.append_attribute("style").set_value(border_style_to_string(side.value.get_style()).c_str());
+    side_node.append_child("color").append_attribute("indexed").set_value(side.value.get_color().get_index());
+}
+
+void write_border(pugi::xml_node border_node, const xlnt::border &b)
+{
+    if(b.diagonal_up)
+    {
+        border_node.append_attribute("diagonalUp").set_value(1);
+    }
+    
+    if(b.diagonal_down)
+    {
+        border_node.append_attribute("diagonalDown").set_value(1);
+    }
+    
+    if(b.outline)
+    {
+        border_node.append_attribute("outline").set_value(1);
+    }
+    
+    // Elements must appear in schema order. The four edges and diagonal are always written, as Excel does.
+    write_side(border_node, "start", b.start, false);
+    write_side(border_node, "end", b.end, false);
+    write_side(border_node, "left", b.left, true);
+    write_side(border_node, "right", b.right, true);
+    write_side(border_node, "top", b.top, true);
+    write_side(border_node, "bottom", b.bottom, true);
+    write_side(border_node, "diagonal", b.diagonal, true);
+    write_side(border_node, "vertical", b.vertical, false);
+    write_side(border_node, "horizontal", b.horizontal, false);
+}
+
+// Built-in formats keep their reserved ids and the rest are numbered from 164 in table order,
+// so the same id is used in <numFmts> and by every xf referring to the format.
+std::vector<int> assign_number_format_ids(const std::vector<xlnt::number_format> &formats)
+{
+    std::vector<int> ids;
+    int next_custom_id = 164;
+    
+    for(auto &format : formats)
+    {
+        ids.push_back(format.get_format_index() >= 0 ? format.get_format_index() : next_custom_id++);
+    }
+    
+    return ids;
+}
+
+void write_num_fmts(pugi::xml_node parent, const std::vector<xlnt::number_format> &formats, const std::vector<int> &ids)
+{
+    std::vector<std::size_t> custom;
+    
+    for(std::size_t i = 0; i < formats.size(); i++)
+    {
+        if(formats[i].get_format_index() < 0)
+        {
+            custom.push_back(i);
+        }
+    }
+    
+    if(custom.empty())
+    {
+        return;
+    }
+    
+    auto num_fmts_node = parent.append_child("numFmts");
+    num_fmts_node.append_attribute("count").set_value(static_cast<int>(custom.size()));
+    
+    for(auto i : custom)
+    {
+        auto num_fmt_node = num_fmts_node.append_child("numFmt");
+        num_fmt_node.append_attribute("formatCode").set_value(formats[i].get_format_string().c_str());
+        num_fmt_node.append_attribute("numFmtId").set_value(ids[i]);
+    }
+}
+
+std::string underline_to_string(xlnt::font::underline underline)
+{
+    switch(underline)
+    {
+    case xlnt::font::underline::double_: return "double";
+    case xlnt::font::underline::double_accounting: return "doubleAccounting";
+    case xlnt::font::underline::single_accounting: return "singleAccounting";
+    default: return "single";
+    }
+}
+
+void write_font(pugi::xml_node font_node, const xlnt::font &f)
+{
+    // Elements must appear in schema order.
+    if(f.is_bold())
+    {
+        font_node.append_child("b");
+    }
+    
+    if(f.is_italic())
+    {
+        font_node.append_child("i");
+    }
+    
+    if(f.is_strikethrough())
+    {
+        font_node.append_child("strike");
+    }
+    
+    if(f.get_underline() != xlnt::font::underline::none)
+    {
+        font_node.append_child("u").append_attribute("val").set_value(underline_to_string(f.get_underline()).c_str());
+    }
+    
+    if(f.is_superscript() || f.is_subscript())
+    {
+        font_node.append_child("vertAlign").append_attribute("val").set_value(f.is_superscript() ? "superscript" : "subscript");
+    }
+    
+    font_node.append_child("sz").append_attribute("val").set_value(f.get_size());
+    font_node.append_child("color").append_attribute("indexed").set_value(f.get_color().get_index());
+    font_node.append_child("name").append_attribute("val").set_value(f.get_name().c_str());
+}
+
+std::string horizontal_alignment_to_string(xlnt::alignment::horizontal_alignment horizontal)
+{
+    switch(horizontal)
+    {
+    case xlnt::alignment::horizontal_alignment::left: return "left";
+    case xlnt::alignment::horizontal_alignment::right: return "right";
+    case xlnt::alignment::horizontal_alignment::center: return "center";
+    case xlnt::alignment::horizontal_alignment::center_continuous: return "centerContinuous";
+    case xlnt::alignment::horizontal_alignment::justify: return "justify";
+    default: return "general";
     }
+}
+
+std::string vertical_alignment_to_string(xlnt::alignment::vertical_alignment vertical)
+{
+    switch(vertical)
+    {
+    case xlnt::alignment::vertical_alignment::top: return "top";
+    case xlnt::alignment::vertical_alignment::center: return "center";
+    case xlnt::alignment::vertical_alignment::justify: return "justify";
+    default: return "bottom";
+    }
+}
+
+// Only properties that differ from the defaults are written, as readers assume the defaults otherwise.
+void write_alignment(pugi::xml_node alignment_node, const xlnt::alignment &a)
+{
+    const xlnt::alignment default_alignment;
+    
+    if(a.get_horizontal() != default_alignment.get_horizontal())
+    {
+        alignment_node.append_attribute("horizontal").set_value(horizontal_alignment_to_string(a.get_horizontal()).c_str());
+    }
+    
+    if(a.get_vertical() != default_alignment.get_vertical())
+    {
+        alignment_node.append_attribute("vertical").set_value(vertical_alignment_to_string(a.get_vertical()).c_str());
+    }
+    
+    if(a.get_text_rotation() != 0)
+    {
+        alignment_node.append_attribute("textRotation").set_value(a.get_text_rotation());
+    }
+    
+    if(a.get_wrap_text())
+    {
+        alignment_node.append_attribute("wrapText").set_value(1);
+    }
+    
+    if(a.get_indent() != 0)
+    {
+        alignment_node.append_attribute("indent").set_value(a.get_indent());
+    }
+    
+    if(a.get_shrink_to_fit())
+    {
+        alignment_node.append_attribute("shrinkToFit").set_value(1);
+    }
+}
+
+void write_protection(pugi::xml_node protection_node, const xlnt::protection &p)
+{
+    if(p.get_locked() != xlnt::protection::type::inherit)
+    {
+        protection_node.append_attribute("locked").set_value(p.get_locked() == xlnt::protection::type::protected_ ? 1 : 0);
+    }
+    
+    if(p.get_hidden() != xlnt::protection::type::inherit)
+    {
+        protection_node.append_attribute("hidden").set_value(p.get_hidden() == xlnt::protection::type::protected_ ? 1 : 0);
+    }
+}
+
+void write_xf(pugi::xml_node xf_node, const xlnt::style &s, int number_format_id)
+{
+    xf_node.append_attribute("numFmtId").set_value(number_format_id);
+    xf_node.append_attribute("fontId").set_value(static_cast<int>(s.get_font_index()));
+    xf_node.append_attribute("fillId").set_value(static_cast<int>(s.get_fill_index()));
+    xf_node.append_attribute("borderId").set_value(static_cast<int>(s.get_border_index()));
+    xf_node.append_attribute("xfId").set_value(0);
+    
+    if(s.quote_prefix())
+    {
+        xf_node.append_attribute("quotePrefix").set_value(1);
+    }
+    
+    if(s.pivot_button())
+    {
+        xf_node.append_attribute("pivotButton").set_value(1);
+    }
+    
+    if(number_format_id != 0)
+    {
+        xf_node.append_attribute("applyNumberFormat").set_value(1);
+    }
+    
+    if(s.get_font_index() != 0)
+    {
+        xf_node.append_attribute("applyFont").set_value(1);
+    }
+    
+    if(s.get_fill_index() != 0)
+    {
+        xf_node.append_attribute("applyFill").set_value(1);
+    }
+    
+    if(s.get_border_index() != 0)
+    {
+        xf_node.append_attribute("applyBorder").set_value(1);
+    }
+    
+    if(!(s.get_alignment() == xlnt::alignment()))
+    {
+        xf_node.append_attribute("applyAlignment").set_value(1);
+        write_alignment(xf_node.append_child("alignment"), s.get_alignment());
+    }
+    
+    if(!(s.get_protection() == xlnt::protection()))
+    {
+        xf_node.append_attribute("applyProtection").set_value(1);
+        write_protection(xf_node.append_child("protection"), s.get_protection());
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+
+style_writer::style_writer(const xlnt::workbook &wb) : wb_(wb)
+{
+  
+}
+
+std::string style_writer::write_table() const
+{
+    pugi::xml_document doc;
+    auto style_sheet_node = doc.append_child("styleSheet");
+    style_sheet_node.append_attribute("xmlns").set_value("http://schemas.openxmlformats.org/spreadsheetml/2006/main");
+    style_sheet_node.append_attribute("xmlns:mc").set_value("http://schemas.openxmlformats.org/markup-compatibility/2006");
+    style_sheet_node.append_attribute("mc:Ignorable").set_value("x14ac");
+    style_sheet_node.append_attribute("xmlns:x14ac").set_value("http://schemas.microsoft.com/office/spreadsheetml/2009/9/ac");
+    
+    const auto num_fmts = wb_.get_number_formats();
+    const auto num_fmt_ids = assign_number_format_ids(num_fmts);
+    write_num_fmts(style_sheet_node, num_fmts, num_fmt_ids);
 
     auto fonts_node = style_sheet_node.append_child("fonts");
     auto fonts = wb_.get_fonts();
@@ -58,42 +393,29 @@ std::string style_writer::write_table() const
         fonts.push_back(font());
     }
     fonts_node.append_attribute("count").set_value(static_cast<int>(fonts.size()));
-    fonts_node.append_attribute("x14ac:knownFonts").set_value(1);
     
     for(auto &f : fonts)
     {
-        auto font_node = fonts_node.append_child("font");
-        auto size_node = font_node.append_child("sz");
-        size_node.append_attribute("val").set_value(f.get_size());
-        auto color_node = font_node.append_child("color");
-        color_node.append_attribute("theme").set_value(1);
-        auto name_node = font_node.append_child("name");
-        name_node.append_attribute("val").set_value(f.get_name().c_str());
-        auto family_node = font_node.append_child("family");
-        family_node.append_attribute("val").set_value(2);
-        auto scheme_node = font_node.append_child("scheme");
-        scheme_node.append_attribute("val").set_value("minor");
-        
-        if(f.is_bold())
-        {
-            auto bold_node = font_node.append_child("b");
-            bold_node.append_attribute("val").set_value(1);
-        }
+        write_font(fonts_node.append_child("font"), f);
     }
 
     auto fills_node = style_sheet_node.append_child("fills");
-    fills_node.append_attribute("count").set_value(2);
-    fills_node.append_child("fill").append_child("patternFill").append_attribute("patternType").set_value("none");
-    fills_node.append_child("fill").append_child("patternFill").append_attribute("patternType").set_value("gray125");
+    const auto fills = wb_.get_fills();
+    fills_node.append_attribute("count").set_value(static_cast<int>(fills.size()));
+    
+    for(auto &f : fills)
+    {
+        write_fill(fills_node.append_child("fill"), f);
+    }
 
     auto borders_node = style_sheet_node.append_child("borders");
-    borders_node.append_attribute("count").set_value(1);
-    auto border_node = borders_node.append_child("border");
-    border_node.append_child("left");
-    border_node.append_child("right");
-    border_node.append_child("top");
-    border_node.append_child("bottom");
-    border_node.append_child("diagonal");
+    const auto borders = wb_.get_borders();
+    borders_node.append_attribute("count").set_value(static_cast<int>(borders.size()));
+    
+    for(auto &b : borders)
+    {
+        write_border(borders_node.append_child("border"), b);
+    }
 
     auto cell_style_xfs_node = style_sheet_node.append_child("cellStyleXfs");
     cell_style_xfs_node.append_attribute("count").set_value(1);
@@ -107,27 +429,9 @@ std::string style_writer::write_table() const
     const auto &styles = wb_.get_styles();
     cell_xfs_node.append_attribute("count").set_value(static_cast<int>(styles.size()));
     
-    custom_index = 164;
-    
     for(auto &style : styles)
     {
-        xf_node = cell_xfs_node.append_child("xf");
-        if(style.get_number_format().get_format_code() == number_format::format::unknown)
-        {
-            xf_node.append_attribute("numFmtId").set_value(custom_index++);
-        }
-        else
-        {
-            xf_node.append_attribute("numFmtId").set_value(style.get_number_format().get_format_index());
-        }
-        xf_node.append_attribute("applyNumberFormat").set_value(1);
-        xf_node.append_attribute("fontId").set_value((int)style.get_font_index());
-        xf_node.append_attribute("fillId").set_value((int)style.get_fill_index());
-        xf_node.append_attribute("borderId").set_value((int)style.get_border_index());
-        
-        auto alignment_node = xf_node.append_child("alignment");
-        alignment_node.append_attribute("vertical").set_value("top");
-        alignment_node.append_attribute("wrapText").set_value(1);
+        write_xf(cell_xfs_node.append_child("xf"), style, num_fmt_ids[style.get_number_format_index()]);
     }
 
     auto cell_styles_node = style_sheet_node.append_child("cellStyles");
@@ -163,12 +467,8 @@ std::string style_writer::write_number_formats()
     auto root = doc.append_child("styleSheet");
     root.append_attribute("xmlns").set_value("http://schemas.openxmlformats.org/spreadsheetml/2006/main");
     
-    auto num_fmts_node = root.append_child("numFmts");
-    num_fmts_node.append_attribute("count").set_value(1);
-    
-    auto num_fmt_node = num_fmts_node.append_child("numFmt");
-    num_fmt_node.append_attribute("formatCode").set_value("YYYY");
-    num_fmt_node.append_attribute("numFmtId").set_value(164);
+    const auto num_fmts = wb_.get_number_formats();
+    write_num_fmts(root, num_fmts, assign_number_format_ids(num_fmts));
     
     std::stringstream ss;
     doc.save(ss);
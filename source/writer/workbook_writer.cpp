@@ -41,7 +41,7 @@ std::string datetime_to_w3cdtf(const xlnt::datetime &dt)
 
 namespace xlnt {
 
-excel_writer::excel_writer(workbook &wb) : wb_(wb), style_writer_(wb_)
+excel_writer::excel_writer(const workbook &wb) : wb_(wb), style_writer_(wb_)
 {
 }
 
@@ -713,14 +713,14 @@ std::string write_defined_names(const xlnt::workbook &wb)
     return stream.str();
 }
 
-bool save_workbook(workbook &wb, const std::string &filename, bool as_template)
+bool save_workbook(const workbook &wb, const std::string &filename, bool as_template)
 {
     excel_writer writer(wb);
     writer.save(filename, as_template);
     return true;
 }
 
-std::vector<std::uint8_t> save_virtual_workbook(xlnt::workbook &wb, bool as_template)
+std::vector<std::uint8_t> save_virtual_workbook(const xlnt::workbook &wb, bool as_template)
 {
     zip_file archive;
     excel_writer writer(wb);
@@ -23,6 +23,46 @@ bool is_integral(long double d)
 {
     return d == static_cast<long long int>(d);
 }
+
+// The first cell written from a shared formula group carries the formula text and the
+// group's range. Later cells only refer to the group by index. If the group's first cell was
+// overwritten or detached, the range starts at the first cell still in the group instead, since
+// readers take the cell holding the text to be its top left. Cells of the group that fall
+// outside that range are written with their own translated formula.
+void write_formula(const xlnt::cell &cell, pugi::xml_node cell_node, std::unordered_map<std::size_t, xlnt::range_reference> &shared_formula_ranges)
+{
+    auto formula_node = cell_node.append_child("f");
+    
+    if(!cell.has_shared_formula())
+    {
+        formula_node.text().set(cell.get_formula().c_str());
+        return;
+    }
+    
+    auto index = cell.get_shared_formula_index();
+    auto match = shared_formula_ranges.find(index);
+    
+    if(match == shared_formula_ranges.end())
+    {
+        auto reference = cell.get_parent().get_shared_formula_reference(index);
+        reference = xlnt::range_reference(cell.get_reference(), reference.get_bottom_right());
+        shared_formula_ranges[index] = reference;
+        
+        formula_node.append_attribute("t").set_value("shared");
+        formula_node.append_attribute("ref").set_value(reference.to_string().c_str());
+        formula_node.append_attribute("si").set_value(static_cast<unsigned int>(index));
+        formula_node.text().set(cell.get_formula().c_str());
+    }
+    else if(match->second.get_top_left().get_column_index() <= cell.get_reference().get_column_index())
+    {
+        formula_node.append_attribute("t").set_value("shared");
+        formula_node.append_attribute("si").set_value(static_cast<unsigned int>(index));
+    }
+    else
+    {
+        formula_node.text().set(cell.get_formula().c_str());
+    }
+}
     
 } // namepsace
 
@@ -127,6 +167,8 @@ std::string write_worksheet(worksheet ws, const std::vector<std::string> &string
     
     auto sheet_data_node = root_node.append_child("sheetData");
     
+    std::unordered_map<std::size_t, range_reference> shared_formula_ranges;
+    
     for(auto row : ws.rows())
     {
         row_t min = static_cast<row_t>(row.num_cells());
@@ -185,7 +227,7 @@ std::string write_worksheet(worksheet ws, const std::vector<std::string> &string
                     if(cell.has_formula())
                     {
                         cell_node.append_attribute("t").set_value("str");
-                        cell_node.append_child("f").text().set(cell.get_formula().c_str());
+                        write_formula(cell, cell_node, shared_formula_ranges);
                         cell_node.append_child("v").text().set(cell.to_string().c_str());
                         continue;
                     }
@@ -228,14 +270,31 @@ std::string write_worksheet(worksheet ws, const std::vector<std::string> &string
                         if(cell.get_data_type() == cell::type::boolean)
                         {
                             cell_node.append_attribute("t").set_value("b");
+                            
+                            if(cell.has_formula())
+                            {
+                                write_formula(cell, cell_node, shared_formula_ranges);
+                            }
+                            
                             auto value_node = cell_node.append_child("v");
                             value_node.text().set(cell.get_value<bool>() ? 1 : 0);
                         }
+                        else if(cell.get_data_type() == cell::type::error)
+                        {
+                            cell_node.append_attribute("t").set_value("e");
+                            
+                            if(cell.has_formula())
+                            {
+                                write_formula(cell, cell_node, shared_formula_ranges);
+                            }
+                            
+                            cell_node.append_child("v").text().set(cell.get_value<std::string>().c_str());
+                        }
                         else if(cell.get_data_type() == cell::type::numeric)
                         {
                             if(cell.has_formula())
                             {
-                                cell_node.append_child("f").text().set(cell.get_formula().c_str());
+                                write_formula(cell, cell_node, shared_formula_ranges);
                                 cell_node.append_child("v").text().set(cell.to_string().c_str());
                                 continue;
                             }
@@ -258,7 +317,7 @@ std::string write_worksheet(worksheet ws, const std::vector<std::string> &string
                     }
                     else if(cell.has_formula())
                     {
-                        cell_node.append_child("f").text().set(cell.get_formula().c_str());
+                        write_formula(cell, cell_node, shared_formula_ranges);
                         cell_node.append_child("v");
                         continue;
                     }
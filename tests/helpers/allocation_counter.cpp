@@ -0,0 +1,52 @@
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.hpp"
+
+// These replace the global allocation functions for the whole program, so this file must be
+// linked into a program at most once and the definitions must not move into the header.
+
+std::atomic<std::size_t> &global_allocation_count()
+{
+    static std::atomic<std::size_t> count(0);
+    return count;
+}
+
+void *operator new(std::size_t size)
+{
+    global_allocation_count()++;
+
+    auto pointer = std::malloc(size == 0 ? 1 : size);
+
+    if(pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Incremented by the replacement operator new in allocation_counter.cpp, which must be linked
+// into any program including this header. Atomic because formula calculation may allocate
+// from several threads.
+std::atomic<std::size_t> &global_allocation_count();
+
+/// <summary>
+/// Counts calls to the global operator new made since construction.
+/// </summary>
+class AllocationCounter
+{
+public:
+    AllocationCounter() : start_(global_allocation_count())
+    {
+    }
+
+    std::size_t GetCount() const
+    {
+        return global_allocation_count() - start_;
+    }
+
+private:
+    const std::size_t start_;
+};
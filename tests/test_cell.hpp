@@ -404,6 +404,116 @@ public:
         TS_ASSERT(cell.get_fill() == fill);
     }
     
+    void test_to_string()
+    {
+        auto ws = wb.create_sheet();
+        
+        auto a1 = ws.get_cell("A1");
+        a1.set_value(xlnt::datetime(2010, 7, 13, 6, 37, 41));
+        TS_ASSERT_EQUALS(a1.to_string(), "2010-07-13 6:37:41");
+        
+        auto a2 = ws.get_cell("A2");
+        a2.set_value(xlnt::date(2010, 7, 13));
+        TS_ASSERT_EQUALS(a2.to_string(), "2010-07-13");
+        a2.set_number_format(xlnt::number_format("dddd d mmm yy"));
+        TS_ASSERT_EQUALS(a2.to_string(), "Tuesday 13 Jul 10");
+        
+        auto a3 = ws.get_cell("A3");
+        a3.set_value(xlnt::time(1, 3, 9));
+        a3.set_number_format(xlnt::number_format("hh:mm:ss"));
+        TS_ASSERT_EQUALS(a3.to_string(), "01:03:09");
+        
+        auto a4 = ws.get_cell("A4");
+        a4.set_value(42);
+        TS_ASSERT_EQUALS(a4.to_string(), "42");
+        
+        auto a5 = ws.get_cell("A5");
+        a5.set_value("text");
+        TS_ASSERT_EQUALS(a5.to_string(), "text");
+        a5.set_number_format(xlnt::number_format("\"[\"@\"]\""));
+        TS_ASSERT_EQUALS(a5.to_string(), "[text]");
+        a5.set_number_format(xlnt::number_format("0.00"));
+        TS_ASSERT_EQUALS(a5.to_string(), "text");
+        
+        // Every cell sharing a format uses the same compiled formatter.
+        for(row_t row = 10; row < 20; row++)
+        {
+            auto cell = ws.get_cell(xlnt::cell_reference(1, row));
+            cell.set_value(xlnt::date(2015, 1, static_cast<int>(row)));
+            cell.set_number_format(xlnt::number_format("d/m/yyyy"));
+            TS_ASSERT_EQUALS(cell.to_string(), std::to_string(row) + "/1/2015");
+        }
+    }
+    
+    void test_style_interning()
+    {
+        auto ws = wb.create_sheet();
+        auto styles_before = wb.get_styles().size();
+        
+        xlnt::number_format formats[] = { xlnt::number_format::format::percentage, xlnt::number_format::format::date_xlsx14, xlnt::number_format::format::number_00 };
+        
+        for(row_t row = 1; row <= 300; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(1, row)).set_number_format(formats[row % 3]);
+        }
+        
+        TS_ASSERT_EQUALS(wb.get_styles().size(), styles_before + 3);
+        TS_ASSERT_EQUALS(ws.get_cell("A3").get_style_id(), ws.get_cell("A6").get_style_id());
+        TS_ASSERT_DIFFERS(ws.get_cell("A3").get_style_id(), ws.get_cell("A4").get_style_id());
+        TS_ASSERT_EQUALS(ws.get_cell("A4").get_number_format(), formats[1]);
+    }
+    
+    void test_style_components()
+    {
+        auto ws = wb.create_sheet();
+        
+        xlnt::font bold;
+        bold.set_bold(true);
+        
+        xlnt::alignment wrapped;
+        wrapped.set_wrap_text(true);
+        
+        xlnt::protection unlocked;
+        unlocked.set_locked(false);
+        
+        xlnt::fill solid;
+        solid.type_ = xlnt::fill::type::solid;
+        
+        xlnt::border bordered;
+        bordered.top.initialized = true;
+        bordered.top.value = xlnt::side(xlnt::border_style::thin);
+        
+        auto a1 = ws.get_cell("A1");
+        a1.set_number_format(xlnt::number_format::format::percentage);
+        a1.set_font(bold);
+        a1.set_alignment(wrapped);
+        a1.set_protection(unlocked);
+        a1.set_fill(solid);
+        a1.set_border(bordered);
+        
+        TS_ASSERT(a1.get_font().is_bold());
+        TS_ASSERT(a1.get_alignment() == wrapped);
+        TS_ASSERT(a1.get_protection() == unlocked);
+        TS_ASSERT(a1.get_fill() == solid);
+        TS_ASSERT(a1.get_border() == bordered);
+        TS_ASSERT_EQUALS(a1.get_number_format(), xlnt::number_format(xlnt::number_format::format::percentage));
+        
+        auto b1 = ws.get_cell("B1");
+        b1.set_font(bold);
+        b1.set_number_format(xlnt::number_format::format::percentage);
+        b1.set_border(bordered);
+        b1.set_fill(solid);
+        b1.set_protection(unlocked);
+        b1.set_alignment(wrapped);
+        
+        TS_ASSERT_EQUALS(a1.get_style_id(), b1.get_style_id());
+        
+        auto c1 = ws.get_cell("C1");
+        TS_ASSERT(!c1.get_font().is_bold());
+        TS_ASSERT(!(c1.get_border() == bordered));
+        TS_ASSERT(c1.get_protection() == xlnt::protection());
+    }
+    
     void _test_border()
     {
         xlnt::border border;
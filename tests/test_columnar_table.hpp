@@ -0,0 +1,297 @@
+#pragma once
+
+#include <iostream>
+#include <cxxtest/TestSuite.h>
+
+#include <xlnt/xlnt.hpp>
+#include <xlnt/worksheet/columnar_table.hpp>
+
+class test_columnar_table : public CxxTest::TestSuite
+{
+public:
+    void test_column_types()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(1.5);
+        ws.get_cell("A3").set_value(3);
+        ws.get_cell("B1").set_value(true);
+        ws.get_cell("B2").set_value(false);
+        ws.get_cell("C1").set_value("red");
+        ws.get_cell("C2").set_value("blue");
+        ws.get_cell("C3").set_value("red");
+        ws.get_cell("D1").set_value("=SUM(A1:A3)");
+        ws.get_cell("D2").set_value("#N/A");
+        ws.get_cell("D3").set_value(2);
+
+        auto table = xlnt::columnar_table::from_worksheet(ws, "A1:E3");
+
+        TS_ASSERT_EQUALS(table.get_row_count(), 3);
+        TS_ASSERT_EQUALS(table.get_column_count(), 5);
+
+        auto &numbers = table.get_column(0);
+        TS_ASSERT_EQUALS(numbers.name, "A");
+        TS_ASSERT_EQUALS(numbers.type, xlnt::columnar_type::float64);
+        TS_ASSERT_EQUALS(numbers.null_count, 1);
+        TS_ASSERT(numbers.is_valid(0));
+        TS_ASSERT(!numbers.is_valid(1));
+        TS_ASSERT_EQUALS(numbers.values[0], 1.5);
+        TS_ASSERT_EQUALS(numbers.values[2], 3);
+
+        auto &booleans = table.get_column(1);
+        TS_ASSERT_EQUALS(booleans.type, xlnt::columnar_type::boolean);
+        TS_ASSERT_EQUALS(booleans.booleans[0], 1);
+
+        auto &strings = table.get_column(2);
+        TS_ASSERT_EQUALS(strings.type, xlnt::columnar_type::dictionary);
+        TS_ASSERT_EQUALS(strings.indices[0], strings.indices[2]);
+        TS_ASSERT_EQUALS(table.get_dictionary_value(strings.indices[1]), "blue");
+
+        auto &mixed = table.get_column(3);
+        TS_ASSERT_EQUALS(mixed.type, xlnt::columnar_type::dictionary);
+        TS_ASSERT_EQUALS(table.get_dictionary_value(mixed.indices[0]), "=SUM(A1:A3)");
+        TS_ASSERT_EQUALS(table.get_dictionary_value(mixed.indices[1]), "#N/A");
+        TS_ASSERT_EQUALS(table.get_dictionary_value(mixed.indices[2]), "2");
+
+        TS_ASSERT_EQUALS(table.get_column(4).type, xlnt::columnar_type::null);
+        TS_ASSERT_EQUALS(table.get_column(4).null_count, 3);
+        TS_ASSERT_EQUALS(table.get_dictionary_size(), 5);
+    }
+
+    void test_round_trip()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(42);
+        ws.get_cell("B1").set_value("text");
+        ws.get_cell("B2").set_value("=A1*2");
+        ws.get_cell("C2").set_value(true);
+
+        auto table = xlnt::columnar_table::from_worksheet(ws);
+        auto ws2 = wb.create_sheet();
+        ws2.get_cell("G5").set_value("stale");
+        table.to_worksheet(ws2, "F4");
+
+        TS_ASSERT_EQUALS(ws2.get_cell("F4").get_value<int>(), 42);
+        TS_ASSERT_EQUALS(ws2.get_cell("G4").get_value<std::string>(), "text");
+        TS_ASSERT(ws2.get_cell("G5").has_formula());
+        TS_ASSERT_EQUALS(ws2.get_cell("H5").get_data_type(), xlnt::cell::type::boolean);
+        TS_ASSERT(ws2.get_cell("H5").get_value<bool>());
+        TS_ASSERT_EQUALS(ws2.get_cell("H4").get_data_type(), xlnt::cell::type::null);
+        TS_ASSERT_EQUALS(ws2.get_cell_collection().size(), 5);
+    }
+
+    void test_write_replaces_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(1);
+        ws.get_cell("A1").set_hyperlink("http://example.com");
+        ws.get_cell("A1").set_number_format(xlnt::number_format(xlnt::number_format::format::percentage));
+        ws.get_cell("A2").set_value(2);
+        ws.get_cell("A2").set_hyperlink("http://example.com");
+
+        xlnt::columnar_table table;
+        xlnt::columnar_column column;
+        column.type = xlnt::columnar_type::dictionary;
+        column.length = 2;
+        column.validity = { 1 };
+        column.indices = { table.intern("#N/A"), 0 };
+        table.add_column(column);
+        table.to_worksheet(ws, "A1");
+
+        // Text that looks like an error is still a string, as it was when exported.
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_data_type(), xlnt::cell::type::string);
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_value<std::string>(), "#N/A");
+        TS_ASSERT(!ws.get_cell("A1").has_hyperlink());
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_style_id(), 0);
+        TS_ASSERT_EQUALS(ws.get_cell("A2").get_data_type(), xlnt::cell::type::null);
+        TS_ASSERT(!ws.get_cell("A2").has_hyperlink());
+    }
+
+    void test_round_trip_errors_and_shared_formulas()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_error("#N/A");
+        ws.get_cell("A2").set_value("text");
+        ws.add_shared_formula(0, "B1", "B1:B2", "A1*2");
+        ws.get_cell("B1").set_shared_formula(0);
+        ws.get_cell("B2").set_shared_formula(0);
+
+        auto table = xlnt::columnar_table::from_worksheet(ws, "A1:B2");
+        TS_ASSERT(table.get_column(0).is_error(0));
+        TS_ASSERT(!table.get_column(0).is_error(1));
+        TS_ASSERT_EQUALS(table.get_dictionary_value(table.get_column(1).indices[1]), "=A2*2");
+
+        auto ws2 = wb.create_sheet();
+        table.to_worksheet(ws2, "A1");
+
+        TS_ASSERT_EQUALS(ws2.get_cell("A1").get_data_type(), xlnt::cell::type::error);
+        TS_ASSERT_EQUALS(ws2.get_cell("A1").get_value<std::string>(), "#N/A");
+        TS_ASSERT_EQUALS(ws2.get_cell("A2").get_data_type(), xlnt::cell::type::string);
+        TS_ASSERT(ws2.get_cell("B2").has_formula());
+        TS_ASSERT_EQUALS(ws2.get_cell("B2").get_formula(), "=A2*2");
+    }
+
+    void test_recalculate_after_import()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(1);
+        ws.get_cell("A2").set_value(2);
+        ws.get_cell("B1").set_formula("=A1*10");
+        ws.get_cell("B2").set_formula("=SUM(A1:A2)");
+        ws.get_cell("C1").set_formula("=A2+1");
+        ws.get_cell("D1").set_formula("=C1*2");
+        wb.calculate();
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<int>(), 6);
+
+        xlnt::columnar_table values;
+        xlnt::columnar_column column;
+        column.type = xlnt::columnar_type::float64;
+        column.length = 2;
+        column.validity = { 3 };
+        column.values = { 5, 6 };
+        values.add_column(column);
+        values.to_worksheet(ws, "A1");
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<int>(), 50);
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_value<int>(), 11);
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<int>(), 14);
+
+        // Clearing a formula leaves the cells reading it with nothing to read.
+        xlnt::columnar_table nulls;
+        xlnt::columnar_column empty;
+        empty.length = 1;
+        empty.validity = { 0 };
+        nulls.add_column(empty);
+        nulls.to_worksheet(ws, "C1");
+        wb.recalculate();
+
+        TS_ASSERT(!ws.get_cell("C1").has_formula());
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<int>(), 0);
+    }
+
+    void test_arrow_round_trip()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(1);
+        ws.get_cell("A2").set_value(2);
+        ws.get_cell("B1").set_value("x");
+        ws.get_cell("C2").set_value(false);
+
+        ArrowSchema schema;
+        ArrowArray array;
+
+        {
+            auto table = xlnt::columnar_table::from_worksheet(ws, "A1:D2");
+            table.to_arrow(&schema, &array);
+        }
+
+        TS_ASSERT_EQUALS(std::string(schema.format), "+s");
+        TS_ASSERT_EQUALS(schema.n_children, 4);
+        TS_ASSERT_EQUALS(std::string(schema.children[0]->format), "g");
+        TS_ASSERT_EQUALS(std::string(schema.children[1]->format), "i");
+        TS_ASSERT_EQUALS(std::string(schema.children[1]->dictionary->format), "u");
+        TS_ASSERT_EQUALS(std::string(schema.children[2]->format), "b");
+        TS_ASSERT_EQUALS(std::string(schema.children[3]->format), "n");
+        TS_ASSERT_EQUALS(array.length, 2);
+        TS_ASSERT_EQUALS(array.children[1]->null_count, 1);
+        TS_ASSERT_EQUALS(static_cast<const double *>(array.children[0]->buffers[1])[1], 2);
+
+        auto imported = xlnt::columnar_table::from_arrow(&schema, &array);
+
+        schema.release(&schema);
+        array.release(&array);
+        TS_ASSERT(schema.release == nullptr);
+        TS_ASSERT(array.release == nullptr);
+
+        TS_ASSERT_EQUALS(imported.get_row_count(), 2);
+        TS_ASSERT_EQUALS(imported.get_column(0).values[1], 2);
+        TS_ASSERT_EQUALS(imported.get_column(1).name, "B");
+        TS_ASSERT_EQUALS(imported.get_dictionary_value(imported.get_column(1).indices[0]), "x");
+        TS_ASSERT(!imported.get_column(1).is_valid(1));
+        TS_ASSERT(imported.get_column(2).is_valid(1));
+        TS_ASSERT_EQUALS(imported.get_column(3).type, xlnt::columnar_type::null);
+    }
+
+    void test_arrow_dictionary_index_out_of_range()
+    {
+        const char *values = "ab";
+        std::int32_t offsets[] = { 0, 1, 2 };
+        std::int32_t keys[] = { 0, 2 };
+
+        ArrowSchema dictionary_schema = {};
+        dictionary_schema.format = "u";
+        ArrowArray dictionary = {};
+        dictionary.length = 2;
+        dictionary.n_buffers = 3;
+        const void *dictionary_buffers[] = { nullptr, offsets, values };
+        dictionary.buffers = dictionary_buffers;
+
+        ArrowSchema column_schema = {};
+        column_schema.format = "i";
+        column_schema.name = "A";
+        column_schema.dictionary = &dictionary_schema;
+        ArrowArray column = {};
+        column.length = 2;
+        column.n_buffers = 2;
+        const void *column_buffers[] = { nullptr, keys };
+        column.buffers = column_buffers;
+        column.dictionary = &dictionary;
+
+        ArrowSchema *schema_children[] = { &column_schema };
+        ArrowSchema schema = {};
+        schema.format = "+s";
+        schema.n_children = 1;
+        schema.children = schema_children;
+        ArrowArray *array_children[] = { &column };
+        ArrowArray array = {};
+        array.length = 2;
+        array.n_buffers = 1;
+        const void *array_buffers[] = { nullptr };
+        array.buffers = array_buffers;
+        array.n_children = 1;
+        array.children = array_children;
+
+        TS_ASSERT_THROWS(xlnt::columnar_table::from_arrow(&schema, &array), std::runtime_error);
+
+        keys[1] = -1;
+        TS_ASSERT_THROWS(xlnt::columnar_table::from_arrow(&schema, &array), std::runtime_error);
+
+        keys[1] = 1;
+        auto imported = xlnt::columnar_table::from_arrow(&schema, &array);
+        TS_ASSERT_EQUALS(imported.get_dictionary_value(imported.get_column(0).indices[1]), "b");
+    }
+
+    void test_add_column()
+    {
+        xlnt::columnar_table table;
+
+        xlnt::columnar_column column;
+        column.type = xlnt::columnar_type::dictionary;
+        column.length = 2;
+        column.validity = { 3 };
+        column.indices = { table.intern("a"), table.intern("b") };
+        table.add_column(column);
+
+        TS_ASSERT_EQUALS(table.get_row_count(), 2);
+        TS_ASSERT_EQUALS(table.intern("a"), 0);
+
+        column.indices[1] = 7;
+        TS_ASSERT_THROWS(table.add_column(column), std::runtime_error);
+
+        column.indices[1] = 1;
+        column.length = 3;
+        TS_ASSERT_THROWS(table.add_column(column), std::runtime_error);
+    }
+};
@@ -11,4 +11,57 @@ public:
     test_datetime()
     {
     }
+
+    void test_date_from_number()
+    {
+        TS_ASSERT(xlnt::date::from_number(1, xlnt::calendar::windows_1900) == xlnt::date(1900, 1, 1));
+        TS_ASSERT(xlnt::date::from_number(59, xlnt::calendar::windows_1900) == xlnt::date(1900, 2, 28));
+        TS_ASSERT(xlnt::date::from_number(60, xlnt::calendar::windows_1900) == xlnt::date(1900, 2, 29));
+        TS_ASSERT(xlnt::date::from_number(61, xlnt::calendar::windows_1900) == xlnt::date(1900, 3, 1));
+        TS_ASSERT(xlnt::date::from_number(36526, xlnt::calendar::windows_1900) == xlnt::date(2000, 1, 1));
+        TS_ASSERT(xlnt::date::from_number(2958465, xlnt::calendar::windows_1900) == xlnt::date(9999, 12, 31));
+        TS_ASSERT(xlnt::date::from_number(0, xlnt::calendar::mac_1904) == xlnt::date(1904, 1, 1));
+        TS_ASSERT(xlnt::date::from_number(35064, xlnt::calendar::mac_1904) == xlnt::date(2000, 1, 1));
+    }
+
+    void test_date_round_trip()
+    {
+        for(int serial = 1; serial < 80000; serial++)
+        {
+            auto date = xlnt::date::from_number(serial, xlnt::calendar::windows_1900);
+            TS_ASSERT_EQUALS(date.to_number(xlnt::calendar::windows_1900), serial);
+        }
+    }
+
+    void test_datetime_from_number()
+    {
+        TS_ASSERT(xlnt::datetime::from_number(40000.5, xlnt::calendar::windows_1900) == xlnt::datetime(2009, 7, 6, 12));
+        TS_ASSERT(xlnt::datetime::from_number(0.75, xlnt::calendar::mac_1904) == xlnt::datetime(1904, 1, 1, 18));
+        TS_ASSERT(xlnt::time::from_number(0.5) == xlnt::time(12, 0, 0, 0));
+
+        xlnt::datetime original(2015, 8, 14, 23, 59, 59, 999999);
+        auto number = original.to_number(xlnt::calendar::windows_1900);
+        TS_ASSERT(xlnt::datetime::from_number(number, xlnt::calendar::windows_1900) == original);
+    }
+
+    void test_from_numbers()
+    {
+        std::vector<long double> numbers = { 1, 60.25, 61, 42000.125 };
+
+        for(auto calendar : { xlnt::calendar::windows_1900, xlnt::calendar::mac_1904 })
+        {
+            auto datetimes = xlnt::datetime::from_numbers(numbers, calendar);
+            TS_ASSERT_EQUALS(datetimes.size(), numbers.size());
+
+            for(std::size_t i = 0; i < numbers.size(); i++)
+            {
+                TS_ASSERT(datetimes[i] == xlnt::datetime::from_number(numbers[i], calendar));
+            }
+        }
+
+        auto dates = xlnt::date::from_numbers({ 59, 60, 61 }, xlnt::calendar::windows_1900);
+        TS_ASSERT_EQUALS(dates.size(), 3);
+        TS_ASSERT(dates[1] == xlnt::date(1900, 2, 29));
+        TS_ASSERT(dates[2] == xlnt::date(1900, 3, 1));
+    }
 };
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <iostream>
+#include <cxxtest/TestSuite.h>
+
+#include <xlnt/xlnt.hpp>
+#include "helpers/path_helper.hpp"
+
+class test_formula : public CxxTest::TestSuite
+{
+public:
+    void test_tokenize()
+    {
+        using type = xlnt::tokenizer::token_type;
+        using subtype = xlnt::tokenizer::token_subtype;
+
+        xlnt::tokenizer t("=SUM('My Sheet'!$A$1:B2, -1.5E+3, \"a\"\"b\", {1,2;3,4}) * 10% <> #N/A");
+        auto &tokens = t.get_tokens();
+
+        std::vector<std::string> values;
+        for(auto &token : tokens)
+        {
+            values.push_back(t.get_value(token));
+        }
+
+        std::vector<std::string> expected = { "SUM(", "'My Sheet'!$A$1:B2", ",", " ", "-", "1.5E+3", ",", " ", "\"a\"\"b\"", ",", " ",
+            "{", "1", ",", "2", ";", "3", ",", "4", "}", ")", " ", "*", " ", "10", "%", " ", "<>", " ", "#N/A" };
+        TS_ASSERT_EQUALS(values, expected);
+
+        TS_ASSERT_EQUALS(tokens[0].type, type::function);
+        TS_ASSERT_EQUALS(tokens[0].subtype, subtype::open);
+        TS_ASSERT_EQUALS(tokens[1].subtype, subtype::range);
+        TS_ASSERT_EQUALS(tokens[2].type, type::separator);
+        TS_ASSERT_EQUALS(tokens[4].type, type::prefix_operator);
+        TS_ASSERT_EQUALS(tokens[5].subtype, subtype::number);
+        TS_ASSERT_EQUALS(tokens[8].subtype, subtype::text);
+        TS_ASSERT_EQUALS(tokens[15].subtype, subtype::row);
+        TS_ASSERT_EQUALS(tokens[20].type, type::function);
+        TS_ASSERT_EQUALS(tokens[20].subtype, subtype::close);
+        TS_ASSERT_EQUALS(tokens[22].type, type::infix_operator);
+        TS_ASSERT_EQUALS(tokens[25].type, type::postfix_operator);
+        TS_ASSERT_EQUALS(tokens[29].subtype, subtype::error);
+        TS_ASSERT(t.equals(tokens[27], "<>"));
+    }
+
+    void test_tokenize_literal()
+    {
+        xlnt::tokenizer t("not a formula");
+        TS_ASSERT_EQUALS(t.get_tokens().size(), 1);
+        TS_ASSERT_EQUALS(t.get_tokens()[0].type, xlnt::tokenizer::token_type::literal);
+        TS_ASSERT(xlnt::tokenizer("").get_tokens().empty());
+    }
+
+    void test_tokenize_invalid()
+    {
+        TS_ASSERT_THROWS(xlnt::tokenizer("=SUM(A1"), xlnt::formula_syntax_exception);
+        TS_ASSERT_THROWS(xlnt::tokenizer("=A1)"), xlnt::formula_syntax_exception);
+        TS_ASSERT_THROWS(xlnt::tokenizer("=\"abc"), xlnt::formula_syntax_exception);
+        TS_ASSERT_THROWS(xlnt::tokenizer("=#BAD!"), xlnt::formula_syntax_exception);
+    }
+
+    void test_translate_formula()
+    {
+        xlnt::translator translator("=SUM(A1:$B$2, Sheet2!C$3, $D4) + Total + LOG10(2) + 'Q1 ''15'!E5", "B2");
+
+        TS_ASSERT_EQUALS(translator.translate_formula("D5"),
+            "=SUM(C4:$B$2, Sheet2!E$3, $D7) + Total + LOG10(2) + 'Q1 ''15'!G8");
+        TS_ASSERT_EQUALS(translator.translate_formula("B2"),
+            "=SUM(A1:$B$2, Sheet2!C$3, $D4) + Total + LOG10(2) + 'Q1 ''15'!E5");
+        TS_ASSERT_EQUALS(translator.translate_formula("A1"),
+            "=SUM(#REF!, Sheet2!B$3, $D3) + Total + LOG10(2) + 'Q1 ''15'!D4");
+    }
+
+    void test_translate_range()
+    {
+        TS_ASSERT_EQUALS(xlnt::translator::translate_range("A:C", 5, 1), "B:D");
+        TS_ASSERT_EQUALS(xlnt::translator::translate_range("$3:5", 2, 7), "$3:7");
+        TS_ASSERT_EQUALS(xlnt::translator::translate_range("Sheet1!A1:Sheet1!B2", 1, 1), "Sheet1!B2:Sheet1!C3");
+        TS_ASSERT_EQUALS(xlnt::translator::translate_range("Sheet1!A1", -1, 0), "Sheet1!#REF!");
+        TS_ASSERT_EQUALS(xlnt::translator::translate_range("Table1[Amount]", 1, 1), "Table1[Amount]");
+        TS_ASSERT_EQUALS(xlnt::translator::translate_row("7", -2), "5");
+        TS_ASSERT_EQUALS(xlnt::translator::translate_col("Z", 1), "AA");
+
+        auto split = xlnt::translator::strip_ws_name("'A!B'!C3");
+        TS_ASSERT_EQUALS(split.first, "'A!B'!");
+        TS_ASSERT_EQUALS(split.second, "C3");
+    }
+
+    void test_calculate()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        ws.set_title("Data");
+        auto other = wb.create_sheet("Other Sheet");
+
+        ws.get_cell("A1").set_value(2);
+        ws.get_cell("A2").set_value(3);
+        ws.get_cell("A3").set_value(4);
+        ws.get_cell("B1").set_value("text");
+        other.get_cell("A1").set_value(10);
+
+        // Formulas are evaluated after their precedents regardless of position.
+        ws.get_cell("C1").set_formula("C2*2");
+        ws.get_cell("C2").set_formula("SUM(A1:A3)+'Other Sheet'!A1");
+        ws.get_cell("C3").set_formula("-2^2+10%*A1");
+        ws.get_cell("C4").set_formula("IF(AND(A1>1,A2<>3),\"yes\",\"no\")");
+        ws.get_cell("C5").set_formula("A1/0");
+        ws.get_cell("C6").set_formula("IFERROR(C5,-1)");
+        ws.get_cell("C7").set_formula("B1&\" \"&ROUND(2.5,0)");
+        ws.get_cell("C8").set_formula("VLOOKUP(3,A1:C3,3,FALSE)");
+        ws.get_cell("C9").set_formula("INDEX(A1:A3,MATCH(4,A1:A3,0))+COUNTIF(A:A,\">2\")");
+        ws.get_cell("C10").set_formula("NOSUCHFUNCTION(1)");
+        ws.get_cell("C11").set_formula("A1>=2");
+        ws.get_cell("D1").set_formula("D2+1");
+        ws.get_cell("D2").set_formula("D1+1");
+        ws.get_cell("D2").set_value(7);
+
+        wb.calculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("C2").get_value<int>(), 19);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 38);
+        TS_ASSERT_DELTA(ws.get_cell("C3").get_value<double>(), 4.2, 1e-12);
+        TS_ASSERT_EQUALS(ws.get_cell("C4").get_value<std::string>(), "no");
+        TS_ASSERT_EQUALS(ws.get_cell("C5").get_data_type(), xlnt::cell::type::error);
+        TS_ASSERT_EQUALS(ws.get_cell("C5").get_value<std::string>(), "#DIV/0!");
+        TS_ASSERT_EQUALS(ws.get_cell("C6").get_value<int>(), -1);
+        TS_ASSERT_EQUALS(ws.get_cell("C7").get_value<std::string>(), "text 3");
+        TS_ASSERT_EQUALS(ws.get_cell("C8").get_value<int>(), 19);
+        TS_ASSERT_EQUALS(ws.get_cell("C9").get_value<int>(), 6);
+        TS_ASSERT_EQUALS(ws.get_cell("C10").get_value<std::string>(), "#NAME?");
+        TS_ASSERT(ws.get_cell("C11").get_value<bool>());
+
+        // Cells in a circular reference have no value to compute.
+        TS_ASSERT_EQUALS(ws.get_cell("D2").get_value<std::string>(), "#REF!");
+        TS_ASSERT(ws.get_cell("C2").has_formula());
+
+        ws.get_cell("A1").set_value(12);
+        wb.calculate();
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 58);
+    }
+
+    void test_calculate_shared_formulas()
+    {
+        auto wb = xlnt::load_workbook(PathHelper::GetDataDirectory("/reader/formulae.xlsx"));
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("C4").set_value(5);
+        ws.get_cell("E4").set_value(1.5);
+        wb.calculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("C7").get_value<int>(), 10);
+        TS_ASSERT_EQUALS(ws.get_cell("E7").get_value<int>(), 3);
+    }
+
+    void test_shared_formula_with_unknown_token()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        ws.add_shared_formula(0, "B1", "B1:B2", "IF(A1,#SPILL!,1)");
+        ws.get_cell("B1").set_shared_formula(0);
+        ws.get_cell("B2").set_shared_formula(0);
+
+        // A formula the tokenizer can't read is used as written instead of translated.
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_formula(), "IF(A1,#SPILL!,1)");
+        TS_ASSERT_THROWS_NOTHING(wb.calculate());
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_data_type(), xlnt::cell::type::error);
+
+        std::vector<unsigned char> saved;
+        TS_ASSERT_THROWS_NOTHING(wb.save(saved));
+    }
+
+    void test_recalculate()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(1);
+        ws.get_cell("A2").set_value(2);
+        ws.get_cell("B1").set_formula("=A1*10");
+        ws.get_cell("B2").set_formula("=A2*10");
+        ws.get_cell("C1").set_formula("=B1+1");
+        ws.get_cell("D1").set_formula("=SUM(A1:A2)");
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 11);
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<int>(), 3);
+
+        ws.get_cell("A1").set_value(5);
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<int>(), 50);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 51);
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<int>(), 7);
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_value<int>(), 20);
+
+        // A value written over a formula's result is replaced by the formula again.
+        ws.get_cell("B1").set_value(-1);
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<int>(), 50);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 51);
+    }
+
+    void test_recalculate_ranges()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        // Running totals down column B read ever taller blocks of column A, and K20 reads
+        // across row 20.
+        for(row_t row = 1; row <= 10; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(1, row)).set_value(static_cast<int>(row));
+            ws.get_cell(xlnt::cell_reference(2, row)).set_formula("=SUM($A$1:A" + std::to_string(row) + ")");
+        }
+
+        for(column_t column = 1; column <= 10; column++)
+        {
+            ws.get_cell(xlnt::cell_reference(column, 20)).set_value(static_cast<int>(column));
+        }
+
+        ws.get_cell("K20").set_formula("=SUM(A20:J20)");
+        ws.get_cell("C1").set_formula("=SUM(A5:A6)");
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B10").get_value<int>(), 55);
+        TS_ASSERT_EQUALS(ws.get_cell("K20").get_value<int>(), 55);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 11);
+
+        ws.get_cell("A3").set_value(103);
+        ws.get_cell("E20").set_value(105);
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_value<int>(), 3);
+        TS_ASSERT_EQUALS(ws.get_cell("B3").get_value<int>(), 106);
+        TS_ASSERT_EQUALS(ws.get_cell("B10").get_value<int>(), 155);
+        TS_ASSERT_EQUALS(ws.get_cell("K20").get_value<int>(), 155);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 11);
+
+        ws.get_cell("A6").set_value(0);
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 5);
+        TS_ASSERT_EQUALS(ws.get_cell("B5").get_value<int>(), 115);
+        TS_ASSERT_EQUALS(ws.get_cell("B6").get_value<int>(), 115);
+    }
+
+    void test_recalculate_after_formula_change()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(2);
+        ws.get_cell("B1").set_formula("=A1+1");
+        wb.calculate();
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<int>(), 3);
+
+        ws.get_cell("C1").set_formula("=B1*A1");
+        ws.get_cell("A1").set_value(4);
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<int>(), 5);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 20);
+
+        auto ws2 = wb.create_sheet("Inputs");
+        ws2.get_cell("A1").set_value(3);
+        ws.get_cell("A1").set_formula("=Inputs!A1");
+        wb.recalculate();
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 12);
+
+        ws2.get_cell("A1").set_value(6);
+        wb.recalculate();
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<int>(), 42);
+    }
+
+    void test_recalculate_after_copying_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(1);
+        ws.get_cell("C1").set_value(7);
+        ws.get_cell("B1").set_formula("=A1*10");
+        wb.recalculate();
+
+        // Copying a value is an ordinary change, copying a formula adds it to the graph.
+        ws.get_cell("A1").set_value(ws.get_cell("C1"));
+        ws.get_cell("D1").set_value(ws.get_cell("B1"));
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<int>(), 70);
+        TS_ASSERT(ws.get_cell("D1").has_formula());
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<int>(), 70);
+
+        ws.get_cell("A1").set_value(2);
+        ws.get_cell("D1").set_value(ws.get_cell("C1"));
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<int>(), 20);
+        TS_ASSERT(!ws.get_cell("D1").has_formula());
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<int>(), 7);
+    }
+
+    void test_circular_reference()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value(1);
+        ws.get_cell("B1").set_formula("=C1+1");
+        ws.get_cell("C1").set_formula("=B1+1");
+        ws.get_cell("D1").set_formula("=B1*2");
+        ws.get_cell("E1").set_formula("=A1+1");
+        wb.calculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value<std::string>(), "#REF!");
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value<std::string>(), "#REF!");
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<std::string>(), "#REF!");
+        TS_ASSERT_EQUALS(ws.get_cell("E1").get_value<int>(), 2);
+
+        ws.get_cell("D1").set_value(5);
+        ws.get_cell("A1").set_value(2);
+        wb.recalculate();
+
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_value<std::string>(), "#REF!");
+        TS_ASSERT_EQUALS(ws.get_cell("E1").get_value<int>(), 3);
+    }
+
+    void test_recalculate_after_rename()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        auto inputs = wb.create_sheet("Inputs");
+
+        inputs.get_cell("A1").set_value(3);
+        ws.get_cell("A1").set_formula("=Data!A1*2");
+        wb.calculate();
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_value<std::string>(), "#REF!");
+
+        inputs.set_title("Data");
+        wb.recalculate();
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_value<int>(), 6);
+    }
+
+    void test_calculate_threads()
+    {
+        // Wide enough that every level is split between threads.
+        const row_t rows = 4000;
+
+        auto fill = [rows](xlnt::worksheet ws)
+        {
+            for(row_t row = 1; row <= rows; row++)
+            {
+                auto r = std::to_string(row);
+                ws.get_cell("A" + r).set_value(static_cast<int>(row % 97));
+                ws.get_cell("B" + r).set_formula("=A" + r + "*3-1");
+                ws.get_cell("C" + r).set_formula("=IF(MOD(B" + r + ",2)=0,B" + r + "/2,B" + r + "+A" + r + ")");
+                ws.get_cell("D" + r).set_formula("=SUM(A" + r + ":C" + r + ")&\"x\"");
+            }
+        };
+
+        xlnt::workbook serial;
+        fill(serial.get_active_sheet());
+        serial.calculate();
+
+        xlnt::workbook parallel;
+        parallel.set_calculation_threads(4);
+        TS_ASSERT_EQUALS(parallel.get_calculation_threads(), 4);
+        fill(parallel.get_active_sheet());
+        parallel.calculate();
+
+        auto expected = serial.get_active_sheet();
+        auto actual = parallel.get_active_sheet();
+
+        for(row_t row = 1; row <= rows; row++)
+        {
+            auto r = std::to_string(row);
+            TS_ASSERT_EQUALS(actual.get_cell("C" + r).get_value<long double>(), expected.get_cell("C" + r).get_value<long double>());
+            TS_ASSERT_EQUALS(actual.get_cell("D" + r).get_value<std::string>(), expected.get_cell("D" + r).get_value<std::string>());
+        }
+
+        for(row_t row = 1; row <= rows; row += 2)
+        {
+            auto r = std::to_string(row);
+            serial.get_active_sheet().get_cell("A" + r).set_value(static_cast<int>(row % 13));
+            parallel.get_active_sheet().get_cell("A" + r).set_value(static_cast<int>(row % 13));
+        }
+
+        serial.recalculate();
+        parallel.recalculate();
+
+        for(row_t row = 1; row <= rows; row++)
+        {
+            auto r = std::to_string(row);
+            TS_ASSERT_EQUALS(actual.get_cell("D" + r).get_value<std::string>(), expected.get_cell("D" + r).get_value<std::string>());
+        }
+
+        TS_ASSERT_EQUALS(actual.get_cell("D3").get_value<std::string>(), "15x");
+    }
+};
@@ -9,6 +9,7 @@
 #include <xlnt/reader/workbook_reader.hpp>
 #include <xlnt/reader/worksheet_reader.hpp>
 
+#include "helpers/allocation_counter.hpp"
 #include "helpers/path_helper.hpp"
 
 class test_read : public CxxTest::TestSuite
@@ -21,7 +22,7 @@ public:
         xlnt::worksheet ws(wb);
         {
             std::ifstream handle(path);
-            ws = xlnt::read_worksheet(handle, wb, "Sheet 2", {"hello"}, {});
+            ws = xlnt::read_worksheet(handle, wb, "Sheet 2", {"hello"});
         }
         TS_ASSERT_DIFFERS(ws, nullptr);
         if(!(ws == nullptr))
@@ -62,6 +63,262 @@ public:
         TS_ASSERT_EQUALS(false, sheet2.get_cell("G10").get_value<bool>());
     }
 
+    void test_read_worksheet_lazy()
+    {
+        auto path = PathHelper::GetDataDirectory("/genuine/empty.xlsx");
+        xlnt::workbook wb;
+        wb.set_lazy_load(true);
+        TS_ASSERT(wb.get_lazy_load());
+        wb.load(path);
+        
+        TS_ASSERT_EQUALS(wb.get_sheet_names().size(), 4);
+        
+        auto sheet2 = wb.get_sheet_by_name("Sheet2 - Numbers");
+        TS_ASSERT_DIFFERS(sheet2, nullptr);
+        TS_ASSERT_EQUALS("This is cell G5", sheet2.get_cell("G5").get_value<std::string>());
+        TS_ASSERT_EQUALS(18, sheet2.get_cell("D18").get_value<int>());
+        
+        auto copy = wb;
+        TS_ASSERT_EQUALS(true, copy.get_sheet_by_name("Sheet2 - Numbers").get_cell("G9").get_value<bool>());
+    }
+    
+    void test_read_worksheet_lazy_leaves_other_sheets()
+    {
+        xlnt::workbook wb;
+        wb.set_lazy_load(true);
+        wb.load(PathHelper::GetDataDirectory("/genuine/empty.xlsx"));
+        
+        TS_ASSERT_EQUALS(18, wb[1].get_cell("D18").get_value<int>());
+        
+        // Handles to a parsed sheet come straight from the workbook. Reading sheet 2 must not
+        // have parsed the others, so getting a handle to one of them reads it from the archive.
+        {
+            AllocationCounter counter;
+            wb.get_sheet_by_index(1);
+            TS_ASSERT_EQUALS(counter.GetCount(), 0);
+        }
+        
+        for(std::size_t index : { 0, 2, 3 })
+        {
+            AllocationCounter counter;
+            wb.get_sheet_by_index(index);
+            TS_ASSERT_DIFFERS(counter.GetCount(), 0);
+        }
+        
+        for(std::size_t index : { 0, 2, 3 })
+        {
+            AllocationCounter counter;
+            wb.get_sheet_by_index(index);
+            TS_ASSERT_EQUALS(counter.GetCount(), 0);
+        }
+    }
+    
+    void test_read_worksheet_lazy_from_archive()
+    {
+        xlnt::workbook wb;
+        wb.set_lazy_load(true);
+        
+        {
+            xlnt::zip_file archive(PathHelper::GetDataDirectory("/genuine/empty.xlsx"));
+            wb.load(archive);
+        }
+        
+        int sheets = 0;
+        
+        for(auto ws : wb)
+        {
+            TS_ASSERT_DIFFERS(ws, nullptr);
+            sheets++;
+        }
+        
+        TS_ASSERT_EQUALS(sheets, 4);
+        TS_ASSERT_EQUALS(false, wb[1].get_cell("G10").get_value<bool>());
+    }
+
+    void test_read_selected_sheets()
+    {
+        xlnt::load_options options;
+        options.sheets = { "Sheet2 - Numbers" };
+
+        auto wb = xlnt::load_workbook(PathHelper::GetDataDirectory("/genuine/empty.xlsx"), options);
+
+        TS_ASSERT_EQUALS(wb.get_sheet_names().size(), 1);
+        TS_ASSERT_EQUALS("This is cell G5", wb[0].get_cell("G5").get_value<std::string>());
+
+        std::vector<unsigned char> saved;
+        wb.save(saved);
+
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        TS_ASSERT_EQUALS(reloaded.get_sheet_names().front(), "Sheet2 - Numbers");
+        TS_ASSERT_EQUALS(18, reloaded[0].get_cell("D18").get_value<int>());
+    }
+
+    void test_read_cell_window()
+    {
+        xlnt::load_options options;
+        options.sheets = { "Sheet2 - Numbers" };
+        options.columns = { xlnt::cell_reference::column_index_from_string("D") };
+        options.min_row = 10;
+        options.max_row = 20;
+
+        xlnt::workbook wb;
+        wb.load(PathHelper::GetDataDirectory("/genuine/empty.xlsx"), options);
+        auto ws = wb[0];
+
+        auto cells = ws.get_cell_collection();
+        TS_ASSERT(!cells.empty());
+
+        for(auto cell : cells)
+        {
+            TS_ASSERT_EQUALS(cell.get_column(), "D");
+            TS_ASSERT(cell.get_row() >= 10 && cell.get_row() <= 20);
+        }
+
+        TS_ASSERT_EQUALS(18, ws.get_cell("D18").get_value<int>());
+        TS_ASSERT(!ws.get_cell("D9").has_value());
+        TS_ASSERT(!ws.get_cell("G5").has_value());
+    }
+
+    void test_read_filtered_merged_cells()
+    {
+        std::string xml = "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+            "<sheetData/>"
+            "<mergeCells count=\"4\"><mergeCell ref=\"B2:C3\"/><mergeCell ref=\"B2:D2\"/><mergeCell ref=\"B5:C6\"/><mergeCell ref=\"B1:C2\"/></mergeCells>"
+            "</worksheet>";
+
+        xlnt::load_options options;
+        options.columns = { 3, 2 };
+        options.min_row = 2;
+        options.max_row = 5;
+
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::read_worksheet(ws, xml, {}, {}, {}, options);
+
+        // Only ranges with every row and column inside the filters are merged.
+        auto merged = ws.get_merged_ranges();
+        TS_ASSERT_EQUALS(merged.size(), 1);
+        TS_ASSERT_EQUALS(merged.front(), xlnt::range_reference("B2:C3"));
+    }
+
+    void test_read_skip_styles()
+    {
+        xlnt::load_options options;
+        options.skip_styles = true;
+
+        auto wb = xlnt::load_workbook(PathHelper::GetDataDirectory("/genuine/empty-with-styles.xlsx"), options);
+        auto ws = wb["Sheet1"];
+
+        TS_ASSERT(ws.get_cell("A2").has_value());
+        TS_ASSERT_EQUALS(ws.get_cell("A2").get_number_format().get_format_code(), xlnt::number_format::format::general);
+    }
+
+    void test_read_hyperlinks()
+    {
+        std::string xml = "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">"
+            "<sheetData><row r=\"1\"><c r=\"A1\" t=\"inlineStr\"><is><t>link</t></is></c></row></sheetData>"
+            "<hyperlinks><hyperlink ref=\"A1\" r:id=\"rId1\"/></hyperlinks>"
+            "</worksheet>";
+        std::vector<xlnt::relationship> relationships = { xlnt::relationship(xlnt::relationship::type::hyperlink, "rId1", "http://example.com/") };
+
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::read_worksheet(ws, xml, {}, {}, relationships, xlnt::load_options());
+
+        TS_ASSERT(ws.get_cell("A1").has_hyperlink());
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_hyperlink().get_target_uri(), "http://example.com/");
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_value<std::string>(), "link");
+
+        xlnt::load_options options;
+        options.skip_hyperlinks = true;
+        auto ws2 = wb.create_sheet();
+        xlnt::read_worksheet(ws2, xml, {}, {}, relationships, options);
+
+        TS_ASSERT(!ws2.get_cell("A1").has_hyperlink());
+    }
+
+    void test_read_hyperlink_ranges()
+    {
+        std::string xml = "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">"
+            "<sheetData><row r=\"1\"><c r=\"A1\"><v>1</v></c></row><row r=\"2\"><c r=\"B2\"><v>2</v></c></row></sheetData>"
+            "<hyperlinks><hyperlink ref=\"A1:XFD1048576\" r:id=\"rId1\"/><hyperlink ref=\"D10\" r:id=\"rId1\"/></hyperlinks>"
+            "</worksheet>";
+        std::vector<xlnt::relationship> relationships = { xlnt::relationship(xlnt::relationship::type::hyperlink, "rId1", "http://example.com/") };
+
+        // A range is cut down to the cells in sheetData but a link on a single empty cell stays.
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::read_worksheet(ws, xml, {}, {}, relationships, xlnt::load_options());
+
+        TS_ASSERT(ws.get_cell("A1").has_hyperlink());
+        TS_ASSERT(ws.get_cell("B1").has_hyperlink());
+        TS_ASSERT(ws.get_cell("B2").has_hyperlink());
+        TS_ASSERT(ws.get_cell("D10").has_hyperlink());
+        TS_ASSERT_EQUALS(ws.get_cell_collection().size(), 5);
+
+        xlnt::load_options options;
+        options.columns = { 2 };
+        options.max_row = 2;
+        auto ws2 = wb.create_sheet();
+        xlnt::read_worksheet(ws2, xml, {}, {}, relationships, options);
+
+        TS_ASSERT_EQUALS(ws2.get_cell_collection().size(), 2);
+        TS_ASSERT(ws2.get_cell("B1").has_hyperlink());
+        TS_ASSERT(ws2.get_cell("B2").has_hyperlink());
+        TS_ASSERT(!ws2.get_cell("A1").has_hyperlink());
+    }
+
+    void test_read_shared_formulae()
+    {
+        auto wb = xlnt::load_workbook(PathHelper::GetDataDirectory("/reader/formulae.xlsx"));
+        auto ws = wb.get_active_sheet();
+
+        TS_ASSERT(ws.get_cell("B7").has_shared_formula());
+        TS_ASSERT_EQUALS(ws.get_cell("B7").get_formula(), "B4*2");
+        TS_ASSERT_EQUALS(ws.get_cell("C7").get_formula(), "C4*2");
+        TS_ASSERT_EQUALS(ws.get_cell("E7").get_formula(), "E4*2");
+        TS_ASSERT_EQUALS(ws.get_shared_formula_reference(0), "B7:E7");
+
+        ws.get_cell("D7").set_formula("D4*3");
+        TS_ASSERT(!ws.get_cell("D7").has_shared_formula());
+
+        std::vector<unsigned char> saved;
+        wb.save(saved);
+
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        auto reloaded_ws = reloaded.get_active_sheet();
+
+        TS_ASSERT(reloaded_ws.get_cell("C7").has_shared_formula());
+        TS_ASSERT(reloaded_ws.get_cell("E7").has_shared_formula());
+        TS_ASSERT_EQUALS(reloaded_ws.get_cell("E7").get_formula(), "E4*2");
+        TS_ASSERT_EQUALS(reloaded_ws.get_cell("D7").get_formula(), "D4*3");
+    }
+
+    void test_read_cell_styles()
+    {
+        std::string xml = "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\"><sheetData>"
+            "<row r=\"1\"><c r=\"A1\" s=\"1\"><v>1</v></c><c r=\"B1\" s=\"2\"><v>2</v></c><c r=\"C1\" s=\"0\"><v>3</v></c><c r=\"D1\"><v>4</v></c></row>"
+            "<row r=\"2\"><c r=\"A2\" s=\"1\"><v>5</v></c><c r=\"B2\" s=\"2\"><v>6</v></c><c r=\"C2\" s=\"9\"><v>7</v></c></row>"
+            "</sheetData></worksheet>";
+        
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::read_worksheet(ws, xml, {}, { 0, 14, 164 }, { { 164, "0.000" } });
+        
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_number_format().get_format_code(), xlnt::number_format::format::date_xlsx14);
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_number_format().get_format_string(), "0.000");
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_number_format().get_format_code(), xlnt::number_format::format::general);
+        TS_ASSERT_EQUALS(ws.get_cell("D1").get_number_format().get_format_code(), xlnt::number_format::format::general);
+        TS_ASSERT_EQUALS(ws.get_cell("C2").get_number_format().get_format_code(), xlnt::number_format::format::general);
+        
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_style_id(), ws.get_cell("A2").get_style_id());
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_style_id(), ws.get_cell("B2").get_style_id());
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_style_id(), ws.get_cell("D1").get_style_id());
+        TS_ASSERT_EQUALS(wb.get_styles().size(), 3);
+    }
+
     void test_read_nostring_workbook()
     {
         auto path = PathHelper::GetDataDirectory("/genuine/empty-no-string.xlsx");
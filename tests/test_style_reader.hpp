@@ -0,0 +1,117 @@
+#pragma once
+
+#include <iostream>
+#include <cxxtest/TestSuite.h>
+
+#include <xlnt/xlnt.hpp>
+#include <xlnt/reader/style_reader.hpp>
+
+class test_style_reader : public CxxTest::TestSuite
+{
+public:
+    void test_read_styles()
+    {
+        std::string xml =
+            "<styleSheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+            "<numFmts count=\"1\"><numFmt numFmtId=\"164\" formatCode=\"0.000\"/></numFmts>"
+            "<fonts count=\"2\">"
+            "<font><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+            "<font><b/><i/><u val=\"double\"/><sz val=\"14\"/><color indexed=\"10\"/><name val=\"Arial\"/></font>"
+            "</fonts>"
+            "<fills count=\"3\">"
+            "<fill><patternFill patternType=\"none\"/></fill>"
+            "<fill><patternFill patternType=\"gray125\"/></fill>"
+            "<fill><patternFill patternType=\"solid\"><fgColor indexed=\"5\"/></patternFill></fill>"
+            "</fills>"
+            "<borders count=\"2\">"
+            "<border><left/><right/><top/><bottom/><diagonal/></border>"
+            "<border><left/><right/><top style=\"thin\"><color indexed=\"8\"/></top><bottom/><diagonal/></border>"
+            "</borders>"
+            "<cellXfs count=\"5\">"
+            "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/>"
+            "<xf numFmtId=\"164\" fontId=\"1\" fillId=\"2\" borderId=\"1\" quotePrefix=\"1\"/>"
+            "<xf numFmtId=\"14\" fontId=\"0\" fillId=\"0\" borderId=\"0\"><alignment horizontal=\"center\" wrapText=\"1\"/><protection locked=\"0\"/></xf>"
+            "<xf numFmtId=\"164\" fontId=\"1\" fillId=\"2\" borderId=\"1\" quotePrefix=\"1\"/>"
+            "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"1\" borderId=\"0\"/>"
+            "</cellXfs>"
+            "</styleSheet>";
+
+        xlnt::workbook wb;
+        xlnt::style_reader reader(wb);
+        reader.read_styles(xml);
+
+        auto style_ids = reader.get_style_ids();
+        TS_ASSERT_EQUALS(style_ids.size(), 5);
+        TS_ASSERT_EQUALS(style_ids[0], 0);
+        TS_ASSERT_EQUALS(style_ids[1], style_ids[3]);
+        TS_ASSERT_DIFFERS(style_ids[1], style_ids[2]);
+        TS_ASSERT_EQUALS(wb.get_styles().size(), 4);
+        TS_ASSERT_EQUALS(wb.get_fonts().size(), 2);
+        TS_ASSERT_EQUALS(wb.get_fills().size(), 3);
+        TS_ASSERT_EQUALS(wb.get_borders().size(), 2);
+
+        auto &font = wb.get_font(style_ids[1]);
+        TS_ASSERT(font.is_bold());
+        TS_ASSERT(font.is_italic());
+        TS_ASSERT_EQUALS(font.get_underline(), xlnt::font::underline::double_);
+        TS_ASSERT_EQUALS(font.get_size(), 14);
+        TS_ASSERT_EQUALS(font.get_name(), "Arial");
+        TS_ASSERT_EQUALS(font.get_color().get_index(), 10);
+
+        TS_ASSERT_EQUALS(wb.get_fill(style_ids[1]).type_, xlnt::fill::type::solid);
+        TS_ASSERT_EQUALS(wb.get_fill(style_ids[1]).start_color.get_index(), 5);
+        TS_ASSERT_EQUALS(wb.get_fill(style_ids[4]).type_, xlnt::fill::type::pattern_gray125);
+
+        auto &border = wb.get_border(style_ids[1]);
+        TS_ASSERT(border.top.initialized);
+        TS_ASSERT(!border.left.initialized);
+        TS_ASSERT_EQUALS(border.top.value.get_style(), xlnt::border_style::thin);
+        TS_ASSERT(wb.get_border(style_ids[0]) == xlnt::border());
+
+        TS_ASSERT_EQUALS(wb.get_number_format(style_ids[1]).get_format_string(), "0.000");
+        TS_ASSERT(wb.get_quote_prefix(style_ids[1]));
+
+        TS_ASSERT_EQUALS(wb.get_number_format(style_ids[2]).get_format_code(), xlnt::number_format::format::date_xlsx14);
+        TS_ASSERT_EQUALS(wb.get_alignment(style_ids[2]).get_horizontal(), xlnt::alignment::horizontal_alignment::center);
+        TS_ASSERT(wb.get_alignment(style_ids[2]).get_wrap_text());
+        TS_ASSERT_EQUALS(wb.get_protection(style_ids[2]).get_locked(), xlnt::protection::type::unprotected);
+    }
+
+    void test_round_trip_styles()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        xlnt::font bold;
+        bold.set_bold(true);
+
+        xlnt::fill solid;
+        solid.type_ = xlnt::fill::type::solid;
+        solid.start_color = xlnt::color(2);
+
+        xlnt::border bordered;
+        bordered.bottom.initialized = true;
+        bordered.bottom.value = xlnt::side(xlnt::border_style::medium);
+
+        ws.get_cell("A1").set_value(1);
+        ws.get_cell("A1").set_font(bold);
+        ws.get_cell("A1").set_fill(solid);
+        ws.get_cell("B1").set_value(2);
+        ws.get_cell("B1").set_border(bordered);
+        ws.get_cell("C1").set_value(3);
+
+        std::vector<unsigned char> bytes;
+        wb.save(bytes);
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        auto loaded_ws = loaded.get_active_sheet();
+
+        TS_ASSERT(loaded_ws.get_cell("A1").get_font().is_bold());
+        TS_ASSERT(loaded_ws.get_cell("A1").get_fill() == solid);
+        TS_ASSERT(loaded_ws.get_cell("B1").get_border() == bordered);
+        TS_ASSERT(!loaded_ws.get_cell("B1").get_font().is_bold());
+        TS_ASSERT(loaded_ws.get_cell("C1").get_fill() == xlnt::fill());
+        TS_ASSERT_EQUALS(loaded.get_fills().size(), wb.get_fills().size());
+    }
+};
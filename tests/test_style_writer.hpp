@@ -23,6 +23,79 @@ public:
         auto diff = Helper::compare_xml(xml, expected);
         TS_ASSERT(diff);
     }
+
+    void test_round_trip_style_components()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        xlnt::font font;
+        font.set_name("Arial");
+        font.set_size(14);
+        font.set_italic(true);
+        font.set_strikethrough(true);
+        font.set_underline(xlnt::font::underline::double_);
+        font.set_superscript(true);
+        font.set_color(xlnt::color(10));
+
+        xlnt::alignment alignment;
+        alignment.set_horizontal(xlnt::alignment::horizontal_alignment::center);
+        alignment.set_vertical(xlnt::alignment::vertical_alignment::top);
+        alignment.set_text_rotation(45);
+        alignment.set_indent(2);
+        alignment.set_shrink_to_fit(true);
+
+        xlnt::protection protection;
+        protection.set_locked(true);
+        protection.set_hidden(true);
+
+        xlnt::style quoted;
+        quoted.set_quote_prefix(true);
+        quoted.set_number_format(xlnt::number_format("0.0000"));
+
+        // Interning this format first gives it the lower custom id, although its xf comes later.
+        auto quoted_id = wb.add_style(quoted);
+
+        for(row_t row = 1; row <= 7; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(1, row)).set_value(static_cast<int>(row));
+        }
+
+        ws.get_cell("A1").set_number_format(xlnt::number_format("0.000"));
+        ws.get_cell("A2").set_number_format(xlnt::number_format("#,##0"));
+        ws.get_cell("A3").set_font(font);
+        ws.get_cell("A4").set_alignment(alignment);
+        ws.get_cell("A5").set_protection(protection);
+        ws.get_cell("A6").set_style_id(quoted_id);
+
+        std::vector<unsigned char> bytes;
+        wb.save(bytes);
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+
+        bytes.clear();
+        loaded.save(bytes);
+        xlnt::workbook reloaded;
+        reloaded.load(bytes);
+
+        for(auto book : { &loaded, &reloaded })
+        {
+            auto sheet = book->get_active_sheet();
+
+            TS_ASSERT_EQUALS(sheet.get_cell("A1").get_number_format().get_format_string(), "0.000");
+            TS_ASSERT_EQUALS(sheet.get_cell("A2").get_number_format().get_format_string(), "#,##0");
+            TS_ASSERT(sheet.get_cell("A3").get_font() == font);
+            TS_ASSERT(sheet.get_cell("A4").get_alignment() == alignment);
+            TS_ASSERT(sheet.get_cell("A5").get_protection() == protection);
+            TS_ASSERT(sheet.get_cell("A6").quote_prefix());
+            TS_ASSERT_EQUALS(sheet.get_cell("A6").get_number_format().get_format_string(), "0.0000");
+            TS_ASSERT(sheet.get_cell("A7").get_alignment() == xlnt::alignment());
+            TS_ASSERT(sheet.get_cell("A7").get_font() == xlnt::font());
+        }
+
+        TS_ASSERT_EQUALS(reloaded.get_styles().size(), loaded.get_styles().size());
+        TS_ASSERT_EQUALS(reloaded.get_number_formats().size(), loaded.get_number_formats().size());
+    }
     /*
     class TestStyleWriter(object):
     
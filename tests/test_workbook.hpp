@@ -5,6 +5,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include <xlnt/xlnt.hpp>
+#include "helpers/allocation_counter.hpp"
 #include "helpers/temporary_file.hpp"
 
 class test_workbook : public CxxTest::TestSuite
@@ -134,6 +135,39 @@ public:
         TS_ASSERT_EQUALS(sheet_index, 0);
     }
 
+    void test_create_sheet_keeps_handles()
+    {
+        xlnt::workbook wb;
+        auto first = wb.get_active_sheet();
+
+        for(row_t row = 1; row <= 1000; row++)
+        {
+            first.get_cell(xlnt::cell_reference(1, row)).set_value(static_cast<int>(row));
+        }
+
+        auto cell = first.get_cell("A10");
+
+        {
+            AllocationCounter counter;
+
+            for(int i = 0; i < 10; i++)
+            {
+                wb.create_sheet();
+            }
+
+            // Relocating the first sheet would copy each of its 1,000 cells.
+            TS_ASSERT(counter.GetCount() < 1000);
+        }
+
+        auto inserted = wb.create_sheet(0);
+
+        TS_ASSERT_EQUALS(wb.get_sheet_names().size(), 12);
+        TS_ASSERT_EQUALS(wb[0], inserted);
+        TS_ASSERT_EQUALS(wb[1], first);
+        TS_ASSERT_EQUALS(wb.get_index(first), 1);
+        TS_ASSERT_EQUALS(cell.get_value<int>(), 10);
+    }
+
     void test_add_named_range()
     {
         xlnt::workbook wb;
@@ -163,6 +197,98 @@ public:
         TS_ASSERT(!wb.has_named_range("test_nr"));
     }
 
+    void test_sheet_title_lookup()
+    {
+        xlnt::workbook wb;
+
+        for(int i = 0; i < 2000; i++)
+        {
+            wb.create_sheet("Export");
+        }
+
+        for(int i = 0; i < 2000; i++)
+        {
+            wb.create_sheet();
+        }
+
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Export1999").get_title(), "Export1999");
+        TS_ASSERT_EQUALS(wb.create_sheet().get_title(), "Sheet2001");
+
+        auto moved = wb.create_sheet(0, "Moved");
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Moved"), moved);
+        TS_ASSERT_EQUALS(wb[0], moved);
+
+        moved.set_title("Renamed");
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Moved"), nullptr);
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Renamed"), moved);
+
+        wb.remove_sheet(wb.get_sheet_by_name("Sheet5"));
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Sheet5"), nullptr);
+        TS_ASSERT_EQUALS(wb.create_sheet().get_title(), "Sheet5");
+
+        // Each base title keeps its own count, which freed titles lower again.
+        wb.remove_sheet(wb.get_sheet_by_name("Export5"));
+        TS_ASSERT_EQUALS(wb.create_sheet("Export").get_title(), "Export5");
+        TS_ASSERT_EQUALS(wb.create_sheet("EXPORT").get_title(), "EXPORT2000");
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("export2000"), nullptr);
+
+        // Formulas find sheets ignoring case.
+        wb.get_sheet_by_name("Export1999").get_cell("A1").set_value(4);
+        moved.get_cell("A1").set_formula("=export1999!A1*2");
+        wb.calculate();
+        TS_ASSERT_EQUALS(moved.get_cell("A1").get_value<int>(), 8);
+
+        xlnt::workbook copy(wb);
+        TS_ASSERT_EQUALS(copy.get_sheet_by_name("Renamed"), copy[0]);
+        TS_ASSERT_EQUALS(copy.get_relationship("rId2").get_target_uri(), "sharedStrings.xml");
+        TS_ASSERT_THROWS(copy.get_relationship("rId0"), std::runtime_error);
+    }
+
+    void test_named_range_scopes()
+    {
+        xlnt::workbook wb;
+        auto first = wb.get_active_sheet();
+        auto second = wb.create_sheet();
+
+        wb.create_named_range("Totals", first, "A1:A3");
+        second.create_named_range("totals", "B2");
+
+        TS_ASSERT(wb.has_named_range("TOTALS"));
+        TS_ASSERT_EQUALS(wb.get_named_range("totals"), first.get_range("A1:A3"));
+        TS_ASSERT_EQUALS(first.get_named_range("Totals"), first.get_range("A1:A3"));
+        TS_ASSERT_EQUALS(second.get_named_range("Totals"), second.get_range("B2"));
+        TS_ASSERT_EQUALS(wb.get_named_ranges().size(), 2);
+
+        first.get_cell("A1").set_value(1);
+        first.get_cell("A2").set_value(2);
+        second.get_cell("B2").set_value(10);
+        first.get_cell("C1").set_formula("=SUM(Totals)");
+        second.get_cell("C1").set_formula("=SUM(Totals)");
+        wb.calculate();
+        TS_ASSERT_EQUALS(first.get_cell("C1").get_value<int>(), 3);
+        TS_ASSERT_EQUALS(second.get_cell("C1").get_value<int>(), 10);
+
+        // Names local to another sheet aren't visible.
+        auto third = wb.create_sheet();
+        third.create_named_range("Local", "A1");
+        first.get_cell("D1").set_formula("=Local");
+        wb.calculate();
+        TS_ASSERT_EQUALS(first.get_cell("D1").get_value<std::string>(), "#NAME?");
+        wb.remove_sheet(third);
+
+        xlnt::workbook copy(wb);
+        TS_ASSERT_EQUALS(copy.get_named_range("Totals"), copy[0].get_range("A1:A3"));
+        TS_ASSERT_EQUALS(copy[1].get_named_range("Totals"), copy[1].get_range("B2"));
+
+        second.remove_named_range("TOTALS");
+        TS_ASSERT(!second.has_named_range("Totals"));
+        TS_ASSERT(first.has_named_range("Totals"));
+
+        wb.remove_sheet(first);
+        TS_ASSERT(!wb.has_named_range("Totals"));
+        TS_ASSERT(copy.has_named_range("Totals"));
+    }
+
     void test_add_local_named_range()
     {
         TemporaryFile temp_file;
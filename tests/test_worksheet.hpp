@@ -5,6 +5,8 @@
 
 #include <xlnt/writer/worksheet_writer.hpp>
 
+#include "helpers/allocation_counter.hpp"
+
 class test_worksheet : public CxxTest::TestSuite
 {
 public:
@@ -21,6 +23,44 @@ public:
         TS_ASSERT_EQUALS(cell.get_reference(), "A1");
     }
     
+    void test_get_cell_allocations()
+    {
+        auto ws = wb_.create_sheet();
+        std::string text(64, 'x');
+
+        AllocationCounter counter;
+
+        for(column_t column = 1; column <= 1000; column++)
+        {
+            ws.get_cell(xlnt::cell_reference(column, 1)).set_value(text);
+        }
+
+        // One map node and one string buffer per cell, plus occasional bucket growth.
+        // Any extra copy of the cell or its string on the way in adds another 1,000.
+        TS_ASSERT(counter.GetCount() < 2100);
+        TS_ASSERT_EQUALS(ws.get_cell("ALL1").get_value<std::string>(), text);
+    }
+
+    void test_cells_share_allocations()
+    {
+        auto ws = wb_.create_sheet();
+
+        AllocationCounter counter;
+
+        for(row_t row = 1; row <= 100; row++)
+        {
+            for(column_t column = 1; column <= 100; column++)
+            {
+                ws.get_cell(xlnt::cell_reference(column, row)).set_value(static_cast<int>(row + column));
+            }
+        }
+
+        // Cells are carved from the sheet's arena, so 10,000 cells take a few dozen
+        // allocations for chunks and bucket arrays rather than one each.
+        TS_ASSERT(counter.GetCount() < 200);
+        TS_ASSERT_EQUALS(ws.get_cell("CV100").get_value<int>(), 200);
+    }
+
     void test_worksheet_dimension()
     {
         xlnt::worksheet ws(wb_);
@@ -138,6 +178,73 @@ public:
         }
     }
     
+    void test_render_text()
+    {
+        xlnt::worksheet ws(wb_);
+        
+        ws.get_cell("A1").set_value("name");
+        ws.get_cell("B1").set_value(xlnt::date(2016, 2, 29));
+        ws.get_cell("A2").set_value(12);
+        ws.get_cell("B2").set_value(true);
+        
+        std::string text;
+        std::vector<std::size_t> offsets;
+        TS_ASSERT_EQUALS(ws.get_range("A1:B3").render_text(text, offsets), "A1:B2");
+        
+        const std::vector<std::string> expected = { "name", "2016-02-29", "12", "TRUE" };
+        TS_ASSERT_EQUALS(offsets.size(), expected.size() + 1);
+        TS_ASSERT_EQUALS(offsets.back(), text.size());
+        
+        for(std::size_t i = 0; i < expected.size(); i++)
+        {
+            TS_ASSERT_EQUALS(text.substr(offsets[i], offsets[i + 1] - offsets[i]), expected[i]);
+        }
+        
+        // Missing cells aren't created by rendering.
+        TS_ASSERT_EQUALS(ws.calculate_dimension(), "A1:B2");
+        
+        xlnt::range by_column(ws, xlnt::range_reference("A1:B2"), xlnt::major_order::column);
+        by_column.render_text(text, offsets);
+        TS_ASSERT_EQUALS(text, "name122016-02-29TRUE");
+        TS_ASSERT_EQUALS(text.substr(offsets[1], offsets[2] - offsets[1]), "12");
+        
+        // Only the part of a huge range up to the last used row and column is rendered.
+        TS_ASSERT_EQUALS(ws.get_range("B1:XFD1048576").render_text(text, offsets), "B1:B2");
+        TS_ASSERT_EQUALS(offsets.size(), 3);
+        TS_ASSERT_EQUALS(text, "2016-02-29TRUE");
+        TS_ASSERT_EQUALS(ws.get_range("D5:XFD1048576").render_text(text, offsets), "D5:D5");
+        TS_ASSERT_EQUALS(offsets.size(), 2);
+        TS_ASSERT(text.empty());
+    }
+    
+    void test_range_aggregates()
+    {
+        xlnt::worksheet ws(wb_);
+        
+        ws.get_cell("A1").set_value(4);
+        ws.get_cell("A2").set_value(-2.5);
+        ws.get_cell("A3").set_value("text");
+        ws.get_cell("B1").set_value(true);
+        ws.get_cell("B2").set_error("#N/A");
+        ws.get_cell("B3").set_value(10);
+        
+        auto range = ws.get_range("A1:C4");
+        TS_ASSERT_EQUALS(range.sum(), 11.5);
+        TS_ASSERT_EQUALS(range.min(), -2.5);
+        TS_ASSERT_EQUALS(range.max(), 10);
+        TS_ASSERT_EQUALS(range.count(), 3);
+        TS_ASSERT_EQUALS(range.average(), 11.5L / 3);
+        
+        // Missing cells aren't created by aggregating.
+        TS_ASSERT_EQUALS(ws.calculate_dimension(), "A1:B3");
+        
+        auto empty = ws.get_range("D1:E5");
+        TS_ASSERT_EQUALS(empty.sum(), 0);
+        TS_ASSERT_EQUALS(empty.count(), 0);
+        TS_ASSERT_EQUALS(empty.max(), 0);
+        TS_ASSERT_THROWS(empty.average(), xlnt::data_type_exception);
+    }
+    
     void test_get_named_range()
     {
         xlnt::worksheet ws(wb_);
@@ -327,6 +434,22 @@ public:
         TS_ASSERT_EQUALS(vals[1][1].get_value<std::string>(), "This is B2");
     }
     
+    void test_append_after_removed_rows()
+    {
+        xlnt::worksheet ws(wb_);
+
+        ws.append(std::vector<std::string> {"This is A1"});
+        ws.get_cell("A9");
+        TS_ASSERT_EQUALS(ws.get_highest_row(), 9);
+
+        ws.garbage_collect();
+        TS_ASSERT_EQUALS(ws.get_highest_row(), 1);
+
+        ws.append(std::vector<std::string> {"This is A2"});
+        TS_ASSERT_EQUALS(ws.get_cell("A2").get_value<std::string>(), "This is A2");
+        TS_ASSERT_EQUALS(ws.get_highest_row(), 2);
+    }
+
     void _test_append_cell()
     {
         // Right now, a cell cannot be created without a parent worksheet.
@@ -498,6 +621,55 @@ public:
         TS_ASSERT_EQUALS(ws.get_merged_ranges().size(), 0);
     }
     
+    void test_merged_range_lookup()
+    {
+        xlnt::worksheet ws(wb_);
+        ws.get_cell("A1").set_value("kept");
+        ws.get_cell("B2").set_value(5);
+        
+        // Merging doesn't create the cells it covers.
+        ws.merge_cells("A1:Z100000");
+        TS_ASSERT_EQUALS(ws.calculate_dimension(), "A1:B2");
+        TS_ASSERT(!ws.get_cell("B2").has_value());
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_value<std::string>(), "kept");
+        
+        // Enough single-row merges that lookups go through the tree rather than the pending list.
+        for(row_t row = 1; row <= 200; row++)
+        {
+            ws.merge_cells(xlnt::range_reference(28, row, 29, row));
+        }
+        
+        TS_ASSERT(ws.is_merged("Z100000"));
+        TS_ASSERT(!ws.is_merged("AA100001"));
+        TS_ASSERT(!ws.is_merged("AD5"));
+        TS_ASSERT_EQUALS(ws.get_merged_range("C50"), xlnt::range_reference("A1:Z100000"));
+        TS_ASSERT_EQUALS(ws.get_merged_range("AC150"), xlnt::range_reference("AB150:AC150"));
+        TS_ASSERT_THROWS(ws.get_merged_range("AB201"), std::runtime_error);
+        TS_ASSERT(ws.get_cell("AB7").is_merged());
+        
+        ws.unmerge_cells("AB150:AC150");
+        TS_ASSERT(!ws.is_merged("AC150"));
+        TS_ASSERT(ws.is_merged("AC151"));
+        TS_ASSERT_EQUALS(ws.get_merged_ranges().size(), 200);
+        TS_ASSERT_THROWS(ws.unmerge_cells("AB150:AC150"), std::runtime_error);
+        
+        for(row_t row = 1; row <= 200; row++)
+        {
+            if(row != 150)
+            {
+                ws.unmerge_cells(xlnt::range_reference(28, row, 29, row));
+            }
+        }
+        
+        TS_ASSERT(!ws.is_merged("AB7"));
+        TS_ASSERT(ws.is_merged("B2"));
+        
+        ws.get_cell("B2").set_merged(false);
+        TS_ASSERT(ws.get_merged_ranges().empty());
+        ws.get_cell("B2").set_merged(true);
+        TS_ASSERT_EQUALS(ws.get_merged_range("B2"), xlnt::range_reference("B2:B2"));
+    }
+    
     void test_print_titles()
     {
         xlnt::worksheet ws(wb_);
@@ -517,6 +689,44 @@ public:
         TS_ASSERT_EQUALS(ws.get_point_pos(ws.get_cell("X11").get_anchor()), xlnt::cell_reference("X11"));
     }
     
+    void test_positioning_dimensions()
+    {
+        xlnt::worksheet ws(wb_);
+        
+        // 30 points is 40 pixels, next to the default 70 pixel columns and 20 pixel rows.
+        ws.set_column_width(2, 30);
+        ws.set_row_height(3, 0);
+        ws.set_row_height(1000000, 45);
+        
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_anchor(), std::make_pair(110, 0));
+        TS_ASSERT_EQUALS(ws.get_point_pos(109, 0), xlnt::cell_reference("B1"));
+        TS_ASSERT_EQUALS(ws.get_point_pos(110, 0), xlnt::cell_reference("C1"));
+        
+        // Hidden rows take no space and are never hit.
+        TS_ASSERT_EQUALS(ws.get_cell("A4").get_anchor(), std::make_pair(0, 40));
+        TS_ASSERT_EQUALS(ws.get_point_pos(0, 40), xlnt::cell_reference("A4"));
+        
+        TS_ASSERT_EQUALS(ws.get_cell("A1000001").get_anchor().second, 20000020);
+        TS_ASSERT_EQUALS(ws.get_point_pos(0, 20000019), xlnt::cell_reference("A1000000"));
+        TS_ASSERT_EQUALS(ws.get_point_pos(0, 20000020), xlnt::cell_reference("A1000001"));
+        TS_ASSERT_EQUALS(ws.get_point_pos(-5, -5), xlnt::cell_reference("A1"));
+        
+        for(auto reference : { "A1", "B2", "C5", "D4", "X11", "AB999999" })
+        {
+            TS_ASSERT_EQUALS(ws.get_point_pos(ws.get_cell(reference).get_anchor()), xlnt::cell_reference(reference));
+        }
+        
+        ws.set_column_width(2, -1);
+        TS_ASSERT_EQUALS(ws.get_column_dimensions().size(), 0);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_anchor().first, 140);
+        
+        // Columns and rows are numbered from 1.
+        TS_ASSERT_THROWS(ws.set_column_width(0, 40), std::runtime_error);
+        TS_ASSERT_THROWS(ws.set_row_height(0, 40), std::runtime_error);
+        TS_ASSERT_THROWS(ws.set_row_height(0, -1), std::runtime_error);
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_anchor().first, 140);
+    }
+    
     void test_freeze_panes_horiz()
     {
         xlnt::worksheet ws(wb_);
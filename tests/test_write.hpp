@@ -4,6 +4,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include <xlnt/xlnt.hpp>
+#include "helpers/allocation_counter.hpp"
 #include "helpers/temporary_file.hpp"
 #include "helpers/path_helper.hpp"
 #include "helpers/helper.hpp"
@@ -209,6 +210,72 @@ public:
         TS_ASSERT(Helper::EqualsFileContent(PathHelper::GetDataDirectory() + "/writer/expected/short_number.xml", content));
     }
     
+    void test_write_shared_formula_without_master()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        ws.add_shared_formula(0, "B1", "B1:C2", "A1*2");
+
+        for(auto reference : { "B1", "C1", "B2", "C2" })
+        {
+            ws.get_cell(reference).set_shared_formula(0);
+        }
+
+        ws.get_cell("B1").clear_formula();
+        ws.get_cell("B1").set_value(5);
+
+        std::vector<unsigned char> saved;
+        wb.save(saved);
+
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        auto reloaded_ws = reloaded.get_active_sheet();
+
+        // C1 now holds the group's text, so B2 to its left is written on its own.
+        TS_ASSERT_EQUALS(reloaded_ws.get_cell("B1").get_value<int>(), 5);
+        TS_ASSERT(reloaded_ws.get_cell("C1").has_shared_formula());
+        TS_ASSERT_EQUALS(reloaded_ws.get_shared_formula_reference(reloaded_ws.get_cell("C1").get_shared_formula_index()), "C1:C2");
+        TS_ASSERT_EQUALS(reloaded_ws.get_cell("C1").get_formula(), "B1*2");
+        TS_ASSERT(reloaded_ws.get_cell("C2").has_shared_formula());
+        TS_ASSERT_EQUALS(reloaded_ws.get_cell("C2").get_formula(), "B2*2");
+        TS_ASSERT(!reloaded_ws.get_cell("B2").has_shared_formula());
+        TS_ASSERT_EQUALS(reloaded_ws.get_cell("B2").get_formula(), "A2*2");
+    }
+    
+    void test_writer_does_not_copy_workbook()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        for(row_t row = 1; row <= 100; row++)
+        {
+            for(column_t column = 1; column <= 100; column++)
+            {
+                ws.get_cell(xlnt::cell_reference(column, row)).set_value(static_cast<int>(row * column));
+            }
+        }
+
+        std::vector<unsigned char> data;
+        AllocationCounter counter;
+        wb.save(data);
+        auto allocations = counter.GetCount();
+
+        xlnt::zip_file archive;
+        archive.load(data);
+        TS_ASSERT(archive.has_file("xl/worksheets/sheet1.xml"));
+
+        std::size_t written = 0;
+
+        for(auto &info : archive.infolist())
+        {
+            written += info.file_size;
+        }
+
+        // Each cell takes about 50 bytes of XML and a handful of allocations to write. Copying
+        // the workbook would add at least one more allocation per cell, going over this bound.
+        TS_ASSERT(allocations < written / 8);
+    }
+    
     void _test_write_images()
     {
         TS_SKIP("not implemented");
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+/// <summary>
+/// The shape of the workbook to generate. Each option can be given on the command line as
+/// --name=value, using the names in parse_options.
+/// </summary>
+struct options
+{
+    std::string filename;
+    std::size_t sheets = 1;
+    std::size_t rows = 10000;
+    std::size_t columns = 10;
+
+    // The first string_columns columns of a row hold strings drawn from this many distinct
+    // values, or unique ones if it's 0.
+    std::size_t string_columns = 3;
+    std::size_t strings = 1000;
+
+    // The last formula_columns columns of a row are formulas.
+    std::size_t formula_columns = 1;
+
+    // Number of distinct styles cycled through every cell, or 0 to leave cells unstyled.
+    std::size_t styles = 0;
+
+    // Number of ranges merged in each sheet, spread evenly over its rows.
+    std::size_t merges = 0;
+
+    std::uint32_t seed = 20150101;
+};
+
+void print_usage()
+{
+    std::cout << "usage: xlnt.generator [--sheets=N] [--rows=N] [--columns=N] [--string-columns=N]" << std::endl
+        << "    [--strings=N] [--formula-columns=N] [--styles=N] [--merges=N] [--seed=N] filename.xlsx" << std::endl;
+}
+
+options parse_options(int argc, char *argv[])
+{
+    options parsed;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if(argument.compare(0, 2, "--") != 0)
+        {
+            parsed.filename = argument;
+            continue;
+        }
+
+        auto equals = argument.find('=');
+
+        if(equals == std::string::npos)
+        {
+            throw std::runtime_error("missing value for " + argument);
+        }
+
+        auto name = argument.substr(2, equals - 2);
+        auto value = static_cast<std::size_t>(std::stoull(argument.substr(equals + 1)));
+
+        if(name == "sheets") parsed.sheets = value;
+        else if(name == "rows") parsed.rows = value;
+        else if(name == "columns") parsed.columns = value;
+        else if(name == "string-columns") parsed.string_columns = value;
+        else if(name == "strings") parsed.strings = value;
+        else if(name == "formula-columns") parsed.formula_columns = value;
+        else if(name == "styles") parsed.styles = value;
+        else if(name == "merges") parsed.merges = value;
+        else if(name == "seed") parsed.seed = static_cast<std::uint32_t>(value);
+        else throw std::runtime_error("unknown option " + argument);
+    }
+
+    if(parsed.filename.empty())
+    {
+        throw std::runtime_error("no output filename given");
+    }
+
+    if(parsed.columns == 0 || parsed.columns > 16384 || parsed.rows > 1048576)
+    {
+        throw std::runtime_error("a sheet has 1 to 16,384 columns and at most 1,048,576 rows");
+    }
+
+    if(parsed.string_columns + parsed.formula_columns > parsed.columns || parsed.formula_columns == parsed.columns)
+    {
+        throw std::runtime_error("string and formula columns can't outnumber columns and formulas need a column of values");
+    }
+
+    return parsed;
+}
+
+/// <summary>
+/// Create the styles to cycle through, varying the font and number format. Returns their ids.
+/// </summary>
+std::vector<std::size_t> create_styles(xlnt::workbook &wb, std::size_t count)
+{
+    const std::vector<std::string> formats = { "General", "0.00", "#,##0", "0%", "yyyy-mm-dd", "@", "0.00E+00" };
+    std::vector<std::size_t> ids;
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        xlnt::font font;
+        font.set_bold(i % 2 == 1);
+        font.set_italic(i / 2 % 2 == 1);
+        font.set_size(static_cast<int>(8 + i / 4 % 16));
+
+        xlnt::style style;
+        style.set_font(font);
+        style.set_number_format(xlnt::number_format(formats[i / 64 % formats.size()]));
+        ids.push_back(wb.add_style(style));
+    }
+
+    return ids;
+}
+
+void generate_sheet(xlnt::worksheet ws, const options &shape, const std::vector<std::size_t> &styles, std::mt19937 &random)
+{
+    auto number_columns = shape.columns - shape.string_columns - shape.formula_columns;
+    std::vector<std::string> values(shape.columns);
+    std::size_t next_style = 0;
+
+    for(std::size_t row = 1; row <= shape.rows; row++)
+    {
+        auto r = std::to_string(row);
+
+        for(std::size_t column = 0; column < shape.columns; column++)
+        {
+            if(column < shape.string_columns)
+            {
+                // Values are taken straight from the engine since the standard distributions
+                // aren't required to produce the same sequence everywhere.
+                auto id = shape.strings == 0 ? (row - 1) * shape.columns + column : random() % shape.strings;
+                values[column] = "item " + std::to_string(id);
+            }
+            else if(column < shape.string_columns + number_columns)
+            {
+                values[column] = std::to_string(random() % 100000000) + "." + std::to_string(random() % 100);
+            }
+            else
+            {
+                // Add the cell to the left to the first cell of the row.
+                auto left = xlnt::cell_reference::column_string_from_index(static_cast<column_t>(column));
+                values[column] = "=SUM(A" + r + "," + left + r + ")";
+            }
+        }
+
+        // Type guessing turns the numeric strings into numbers as the row is appended.
+        ws.append(values);
+
+        if(!styles.empty())
+        {
+            for(std::size_t column = 1; column <= shape.columns; column++)
+            {
+                ws.get_cell(xlnt::cell_reference(static_cast<column_t>(column), static_cast<row_t>(row))).set_style_id(styles[next_style]);
+                next_style = (next_style + 1) % styles.size();
+            }
+        }
+    }
+
+    if(shape.merges > 0 && shape.columns > 1)
+    {
+        auto step = std::max<std::size_t>(shape.rows / shape.merges, 1);
+
+        for(std::size_t merge = 0; merge < shape.merges && merge * step < shape.rows; merge++)
+        {
+            auto row = static_cast<row_t>(merge * step + 1);
+            ws.merge_cells(1, row, 2, row);
+        }
+    }
+}
+
+} // namespace
+
+/// <summary>
+/// Write an xlsx file of the given shape for testing how reading, writing and calculation
+/// scale. The same options and seed always produce the same cells, but not the same bytes,
+/// since zip entries are stamped with the time they're written. The file must come to less
+/// than 4 GB because miniz 1.15 can't write zip64 archives.
+/// </summary>
+int main(int argc, char *argv[])
+{
+    options shape;
+
+    try
+    {
+        shape = parse_options(argc, argv);
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        print_usage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937 random(shape.seed);
+
+    xlnt::workbook wb;
+    wb.set_guess_types(true);
+    auto styles = create_styles(wb, shape.styles);
+
+    for(std::size_t i = 0; i < shape.sheets; i++)
+    {
+        auto ws = i == 0 ? wb.get_active_sheet() : wb.create_sheet();
+        ws.set_title("Data" + std::to_string(i + 1));
+        ws.reserve(shape.rows);
+        generate_sheet(ws, shape, styles, random);
+    }
+
+    try
+    {
+        wb.save(shape.filename);
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << "couldn't save " << shape.filename << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::ifstream written(shape.filename, std::ios::binary | std::ios::ate);
+
+    std::cout << shape.filename << ": " << shape.sheets * shape.rows * shape.columns << " cells, "
+        << written.tellg() << " bytes in " << elapsed.count() << " s" << std::endl;
+
+    return 0;
+}